@@ -108,6 +108,8 @@ PrintQueueStatistics(QueueDiscContainer allQueueDiscs)
     NS_LOG_INFO("====== Queue Statistics ======");
     NS_LOG_INFO("Number of queue discs: " << allQueueDiscs.GetN());
 
+    std::map<Slice::SliceType, DelayHistogram> sliceDelays;
+
     for (uint32_t i = 0; i < allQueueDiscs.GetN(); i++)
     {
         Ptr<CustomQueueDisc> queueDisc = DynamicCast<CustomQueueDisc>(allQueueDiscs.Get(i));
@@ -117,6 +119,23 @@ PrintQueueStatistics(QueueDiscContainer allQueueDiscs)
         }
 
         queueDisc->PrintQueueStatistics();
+        // Every queue of a slice type counts, including the queues of isolated slices
+        for (uint32_t queueIndex = 0; queueIndex < queueDisc->GetNInternalQueues(); queueIndex++)
+        {
+            Slice::SliceType sliceType;
+            if (queueDisc->GetQueueSliceType(queueIndex, sliceType))
+            {
+                sliceDelays[sliceType].Merge(queueDisc->GetDelayHistogram(queueIndex));
+            }
+        }
+    }
+
+    for (const auto& [sliceType, delays] : sliceDelays)
+    {
+        NS_LOG_INFO("[QueueDisc] All ports | Queue: "
+                    << Slice::sliceTypeToStrMap.at(sliceType) << " | Packets: " << delays.GetCount()
+                    << " | p99: " << delays.GetPercentile(99).GetSeconds() * 1000
+                    << " ms | Max delay: " << delays.GetMax().GetSeconds() * 1000 << " ms");
     }
 }
 
@@ -124,11 +143,23 @@ int
 main(int argc, char* argv[])
 {
     std::string topologyType = "linear";
+    bool dctcp = false;
+    bool isolateSlices = false;
+    bool aqm = false;
+    bool wf2q = false;
     CommandLine cmd;
     cmd.AddValue("topology", "Topology type (linear, fattree, fiveg)", topologyType);
+    cmd.AddValue("dctcp", "Use DCTCP with ECN marking in the slice queues", dctcp);
+    cmd.AddValue("isolateSlices", "Give every slice its own queue in each port", isolateSlices);
+    cmd.AddValue("aqm", "Use CoDel for URLLC and PIE for eMBB, mMTC staying drop-tail", aqm);
+    cmd.AddValue("wf2q", "Schedule the slice queues with WF2Q+ instead of DRR", wf2q);
     cmd.Parse(argc, argv);
 
     Config::SetDefault("ns3::TcpSocket::SegmentSize", UintegerValue(1448));
+    if (wf2q)
+    {
+        Config::SetDefault("ns3::CustomQueueDisc::Scheduler", StringValue("Wf2q"));
+    }
     ns3::RngSeedManager::SetSeed(2); // seed 2
     ns3::RngSeedManager::SetRun(2);  // run 1
 
@@ -258,6 +289,20 @@ main(int argc, char* argv[])
     }
 
     topo->SetQueueWeights({{Slice::URLLC, 80}, {Slice::eMBB, 15}, {Slice::mMTC, 5}});
+    if (dctcp)
+    {
+        // Marking thresholds in bytes, well below the 20KB/500KB/200KB queue limits
+        topo->EnableDctcp({{Slice::URLLC, 6000}, {Slice::eMBB, 60000}, {Slice::mMTC, 30000}});
+    }
+    if (aqm)
+    {
+        ObjectFactory codel("ns3::CoDelAqm");
+        codel.Set("Target", TimeValue(MicroSeconds(500)));
+        codel.Set("Interval", TimeValue(MilliSeconds(10)));
+        ObjectFactory pie("ns3::PieAqm");
+        pie.Set("Target", TimeValue(MilliSeconds(5)));
+        topo->SetAqm({{Slice::URLLC, codel}, {Slice::eMBB, pie}});
+    }
 
     Ptr<SliceHelper> sliceHelper = CreateObject<SliceHelper>();
     sliceHelper->SetAttribute("SimulationDuration", DoubleValue(totalSimDuration.GetSeconds()));
@@ -269,6 +314,10 @@ main(int argc, char* argv[])
                                                              {Slice::mMTC, 5}}; // 3
 
     std::vector<Ptr<Slice>> slices = sliceHelper->CreateSlices(sources, sinks, numSlicesPerType);
+    if (isolateSlices)
+    {
+        topo->IsolateSlices(slices);
+    }
 
     Simulator::Schedule(Seconds(1.0), &ProgressCallback);
     NodeContainer allSinks;
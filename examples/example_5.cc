@@ -21,6 +21,13 @@
  *
  * ./ns3 run "scratch/example_5"
  *
+ * ### Per-packet cost
+ *
+ * ./ns3 run "scratch/example_5 --numPackets=30000 --interval=200us --verbose=false"
+ *
+ * Prints the wall-clock time spent per switch traversal (request + reply), which
+ * is used to compare revisions of the switch forwarding path.
+ *
  */
 
 #include "ns3/applications-module.h"
@@ -31,6 +38,8 @@
 #include "ns3/network-module.h"
 #include "ns3/slicescope-module.h"
 
+#include <chrono>
+
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE("TwoTerminalsOneSwitch");
@@ -52,12 +61,25 @@ TransmitPacket(Ptr<NetDevice> device, Ptr<const Packet> packet)
 int
 main(int argc, char* argv[])
 {
+    uint32_t numPackets = 1;
+    Time interval = Seconds(1.0);
+    bool verbose = true;
+
+    CommandLine cmd;
+    cmd.AddValue("numPackets", "Number of echo requests sent by terminal 2", numPackets);
+    cmd.AddValue("interval", "Interval between echo requests", interval);
+    cmd.AddValue("verbose", "Enable per-packet logging, tracing and pcap", verbose);
+    cmd.Parse(argc, argv);
+
     // Enable logging
     LogComponentEnable("TwoTerminalsOneSwitch", LOG_LEVEL_INFO);
-    // LogComponentEnable("ArpL3Protocol", LOG_LEVEL_INFO);
-    LogComponentEnable("UdpEchoClientApplication", LOG_LEVEL_INFO);
-    LogComponentEnable("UdpEchoServerApplication", LOG_LEVEL_INFO);
-    LogComponentEnable("SlicescopeSwitchNetDevice", LOG_LEVEL_INFO);
+    if (verbose)
+    {
+        // LogComponentEnable("ArpL3Protocol", LOG_LEVEL_INFO);
+        LogComponentEnable("UdpEchoClientApplication", LOG_LEVEL_INFO);
+        LogComponentEnable("UdpEchoServerApplication", LOG_LEVEL_INFO);
+        LogComponentEnable("SlicescopeSwitchNetDevice", LOG_LEVEL_INFO);
+    }
     // LogComponentEnable("SlicescopeSwitchHelper", LOG_LEVEL_LOGIC);
 
     // Create nodes
@@ -117,28 +139,39 @@ main(int argc, char* argv[])
 
     // Create a UDP echo client on terminal 2
     UdpEchoClientHelper echoClient(interfaces.GetAddress(0), port);
-    echoClient.SetAttribute("MaxPackets", UintegerValue(1));
-    echoClient.SetAttribute("Interval", TimeValue(Seconds(1.0)));
+    echoClient.SetAttribute("MaxPackets", UintegerValue(numPackets));
+    echoClient.SetAttribute("Interval", TimeValue(interval));
     echoClient.SetAttribute("PacketSize", UintegerValue(1024));
 
     ApplicationContainer clientApps = echoClient.Install(terminals.Get(1));
     clientApps.Start(Seconds(2.0));
     clientApps.Stop(Seconds(10.0));
 
-    // Enable packet tracing
-    for (uint32_t i = 0; i < switchDevices.GetN(); ++i)
+    if (verbose)
     {
-        Ptr<NetDevice> device = switchDevices.Get(i);
-        device->TraceConnectWithoutContext("Rx", MakeCallback(&ReceivePacket));
-        device->TraceConnectWithoutContext("Tx", MakeCallback(&TransmitPacket));
+        // Enable packet tracing
+        for (uint32_t i = 0; i < switchDevices.GetN(); ++i)
+        {
+            Ptr<NetDevice> device = switchDevices.Get(i);
+            device->TraceConnectWithoutContext("Rx", MakeCallback(&ReceivePacket));
+            device->TraceConnectWithoutContext("Tx", MakeCallback(&TransmitPacket));
+        }
+
+        // Enable pcap tracing
+        csma.EnablePcapAll("example_5");
     }
 
-    // Enable pcap tracing
-    csma.EnablePcapAll("example_5");
-
     // Run the simulation
+    auto wallStart = std::chrono::steady_clock::now();
     Simulator::Run();
+    auto wallNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now() - wallStart)
+                      .count();
     Simulator::Destroy();
 
+    // Each echo request crosses the switch twice (request and reply)
+    NS_LOG_INFO("Wall-clock time: " << wallNs / 1e6 << " ms | Per switch traversal: "
+                                    << wallNs / (2.0 * numPackets) << " ns");
+
     return 0;
 }
\ No newline at end of file
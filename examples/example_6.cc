@@ -11,11 +11,20 @@
  * - Two slicescope-enabled switches chained in series
  * - Terminal 0 sends a single UDP packet to Terminal 1
  * - Uses raw UdpClient and PacketSink applications
+ * - With --lpm, the switches forward IPv4 by longest-prefix match on routes
+ *   filled from the topology instead of by MAC learning
  *
  * ### Run
  *
  * ./ns3 run "scratch/example_6"
  *
+ * ### Per-packet cost
+ *
+ * ./ns3 run "scratch/example_6 --numPackets=50000 --interval=100us --verbose=false"
+ *
+ * Prints the wall-clock time spent per packet crossing both switches, which is
+ * used to compare revisions of the switch forwarding path.
+ *
  */
 
 #include "ns3/applications-module.h"
@@ -26,20 +35,45 @@
 #include "ns3/network-module.h"
 #include "ns3/slicescope-module.h"
 
+#include <chrono>
+
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE("TwoTerminalsTwoSwitches");
 
+uint64_t g_rxPackets = 0; //!< packets received by the sink
+
+void
+CountRx(Ptr<const Packet> packet, const Address& from)
+{
+    g_rxPackets++;
+}
+
 int
 main(int argc, char* argv[])
 {
+    uint32_t numPackets = 1;
+    Time interval = MilliSeconds(1.0);
+    bool verbose = true;
+    bool lpm = false;
+
+    CommandLine cmd;
+    cmd.AddValue("numPackets", "Number of packets sent by terminal 0", numPackets);
+    cmd.AddValue("interval", "Interval between packets", interval);
+    cmd.AddValue("verbose", "Enable per-packet logging and pcap", verbose);
+    cmd.AddValue("lpm", "Forward IPv4 by longest-prefix match instead of MAC learning", lpm);
+    cmd.Parse(argc, argv);
+
     // Set up the logging
     LogComponentEnable("TwoTerminalsTwoSwitches", LOG_LEVEL_INFO);
-    // LogComponentEnable("UdpEchoClientApplication", LOG_LEVEL_INFO);
-    // LogComponentEnable("UdpEchoServerApplication", LOG_LEVEL_INFO);
-    LogComponentEnable("SlicescopeSwitchNetDevice", LOG_LEVEL_INFO);
-    LogComponentEnable("PacketSink", LOG_LEVEL_INFO);
-    LogComponentEnable("UdpClient", LOG_LEVEL_INFO);
+    if (verbose)
+    {
+        // LogComponentEnable("UdpEchoClientApplication", LOG_LEVEL_INFO);
+        // LogComponentEnable("UdpEchoServerApplication", LOG_LEVEL_INFO);
+        LogComponentEnable("SlicescopeSwitchNetDevice", LOG_LEVEL_INFO);
+        LogComponentEnable("PacketSink", LOG_LEVEL_INFO);
+        LogComponentEnable("UdpClient", LOG_LEVEL_INFO);
+    }
 
     // Create nodes
     NodeContainer terminals;
@@ -83,8 +117,9 @@ main(int argc, char* argv[])
     // bridge.Install(bridges.Get(0), bridgeNetDevices1);
     // bridge.Install(bridges.Get(1), bridgeNetDevices2);
 
-    slicescope.Install(bridges.Get(0), bridgeNetDevices1);
-    slicescope.Install(bridges.Get(1), bridgeNetDevices2);
+    NetDeviceContainer switchDevices;
+    switchDevices.Add(slicescope.Install(bridges.Get(0), bridgeNetDevices1));
+    switchDevices.Add(slicescope.Install(bridges.Get(1), bridgeNetDevices2));
 
     // Assign IP addresses to terminal devices
     Ipv4AddressHelper address;
@@ -93,6 +128,15 @@ main(int argc, char* argv[])
     terminalInterfaces.Add(address.Assign(terminalDevices1.Get(0)));
     terminalInterfaces.Add(address.Assign(terminalDevices2.Get(1)));
 
+    if (lpm)
+    {
+        for (uint32_t i = 0; i < switchDevices.GetN(); ++i)
+        {
+            switchDevices.Get(i)->SetAttribute("ForwardingMode", StringValue("Lpm"));
+        }
+        slicescope.PopulateRoutes(switchDevices);
+    }
+
     // Create an application to send data from terminal 0 to terminal 1
     uint16_t port = 9;
     PacketSinkHelper packetSinkHelper("ns3::UdpSocketFactory",
@@ -101,22 +145,35 @@ main(int argc, char* argv[])
     ApplicationContainer sinkApps = packetSinkHelper.Install(terminals.Get(1));
     sinkApps.Start(Seconds(1.0));
     sinkApps.Stop(Seconds(10.0));
+    sinkApps.Get(0)->TraceConnectWithoutContext("Rx", MakeCallback(&CountRx));
 
     // Create a UDP client application on node 0 (h1)
     UdpClientHelper client(terminalInterfaces.GetAddress(1), port); // h2's IP address
-    client.SetAttribute("MaxPackets", UintegerValue(1));
-    client.SetAttribute("Interval", TimeValue(MilliSeconds(1.0))); // 500 Mbps => 1 ms interval
-    client.SetAttribute("PacketSize", UintegerValue(1024));        // Packet size
+    client.SetAttribute("MaxPackets", UintegerValue(numPackets));
+    client.SetAttribute("Interval", TimeValue(interval));   // 500 Mbps => 1 ms interval
+    client.SetAttribute("PacketSize", UintegerValue(1024)); // Packet size
 
     ApplicationContainer clientApps = client.Install(terminals.Get(0));
     clientApps.Start(Seconds(2.0));
     clientApps.Stop(Seconds(10.0));
 
-    // Enable pcap tracing
-    csma.EnablePcapAll("example6");
+    if (verbose)
+    {
+        // Enable pcap tracing
+        csma.EnablePcapAll("example6");
+    }
 
     // Run the simulation
+    auto wallStart = std::chrono::steady_clock::now();
     Simulator::Run();
+    auto wallNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now() - wallStart)
+                      .count();
+
+    NS_LOG_INFO("Wall-clock time: " << wallNs / 1e6 << " ms | Packets received: " << g_rxPackets
+                                    << " | Per packet: "
+                                    << (g_rxPackets ? wallNs / static_cast<double>(g_rxPackets) : 0)
+                                    << " ns");
     Simulator::Destroy();
 
     return 0;
@@ -0,0 +1,172 @@
+/**
+ * @file example_8.cc
+ * @brief Flood replication benchmark on a wide slicescope switch
+ *
+ * ### Topology
+ * ```
+ *   Peer 0 ----+
+ *   Peer 1 ----+
+ *     ...      [Slicescope Switch] (numPorts ports)
+ *   Peer N ----+
+ * ```
+ *
+ * - One SimpleNetDevice link per port, no data rate limit and no delay
+ * - Peer 0 sends frames that the switch has to flood through every other port:
+ *   - `--mode=arp`: broadcast ARP-like frames, as in the startup ARP storm
+ *   - `--mode=udp`: IPv4/UDP frames to an unknown MAC address; the switch owns
+ *     the frame once it inserts the slicescope header, so the last port takes
+ *     it without a copy
+ *
+ * ### Run
+ *
+ * ./ns3 run "scratch/example_8 --numPorts=64 --numFloods=20000 --mode=arp"
+ *
+ * Prints the wall-clock time per flood and per replica, together with the
+ * switch FloodReplicas and AvoidedCopies counters, which is used to compare
+ * revisions of the switch flooding path.
+ *
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+#include "ns3/slicescope-module.h"
+
+#include <chrono>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("FloodBenchmark");
+
+static uint64_t g_rxReplicas = 0; //!< frames received by the peers
+
+// Promiscuous, since the unknown unicast frames are addressed to no peer
+bool
+CountReplica(Ptr<NetDevice> device,
+             Ptr<const Packet> packet,
+             uint16_t protocol,
+             const Address& from,
+             const Address& to,
+             NetDevice::PacketType packetType)
+{
+    g_rxReplicas++;
+    return true;
+}
+
+void
+SendFrame(Ptr<NetDevice> device, Ptr<Packet> packet, Address dest, uint16_t protocol)
+{
+    device->Send(packet->Copy(), dest, protocol);
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t numPorts = 64;
+    uint32_t numFloods = 20000;
+    uint32_t payloadSize = 64;
+    Time interval = MicroSeconds(1);
+    std::string mode = "arp";
+
+    CommandLine cmd;
+    cmd.AddValue("numPorts", "Number of switch ports", numPorts);
+    cmd.AddValue("numFloods", "Number of frames flooded by the switch", numFloods);
+    cmd.AddValue("payloadSize", "Payload size of the flooded frames", payloadSize);
+    cmd.AddValue("interval", "Interval between frames", interval);
+    cmd.AddValue("mode", "Flooded traffic: arp (broadcast) or udp (unknown unicast)", mode);
+    cmd.Parse(argc, argv);
+
+    LogComponentEnable("FloodBenchmark", LOG_LEVEL_INFO);
+
+    if (mode != "arp" && mode != "udp")
+    {
+        NS_FATAL_ERROR("Unknown mode " << mode);
+    }
+
+    Ptr<Node> switchNode = CreateObject<Node>();
+    Ptr<Node> peerNode = CreateObject<Node>();
+
+    NetDeviceContainer switchPorts;
+    NetDeviceContainer peers;
+    for (uint32_t i = 0; i < numPorts; i++)
+    {
+        Ptr<SimpleChannel> channel = CreateObject<SimpleChannel>();
+
+        Ptr<SimpleNetDevice> port = CreateObject<SimpleNetDevice>();
+        port->SetAddress(Mac48Address::Allocate());
+        port->SetChannel(channel);
+        switchNode->AddDevice(port);
+        switchPorts.Add(port);
+
+        Ptr<SimpleNetDevice> peer = CreateObject<SimpleNetDevice>();
+        peer->SetAddress(Mac48Address::Allocate());
+        peer->SetChannel(channel);
+        peerNode->AddDevice(peer);
+        peer->SetPromiscReceiveCallback(MakeCallback(&CountReplica));
+        peers.Add(peer);
+    }
+
+    SlicescopeSwitchHelper slicescope;
+    // No pipeline latency, so that only the forwarding path is measured
+    slicescope.SetDeviceAttribute("PipelineLatency", TimeValue(Seconds(0)));
+    NetDeviceContainer switchDevices = slicescope.Install(switchNode, switchPorts);
+    Ptr<SlicescopeSwitchNetDevice> switchDevice =
+        DynamicCast<SlicescopeSwitchNetDevice>(switchDevices.Get(0));
+
+    Ptr<Packet> frame = Create<Packet>(payloadSize);
+    Address dest;
+    uint16_t protocol;
+    if (mode == "arp")
+    {
+        dest = Mac48Address::GetBroadcast();
+        protocol = ArpL3Protocol::PROT_NUMBER;
+    }
+    else
+    {
+        UdpHeader udpHeader;
+        udpHeader.SetSourcePort(5000);
+        udpHeader.SetDestinationPort(5000);
+        frame->AddHeader(udpHeader);
+
+        Ipv4Header ipv4Header;
+        ipv4Header.SetSource(Ipv4Address("10.1.1.1"));
+        ipv4Header.SetDestination(Ipv4Address("10.1.1.2"));
+        ipv4Header.SetProtocol(UdpL4Protocol::PROT_NUMBER);
+        ipv4Header.SetPayloadSize(frame->GetSize());
+        ipv4Header.SetTtl(64);
+        frame->AddHeader(ipv4Header);
+
+        // Never used as a source, so the switch never learns it
+        dest = Mac48Address::Allocate();
+        protocol = Ipv4L3Protocol::PROT_NUMBER;
+    }
+
+    for (uint32_t i = 0; i < numFloods; i++)
+    {
+        Simulator::Schedule(interval * i, &SendFrame, peers.Get(0), frame, dest, protocol);
+    }
+
+    auto wallStart = std::chrono::steady_clock::now();
+    Simulator::Run();
+    auto wallNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now() - wallStart)
+                      .count();
+
+    NS_LOG_INFO("Mode: " << mode << " | Ports: " << numPorts << " | Floods: " << numFloods
+                         << " | Replicas received: " << g_rxReplicas);
+    NS_LOG_INFO("Flood replicas: " << switchDevice->GetFloodReplicas()
+                                   << " | Avoided copies: " << switchDevice->GetAvoidedCopies());
+    NS_LOG_INFO("Wall-clock time: "
+                << wallNs / 1e6 << " ms | Per flood: " << wallNs / static_cast<double>(numFloods)
+                << " ns | Per replica: "
+                << (g_rxReplicas ? wallNs / static_cast<double>(g_rxReplicas) : 0) << " ns");
+    Simulator::Destroy();
+
+    if (g_rxReplicas != uint64_t(numFloods) * (numPorts - 1))
+    {
+        NS_FATAL_ERROR("Expected " << uint64_t(numFloods) * (numPorts - 1) << " replicas, got "
+                                   << g_rxReplicas);
+    }
+
+    return 0;
+}
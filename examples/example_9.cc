@@ -0,0 +1,283 @@
+/**
+ * @file example_9.cc
+ * @brief Forwarding microbenchmark of the slicescope switch
+ *
+ * ### Topology
+ * ```
+ *   port 0 (host A) ----+
+ *   port 1 (host B) ----+
+ *     ...               [Slicescope Switch] (numPorts ports)
+ *   port N-1        ----+
+ * ```
+ *
+ * - One SimpleNetDevice per port, each alone on its SimpleChannel: frames sent
+ *   by the switch leave the port and are discarded, so nothing but the switch
+ *   and its ports is measured
+ * - Pre-built frames are handed to port 0 as if they had arrived from the
+ *   wire, in bursts of `--burst` frames so the port queues never overflow:
+ *   - `--scenario=udp`: IPv4/UDP from A to the learned B, with slicescope
+ *     header insertion
+ *   - `--scenario=tcp`: IPv4/TCP from A to the learned B, forwarded untouched
+ *   - `--scenario=broadcast`: broadcast ARP-like frames, flooded
+ *   - `--scenario=unknown`: IPv4/UDP to a MAC address that is never learned,
+ *     flooded
+ *
+ * ### Run
+ *
+ * for s in udp tcp broadcast unknown; do
+ *   ./ns3 run "scratch/example_9 --scenario=$s --numPorts=8 --numPackets=2000000"
+ * done
+ *
+ * Prints the wall-clock time, heap allocations and allocated bytes per
+ * injected frame, together with the peak RSS of the process. Each scenario is
+ * meant to run in its own process so that the peak RSS is its own. The
+ * figures include the receive and transmit path of the SimpleNetDevice ports
+ * and one scheduler event per burst, which do not change between revisions of
+ * the switch.
+ *
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+#include "ns3/slicescope-module.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <sys/resource.h>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("SwitchBenchmark");
+
+static uint64_t g_allocations = 0;    //!< calls to operator new
+static uint64_t g_allocatedBytes = 0; //!< bytes requested from operator new
+
+void*
+operator new(std::size_t size)
+{
+    g_allocations++;
+    g_allocatedBytes += size;
+    void* p = std::malloc(size ? size : 1);
+    if (!p)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void
+operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void
+operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+/**
+ * Hands a burst of frames to a port, then schedules the next burst
+ *
+ * \param port the port receiving the frames
+ * \param frame the pre-built frame
+ * \param protocol the frame protocol
+ * \param to the destination MAC address
+ * \param from the source MAC address
+ * \param burst frames per burst
+ * \param remaining frames left to inject
+ */
+void
+InjectBurst(Ptr<SimpleNetDevice> port,
+            Ptr<Packet> frame,
+            uint16_t protocol,
+            Mac48Address to,
+            Mac48Address from,
+            uint32_t burst,
+            uint64_t remaining)
+{
+    uint32_t n = remaining < burst ? remaining : burst;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        port->Receive(frame, protocol, to, from);
+    }
+    if (remaining > n)
+    {
+        Simulator::Schedule(NanoSeconds(1),
+                            &InjectBurst,
+                            port,
+                            frame,
+                            protocol,
+                            to,
+                            from,
+                            burst,
+                            remaining - n);
+    }
+}
+
+/**
+ * Builds an IPv4 frame from A to B
+ *
+ * \param payloadSize size of the transport payload
+ * \param tcp true for a TCP segment, false for a UDP datagram
+ * \returns the frame, starting with its IPv4 header
+ */
+Ptr<Packet>
+BuildIpv4Frame(uint32_t payloadSize, bool tcp)
+{
+    Ptr<Packet> frame = Create<Packet>(payloadSize);
+    Ipv4Header ipv4Header;
+    if (tcp)
+    {
+        TcpHeader tcpHeader;
+        tcpHeader.SetSourcePort(5000);
+        tcpHeader.SetDestinationPort(5001);
+        tcpHeader.SetFlags(TcpHeader::ACK);
+        frame->AddHeader(tcpHeader);
+        ipv4Header.SetProtocol(TcpL4Protocol::PROT_NUMBER);
+    }
+    else
+    {
+        UdpHeader udpHeader;
+        udpHeader.SetSourcePort(5000);
+        udpHeader.SetDestinationPort(5001);
+        frame->AddHeader(udpHeader);
+        ipv4Header.SetProtocol(UdpL4Protocol::PROT_NUMBER);
+    }
+    ipv4Header.SetSource(Ipv4Address("10.1.1.1"));
+    ipv4Header.SetDestination(Ipv4Address("10.1.1.2"));
+    ipv4Header.SetPayloadSize(frame->GetSize());
+    ipv4Header.SetTtl(64);
+    frame->AddHeader(ipv4Header);
+    return frame;
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t numPorts = 8;
+    uint64_t numPackets = 1000000;
+    uint32_t payloadSize = 64;
+    uint32_t burst = 32;
+    std::string scenario = "udp";
+
+    CommandLine cmd;
+    cmd.AddValue("numPorts", "Number of switch ports", numPorts);
+    cmd.AddValue("numPackets", "Number of frames injected", numPackets);
+    cmd.AddValue("payloadSize", "Transport payload size of the frames", payloadSize);
+    cmd.AddValue("burst", "Frames injected per scheduler event (at most 100)", burst);
+    cmd.AddValue("scenario", "Traffic: udp, tcp, broadcast or unknown", scenario);
+    cmd.Parse(argc, argv);
+
+    LogComponentEnable("SwitchBenchmark", LOG_LEVEL_INFO);
+
+    if (numPorts < 2)
+    {
+        NS_FATAL_ERROR("At least 2 ports are needed");
+    }
+    if (burst == 0 || burst > 100)
+    {
+        NS_FATAL_ERROR("The burst must fit in the port queues (1 to 100 frames)");
+    }
+
+    Ptr<Node> switchNode = CreateObject<Node>();
+    NetDeviceContainer switchPorts;
+    for (uint32_t i = 0; i < numPorts; i++)
+    {
+        Ptr<SimpleNetDevice> port = CreateObject<SimpleNetDevice>();
+        port->SetAddress(Mac48Address::Allocate());
+        port->SetChannel(CreateObject<SimpleChannel>());
+        switchNode->AddDevice(port);
+        switchPorts.Add(port);
+    }
+
+    SlicescopeSwitchHelper slicescope;
+    // No pipeline latency, so that only the forwarding path is measured
+    slicescope.SetDeviceAttribute("PipelineLatency", TimeValue(Seconds(0)));
+    slicescope.SetDeviceAttribute("EnableLayer3", BooleanValue(true));
+    NetDeviceContainer switchDevices = slicescope.Install(switchNode, switchPorts);
+    Ptr<SlicescopeSwitchNetDevice> switchDevice =
+        DynamicCast<SlicescopeSwitchNetDevice>(switchDevices.Get(0));
+
+    Ptr<SimpleNetDevice> portA = DynamicCast<SimpleNetDevice>(switchPorts.Get(0));
+    Ptr<SimpleNetDevice> portB = DynamicCast<SimpleNetDevice>(switchPorts.Get(1));
+    Mac48Address hostA = Mac48Address::Allocate();
+    Mac48Address hostB = Mac48Address::Allocate();
+
+    Ptr<Packet> frame;
+    uint16_t protocol = Ipv4L3Protocol::PROT_NUMBER;
+    Mac48Address dest = hostB;
+    if (scenario == "udp" || scenario == "tcp")
+    {
+        frame = BuildIpv4Frame(payloadSize, scenario == "tcp");
+    }
+    else if (scenario == "broadcast")
+    {
+        frame = Create<Packet>(payloadSize);
+        protocol = ArpL3Protocol::PROT_NUMBER;
+        dest = Mac48Address::GetBroadcast();
+    }
+    else if (scenario == "unknown")
+    {
+        frame = BuildIpv4Frame(payloadSize, false);
+        // Never used as a source, so the switch never learns it
+        dest = Mac48Address::Allocate();
+    }
+    else
+    {
+        NS_FATAL_ERROR("Unknown scenario " << scenario);
+    }
+
+    // Teach the switch where B and A are before measuring
+    Ptr<Packet> announce = Create<Packet>(payloadSize);
+    portB->Receive(announce, ArpL3Protocol::PROT_NUMBER, Mac48Address::GetBroadcast(), hostB);
+    portA->Receive(announce, ArpL3Protocol::PROT_NUMBER, Mac48Address::GetBroadcast(), hostA);
+    Simulator::Run();
+    switchDevice->ResetPortCounters();
+
+    Simulator::Schedule(NanoSeconds(1),
+                        &InjectBurst,
+                        portA,
+                        frame,
+                        protocol,
+                        dest,
+                        hostA,
+                        burst,
+                        numPackets);
+
+    uint64_t allocationsStart = g_allocations;
+    uint64_t bytesStart = g_allocatedBytes;
+    auto wallStart = std::chrono::steady_clock::now();
+    Simulator::Run();
+    auto wallNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now() - wallStart)
+                      .count();
+    uint64_t allocations = g_allocations - allocationsStart;
+    uint64_t allocatedBytes = g_allocatedBytes - bytesStart;
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    uint64_t txPackets = 0;
+    for (const auto& counters : switchDevice->GetPortCounters())
+    {
+        txPackets += counters.txPackets;
+    }
+    double frames = static_cast<double>(numPackets);
+
+    NS_LOG_INFO("Scenario: " << scenario << " | Ports: " << numPorts
+                             << " | Frames injected: " << numPackets
+                             << " | Frames sent by the switch: " << txPackets);
+    NS_LOG_INFO("Wall-clock time: " << wallNs / 1e6 << " ms | Per frame: " << wallNs / frames
+                                    << " ns");
+    NS_LOG_INFO("Allocations per frame: " << allocations / frames
+                                          << " | Bytes allocated per frame: "
+                                          << allocatedBytes / frames);
+    NS_LOG_INFO("Peak RSS: " << usage.ru_maxrss << " KiB");
+    Simulator::Destroy();
+
+    return 0;
+}
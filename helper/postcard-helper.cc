@@ -0,0 +1,81 @@
+#include "postcard-helper.h"
+
+#include "ns3/custom-queue-disc.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/pointer.h"
+#include "ns3/postcard-collector.h"
+#include "ns3/postcard-exporter.h"
+#include "ns3/slicescope-switch-net-device.h"
+#include "ns3/uinteger.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("PostcardHelper");
+
+PostcardHelper::PostcardHelper()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    m_exporterFactory.SetTypeId("ns3::PostcardExporter");
+}
+
+void
+PostcardHelper::SetExporterAttribute(std::string n1, const AttributeValue& v1)
+{
+    NS_LOG_FUNCTION_NOARGS();
+    m_exporterFactory.Set(n1, v1);
+}
+
+Ptr<PostcardCollector>
+PostcardHelper::InstallCollector(Ptr<Node> node)
+{
+    NS_LOG_FUNCTION_NOARGS();
+    m_collector = CreateObject<PostcardCollector>();
+    node->AddApplication(m_collector);
+    m_exporterFactory.Set("Collector", PointerValue(m_collector));
+    return m_collector;
+}
+
+void
+PostcardHelper::Enable(NetDeviceContainer switchDevices)
+{
+    NS_LOG_FUNCTION_NOARGS();
+    NS_ASSERT_MSG(m_collector, "Install the collector before enabling the exporters");
+    for (auto i = switchDevices.Begin(); i != switchDevices.End(); ++i)
+    {
+        Ptr<SlicescopeSwitchNetDevice> dev = DynamicCast<SlicescopeSwitchNetDevice>(*i);
+        if (!dev)
+        {
+            continue;
+        }
+        Ptr<PostcardExporter> exporter = m_exporterFactory.Create<PostcardExporter>();
+        exporter->SetAttribute("ReporterId", UintegerValue(dev->GetNode()->GetId()));
+        dev->SetAttribute("PostcardExporter", PointerValue(exporter));
+    }
+}
+
+void
+PostcardHelper::Enable(QueueDiscContainer queueDiscs)
+{
+    NS_LOG_FUNCTION_NOARGS();
+    NS_ASSERT_MSG(m_collector, "Install the collector before enabling the exporters");
+    for (auto i = queueDiscs.Begin(); i != queueDiscs.End(); ++i)
+    {
+        Ptr<CustomQueueDisc> queueDisc = DynamicCast<CustomQueueDisc>(*i);
+        if (!queueDisc)
+        {
+            continue;
+        }
+        PointerValue node;
+        queueDisc->GetAttribute("Node", node);
+        Ptr<PostcardExporter> exporter = m_exporterFactory.Create<PostcardExporter>();
+        if (node.Get<Node>())
+        {
+            exporter->SetAttribute("ReporterId", UintegerValue(node.Get<Node>()->GetId()));
+        }
+        queueDisc->SetAttribute("PostcardExporter", PointerValue(exporter));
+    }
+}
+
+} // namespace ns3
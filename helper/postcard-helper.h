@@ -0,0 +1,70 @@
+#ifndef POSTCARD_HELPER_H
+#define POSTCARD_HELPER_H
+
+#include "ns3/net-device-container.h"
+#include "ns3/object-factory.h"
+#include "ns3/queue-disc-container.h"
+
+#include <string>
+
+namespace ns3
+{
+
+class Node;
+class AttributeValue;
+class PostcardCollector;
+
+/**
+ * \brief Sets up postcard telemetry: one collector node, and one
+ * ns3::PostcardExporter per switch or queue disc reporting to it
+ */
+class PostcardHelper
+{
+  public:
+    /*
+     * Construct a PostcardHelper
+     */
+    PostcardHelper();
+
+    /**
+     * Set an attribute on each ns3::PostcardExporter created by
+     * PostcardHelper::Enable
+     *
+     * \param n1 the name of the attribute to set
+     * \param v1 the value of the attribute to set
+     */
+    void SetExporterAttribute(std::string n1, const AttributeValue& v1);
+
+    /**
+     * Install the collector application on a node. The exporters created
+     * afterwards report to this collector.
+     *
+     * \param node the collector node
+     * \returns the collector
+     */
+    Ptr<PostcardCollector> InstallCollector(Ptr<Node> node);
+
+    /**
+     * Give each ns3::SlicescopeSwitchNetDevice of the container its own
+     * exporter; other devices are ignored.
+     *
+     * \param switchDevices container of switch devices
+     */
+    void Enable(NetDeviceContainer switchDevices);
+
+    /**
+     * Give each ns3::CustomQueueDisc of the container its own exporter;
+     * other queue discs are ignored.
+     *
+     * \param queueDiscs container of queue discs
+     */
+    void Enable(QueueDiscContainer queueDiscs);
+
+  private:
+    Ptr<PostcardCollector> m_collector; //!< collector of the exporters
+    ObjectFactory m_exporterFactory;    //!< Object factory
+};
+
+} // namespace ns3
+
+#endif /* POSTCARD_HELPER_H */
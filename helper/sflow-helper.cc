@@ -0,0 +1,73 @@
+#include "sflow-helper.h"
+
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/pointer.h"
+#include "ns3/sflow-agent.h"
+#include "ns3/sflow-collector.h"
+#include "ns3/slicescope-switch-net-device.h"
+#include "ns3/uinteger.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("SflowHelper");
+
+SflowHelper::SflowHelper()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    m_agentFactory.SetTypeId("ns3::SflowAgent");
+}
+
+void
+SflowHelper::SetAgentAttribute(std::string n1, const AttributeValue& v1)
+{
+    NS_LOG_FUNCTION_NOARGS();
+    m_agentFactory.Set(n1, v1);
+}
+
+Ptr<SflowCollector>
+SflowHelper::InstallCollector(Ptr<Node> node)
+{
+    NS_LOG_FUNCTION_NOARGS();
+    m_collector = CreateObject<SflowCollector>();
+    node->AddApplication(m_collector);
+    m_agentFactory.Set("Collector", PointerValue(m_collector));
+    return m_collector;
+}
+
+void
+SflowHelper::Enable(NetDeviceContainer switchDevices)
+{
+    NS_LOG_FUNCTION_NOARGS();
+    NS_ASSERT_MSG(m_collector, "Install the collector before enabling the agents");
+    for (auto i = switchDevices.Begin(); i != switchDevices.End(); ++i)
+    {
+        Ptr<SlicescopeSwitchNetDevice> dev = DynamicCast<SlicescopeSwitchNetDevice>(*i);
+        if (!dev)
+        {
+            continue;
+        }
+        Ptr<SflowAgent> agent = m_agentFactory.Create<SflowAgent>();
+        agent->SetAttribute("AgentId", UintegerValue(dev->GetNode()->GetId()));
+        dev->SetAttribute("SflowAgent", PointerValue(agent));
+    }
+}
+
+int64_t
+SflowHelper::AssignStreams(NetDeviceContainer switchDevices, int64_t stream)
+{
+    NS_LOG_FUNCTION_NOARGS();
+    int64_t currentStream = stream;
+    for (auto i = switchDevices.Begin(); i != switchDevices.End(); ++i)
+    {
+        PointerValue agent;
+        if ((*i)->GetAttributeFailSafe("SflowAgent", agent) && agent.Get<SflowAgent>())
+        {
+            currentStream += agent.Get<SflowAgent>()->AssignStreams(currentStream);
+        }
+    }
+    return currentStream - stream;
+}
+
+} // namespace ns3
@@ -0,0 +1,71 @@
+#ifndef SFLOW_HELPER_H
+#define SFLOW_HELPER_H
+
+#include "ns3/net-device-container.h"
+#include "ns3/object-factory.h"
+
+#include <string>
+
+namespace ns3
+{
+
+class Node;
+class AttributeValue;
+class SflowCollector;
+
+/**
+ * \brief Sets up sFlow sampling: one collector node, and one
+ * ns3::SflowAgent per switch reporting to it
+ */
+class SflowHelper
+{
+  public:
+    /*
+     * Construct a SflowHelper
+     */
+    SflowHelper();
+
+    /**
+     * Set an attribute on each ns3::SflowAgent created by
+     * SflowHelper::Enable
+     *
+     * \param n1 the name of the attribute to set
+     * \param v1 the value of the attribute to set
+     */
+    void SetAgentAttribute(std::string n1, const AttributeValue& v1);
+
+    /**
+     * Install the collector application on a node. The agents created
+     * afterwards report to this collector.
+     *
+     * \param node the collector node
+     * \returns the collector
+     */
+    Ptr<SflowCollector> InstallCollector(Ptr<Node> node);
+
+    /**
+     * Give each ns3::SlicescopeSwitchNetDevice of the container its own
+     * agent; other devices are ignored.
+     *
+     * \param switchDevices container of switch devices
+     */
+    void Enable(NetDeviceContainer switchDevices);
+
+    /**
+     * Assign a fixed random variable stream number to the agents of the
+     * switches of a container, which must have been enabled.
+     *
+     * \param switchDevices container of switch devices
+     * \param stream first stream index to use
+     * \return the number of stream indices assigned
+     */
+    int64_t AssignStreams(NetDeviceContainer switchDevices, int64_t stream);
+
+  private:
+    Ptr<SflowCollector> m_collector; //!< collector of the agents
+    ObjectFactory m_agentFactory;    //!< Object factory
+};
+
+} // namespace ns3
+
+#endif /* SFLOW_HELPER_H */
@@ -1,11 +1,17 @@
 #include "slicescope-switch-helper.h"
 
 #include "ns3/bridge-net-device.h"
+#include "ns3/channel.h"
+#include "ns3/ipv4.h"
 #include "ns3/log.h"
 #include "ns3/names.h"
 #include "ns3/node.h"
+#include "ns3/pointer.h"
 #include "ns3/slicescope-switch-net-device.h"
 
+#include <queue>
+#include <set>
+
 namespace ns3
 {
 
@@ -24,6 +30,13 @@ SlicescopeSwitchHelper::SetDeviceAttribute(std::string n1, const AttributeValue&
     m_deviceFactory.Set(n1, v1);
 }
 
+void
+SlicescopeSwitchHelper::SetPipeline(Ptr<SlicescopePipeline> pipeline)
+{
+    NS_LOG_FUNCTION_NOARGS();
+    m_deviceFactory.Set("Pipeline", PointerValue(pipeline));
+}
+
 NetDeviceContainer
 SlicescopeSwitchHelper::Install(Ptr<Node> node, NetDeviceContainer c)
 {
@@ -52,4 +65,139 @@ SlicescopeSwitchHelper::Install(std::string nodeName, NetDeviceContainer c)
     return Install(node, c);
 }
 
+void
+SlicescopeSwitchHelper::PopulateRoutes(NetDeviceContainer switchDevices)
+{
+    NS_LOG_FUNCTION_NOARGS();
+    for (auto i = switchDevices.Begin(); i != switchDevices.End(); ++i)
+    {
+        Ptr<SlicescopeSwitchNetDevice> dev = DynamicCast<SlicescopeSwitchNetDevice>(*i);
+        if (!dev)
+        {
+            continue;
+        }
+        RouteMap routes;
+        for (uint32_t port = 0; port < dev->GetNBridgePorts(); port++)
+        {
+            // Breadth-first walk over the channels behind this port
+            std::set<Ptr<Channel>> visited;
+            PendingDevices pending;
+            pending.emplace(dev->GetBridgePort(port), 0);
+            while (!pending.empty())
+            {
+                auto [from, hops] = pending.front();
+                pending.pop();
+                Ptr<Channel> channel = from->GetChannel();
+                if (!channel || !visited.insert(channel).second)
+                {
+                    continue;
+                }
+                for (std::size_t d = 0; d < channel->GetNDevices(); d++)
+                {
+                    Ptr<NetDevice> peer = channel->GetDevice(d);
+                    if (peer == from)
+                    {
+                        continue;
+                    }
+                    if (AddBridgedPorts(peer, hops + 1, pending))
+                    {
+                        continue;
+                    }
+                    AddRoutesToInterface(routes, port, hops, peer);
+                }
+            }
+        }
+        for (const auto& [prefix, route] : routes)
+        {
+            Ipv4Mask mask(prefix.second);
+            NS_LOG_INFO("**** Route " << Ipv4Address(prefix.first) << "/"
+                                      << mask.GetPrefixLength() << " via port " << route.port
+                                      << ", " << route.hops << " switches behind");
+            dev->AddRoute(Ipv4Address(prefix.first), mask, route.port);
+        }
+    }
+}
+
+bool
+SlicescopeSwitchHelper::AddBridgedPorts(Ptr<NetDevice> device,
+                                        uint32_t hops,
+                                        PendingDevices& pending)
+{
+    Ptr<Node> node = device->GetNode();
+    for (uint32_t n = 0; n < node->GetNDevices(); n++)
+    {
+        Ptr<SlicescopeSwitchNetDevice> other =
+            DynamicCast<SlicescopeSwitchNetDevice>(node->GetDevice(n));
+        if (!other)
+        {
+            continue;
+        }
+        bool bridged = false;
+        for (uint32_t p = 0; p < other->GetNBridgePorts(); p++)
+        {
+            bridged = bridged || other->GetBridgePort(p) == device;
+        }
+        if (bridged)
+        {
+            for (uint32_t p = 0; p < other->GetNBridgePorts(); p++)
+            {
+                if (other->GetBridgePort(p) != device)
+                {
+                    pending.emplace(other->GetBridgePort(p), hops);
+                }
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void
+SlicescopeSwitchHelper::AddRoutesToInterface(RouteMap& routes,
+                                             uint32_t port,
+                                             uint32_t hops,
+                                             Ptr<NetDevice> device)
+{
+    Ptr<Ipv4> ipv4 = device->GetNode()->GetObject<Ipv4>();
+    if (!ipv4)
+    {
+        return;
+    }
+    int32_t interface = ipv4->GetInterfaceForDevice(device);
+    if (interface < 0)
+    {
+        return;
+    }
+    // A route found later replaces one only if it crosses fewer switches
+    auto offer = [&routes, port, hops](Ipv4Address network, Ipv4Mask mask) {
+        auto [it, added] = routes.emplace(std::make_pair(network.Get(), mask.Get()),
+                                          Route{port, hops});
+        if (!added && hops < it->second.hops)
+        {
+            it->second = Route{port, hops};
+        }
+    };
+    for (uint32_t a = 0; a < ipv4->GetNAddresses(interface); a++)
+    {
+        offer(ipv4->GetAddress(interface, a).GetLocal(), Ipv4Mask::GetOnes());
+    }
+    if (!ipv4->IsForwarding(interface))
+    {
+        return;
+    }
+    // A router behind the port also reaches its other subnets (interface 0 is loopback)
+    for (uint32_t j = 1; j < ipv4->GetNInterfaces(); j++)
+    {
+        if (static_cast<int32_t>(j) == interface)
+        {
+            continue;
+        }
+        for (uint32_t a = 0; a < ipv4->GetNAddresses(j); a++)
+        {
+            Ipv4InterfaceAddress ifAddress = ipv4->GetAddress(j, a);
+            offer(ifAddress.GetLocal().CombineMask(ifAddress.GetMask()), ifAddress.GetMask());
+        }
+    }
+}
+
 } // namespace ns3
\ No newline at end of file
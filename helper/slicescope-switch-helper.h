@@ -4,13 +4,18 @@
 #include "ns3/net-device-container.h"
 #include "ns3/object-factory.h"
 
+#include <map>
+#include <queue>
 #include <string>
+#include <utility>
 
 namespace ns3
 {
 
 class Node;
 class AttributeValue;
+class SlicescopePipeline;
+class SlicescopeSwitchNetDevice;
 
 /**
  * \brief Add capability to switch multiple LAN segments (IEEE 802.1D bridging)
@@ -32,6 +37,16 @@ class SlicescopeSwitchHelper
      */
     void SetDeviceAttribute(std::string n1, const AttributeValue& v1);
 
+    /**
+     * Set the match-action pipeline run by each ns3::SlicescopeSwitchNetDevice
+     * created by SlicescopeSwitchHelper::Install. The devices share the
+     * pipeline, so its table and action counters aggregate over all of them;
+     * use one pipeline per switch to count separately.
+     *
+     * \param pipeline the pipeline, already filled with its tables
+     */
+    void SetPipeline(Ptr<SlicescopePipeline> pipeline);
+
     /**
      * This method creates an ns3::SlicescopeSwitchNetDevice with the attributes
      * configured by SlicescopeSwitchHelper::SetDeviceAttribute, adds the device
@@ -56,7 +71,62 @@ class SlicescopeSwitchHelper
      */
     NetDeviceContainer Install(std::string nodeName, NetDeviceContainer c);
 
+    /**
+     * Fill the LPM table of each ns3::SlicescopeSwitchNetDevice in the
+     * container from the topology. Every IPv4 interface reachable behind a
+     * port (directly, or through other slicescope switches) gets a host route
+     * on that port; when that interface belongs to a forwarding node with
+     * further interfaces, their subnets are routed through the same port.
+     * A prefix reached through several ports is routed through the one that
+     * crosses the fewest switches, the lowest port index on a tie.
+     *
+     * Call this after IP addresses have been assigned, and set the
+     * ForwardingMode attribute to Lpm to forward with these routes.
+     *
+     * \param switchDevices Container of switch devices returned by Install
+     */
+    void PopulateRoutes(NetDeviceContainer switchDevices);
+
   private:
+    /// Route to a prefix found by the walk
+    struct Route
+    {
+        uint32_t port; //!< index of the port the prefix is reached through
+        uint32_t hops; //!< switches crossed behind the port
+    };
+
+    /// Routes of one switch, by network and mask
+    typedef std::map<std::pair<uint32_t, uint32_t>, Route> RouteMap;
+
+    /// Devices whose channels remain to be visited, with the switches crossed to reach them
+    typedef std::queue<std::pair<Ptr<NetDevice>, uint32_t>> PendingDevices;
+
+    /**
+     * If a device is a port of a slicescope switch, queue the other ports of
+     * that switch so the route walk continues behind it.
+     *
+     * \param device the device found on a channel
+     * \param hops the switches crossed behind the other ports
+     * \param pending the devices whose channels remain to be visited
+     * \returns true if the device is a switch port
+     */
+    bool AddBridgedPorts(Ptr<NetDevice> device, uint32_t hops, PendingDevices& pending);
+
+    /**
+     * Find the routes towards an IPv4 interface reached behind a switch
+     * port, keeping those that cross fewer switches than the routes found
+     * before to the same prefixes.
+     *
+     * \param routes the routes of the switch
+     * \param port the index of the port the interface is reached through
+     * \param hops the switches crossed to reach the interface
+     * \param device the device holding the IPv4 interface
+     */
+    void AddRoutesToInterface(RouteMap& routes,
+                              uint32_t port,
+                              uint32_t hops,
+                              Ptr<NetDevice> device);
+
     ObjectFactory m_deviceFactory; //!< Object factory
 };
 
@@ -157,4 +157,134 @@ TopologyHelper::SetQueueWeights(std::map<Slice::SliceType, uint32_t> sliceTypeTo
     }
 }
 
+void
+TopologyHelper::SetEcnThresholds(
+    std::map<Slice::SliceType, CustomQueueDisc::EcnThresholds> thresholds)
+{
+    for (uint32_t i = 0; i < allQueueDiscs.GetN(); i++)
+    {
+        Ptr<CustomQueueDisc> queueDisc = DynamicCast<CustomQueueDisc>(allQueueDiscs.Get(i));
+        if (!queueDisc)
+        {
+            continue;
+        }
+
+        queueDisc->SetEcnThresholds(thresholds);
+    }
+}
+
+void
+TopologyHelper::EnableDctcp(std::map<Slice::SliceType, uint32_t> markingThresholds)
+{
+    std::map<Slice::SliceType, CustomQueueDisc::EcnThresholds> thresholds;
+    for (const auto& [sliceType, bytes] : markingThresholds)
+    {
+        thresholds[sliceType] = CustomQueueDisc::EcnThresholds{bytes, bytes, 1.0};
+    }
+    SetEcnThresholds(thresholds);
+
+    for (uint32_t i = 0; i < hosts.GetN(); i++)
+    {
+        Ptr<TcpL4Protocol> tcp = hosts.Get(i)->GetObject<TcpL4Protocol>();
+        if (!tcp)
+        {
+            NS_LOG_WARN("[TopologyHelper] No TCP on " << Names::FindName(hosts.Get(i)));
+            continue;
+        }
+        tcp->SetAttribute("SocketType", TypeIdValue(TcpDctcp::GetTypeId()));
+    }
+}
+
+void
+TopologyHelper::IsolateSlices(const std::vector<Ptr<Slice>>& slices)
+{
+    // The weight of a type is split evenly among its slices
+    std::map<Slice::SliceType, uint32_t> slicesPerType;
+    for (const auto& slice : slices)
+    {
+        slicesPerType[slice->GetSliceType()]++;
+    }
+
+    for (uint32_t i = 0; i < allQueueDiscs.GetN(); i++)
+    {
+        Ptr<CustomQueueDisc> queueDisc = DynamicCast<CustomQueueDisc>(allQueueDiscs.Get(i));
+        if (!queueDisc)
+        {
+            continue;
+        }
+
+        uint32_t numQueues = CustomQueueDisc::queueIndexToSliceTypeMap.size();
+        queueDisc->SetAttribute("NumQueues", UintegerValue(numQueues + slices.size()));
+        Ptr<SharedBufferPool> pool = queueDisc->GetSharedBuffer();
+        for (uint32_t k = 0; k < slices.size(); k++)
+        {
+            // Each slice queue starts as a copy of the queue of its slice type
+            Slice::SliceType sliceType = slices[k]->GetSliceType();
+            uint32_t typeQueue = CustomQueueDisc::sliceTypeToQueueIndexMap.at(sliceType);
+            uint32_t queue = numQueues + k;
+            queueDisc->MapSliceId(slices[k]->GetSliceId(), queue, sliceType);
+            queueDisc->SetQueueWeight(queue,
+                                      queueDisc->GetQueueWeight(typeQueue) /
+                                          slicesPerType.at(sliceType));
+            queueDisc->SetQueueSize(queue, queueDisc->GetQueueSize(typeQueue));
+            queueDisc->SetQueueEcnThresholds(queue, queueDisc->GetQueueEcnThresholds(typeQueue));
+            if (queueDisc->GetQueueAqm(typeQueue))
+            {
+                queueDisc->SetQueueAqm(queue, queueDisc->GetQueueAqmFactory(typeQueue));
+            }
+            if (pool)
+            {
+                pool->SetAlpha(queue, pool->GetAlpha(typeQueue));
+            }
+        }
+    }
+}
+
+void
+TopologyHelper::SetAqm(std::map<Slice::SliceType, ObjectFactory> aqms)
+{
+    for (uint32_t i = 0; i < allQueueDiscs.GetN(); i++)
+    {
+        Ptr<CustomQueueDisc> queueDisc = DynamicCast<CustomQueueDisc>(allQueueDiscs.Get(i));
+        if (!queueDisc)
+        {
+            continue;
+        }
+
+        queueDisc->SetAqm(aqms);
+    }
+}
+
+std::map<Ptr<Node>, Ptr<SharedBufferPool>>
+TopologyHelper::EnableSharedBuffers(ObjectFactory factory,
+                                    std::map<Slice::SliceType, double> sliceAlphas)
+{
+    std::map<Ptr<Node>, Ptr<SharedBufferPool>> pools;
+    for (uint32_t i = 0; i < allQueueDiscs.GetN(); i++)
+    {
+        Ptr<CustomQueueDisc> queueDisc = DynamicCast<CustomQueueDisc>(allQueueDiscs.Get(i));
+        if (!queueDisc)
+        {
+            continue;
+        }
+
+        PointerValue node;
+        queueDisc->GetAttribute("Node", node);
+        Ptr<SharedBufferPool>& pool = pools[node.Get<Node>()];
+        if (!pool)
+        {
+            pool = factory.Create<SharedBufferPool>();
+            for (const auto& [sliceType, alpha] : sliceAlphas)
+            {
+                pool->SetAlpha(CustomQueueDisc::sliceTypeToQueueIndexMap.at(sliceType), alpha);
+            }
+            NS_LOG_DEBUG("[TopologyHelper] Shared buffer of "
+                         << pool->GetBufferSize() << " bytes on "
+                         << Names::FindName(node.Get<Node>()));
+        }
+        queueDisc->SetSharedBuffer(pool);
+    }
+    return pools;
+}
+
 } // namespace ns3
\ No newline at end of file
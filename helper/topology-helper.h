@@ -3,10 +3,12 @@
 
 #include "ns3/bridge-module.h"
 #include "ns3/csma-module.h"
+#include "ns3/custom-queue-disc.h"
 #include "ns3/internet-module.h"
 #include "ns3/network-module.h"
 #include "ns3/point-to-point-module.h"
 #include "ns3/queue-disc-container.h"
+#include "ns3/shared-buffer-pool.h"
 #include "ns3/slice.h"
 #include "ns3/string.h"
 
@@ -32,6 +34,56 @@ class TopologyHelper : public Object
 
     void SetQueueWeights(std::map<Slice::SliceType, uint32_t> sliceTypeToQueueWeightMap);
 
+    /**
+     * \brief Sets the ECN marking thresholds of every custom queue disc
+     * \param thresholds the thresholds of each slice queue
+     */
+    void SetEcnThresholds(std::map<Slice::SliceType, CustomQueueDisc::EcnThresholds> thresholds);
+
+    /**
+     * \brief Configures the topology for DCTCP
+     *
+     * The hosts create DCTCP sockets, which send ECT packets, and the custom
+     * queue discs mark them CE as soon as a slice queue holds its threshold.
+     * The TCP sockets created before are not changed.
+     *
+     * \param markingThresholds the step marking threshold of each slice queue, in bytes
+     */
+    void EnableDctcp(std::map<Slice::SliceType, uint32_t> markingThresholds);
+
+    /**
+     * \brief Sets the active queue management of the slice queues of every custom queue disc
+     * \param aqms the factory of the AQM of each slice; the other slices stay drop-tail
+     */
+    void SetAqm(std::map<Slice::SliceType, ObjectFactory> aqms);
+
+    /**
+     * \brief Gives every slice instance its own queue in the custom queue discs
+     *
+     * The queue of a slice starts with the size, ECN thresholds, AQM and
+     * shared buffer alpha of the queue of its slice type, and an equal part
+     * of its weight, so this is called after SetQueueWeights,
+     * SetEcnThresholds, EnableDctcp, SetAqm or EnableSharedBuffers, and
+     * before the simulation starts; calling it again with the same slices
+     * changes nothing. The slices of a type then share its bandwidth
+     * equally instead of competing in one FIFO, and the types keep their
+     * shares: 3 URLLC slices and 1 eMBB slice still get 80:15. The queue of
+     * the type keeps its weight for the packets of no slice.
+     *
+     * \param slices the slices, whose traffic generators tag their packets with the slice id
+     */
+    void IsolateSlices(const std::vector<Ptr<Slice>>& slices);
+
+    /**
+     * \brief Makes the custom queue discs of each switch share one packet buffer
+     * \param factory factory of the buffers, e.g. with their BufferSize and Alpha
+     * \param sliceAlphas dynamic threshold factor of each slice queue, if not Alpha
+     * \returns the buffer of each switch
+     */
+    std::map<Ptr<Node>, Ptr<SharedBufferPool>> EnableSharedBuffers(
+        ObjectFactory factory,
+        std::map<Slice::SliceType, double> sliceAlphas = {});
+
   protected:
     NodeContainer switches;
     NodeContainer hosts;
@@ -0,0 +1,128 @@
+#ifndef MAC_LEARNING_TABLE_H
+#define MAC_LEARNING_TABLE_H
+
+#include "ns3/mac48-address.h"
+#include "ns3/nstime.h"
+
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::MacLearningTable declaration.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup bridge
+ * \brief Flat MAC learning table with timer-wheel aging
+ *
+ * Entries live in a single open-addressing array (linear probing, backward
+ * shift deletion) keyed by the 48-bit MAC address, so a lookup touches one or
+ * two cache lines instead of walking a tree. Expired entries are removed in
+ * bulk by a hashed timer wheel that is advanced lazily from Learn() and
+ * Lookup(), so the table never schedules simulator events.
+ *
+ * The table stores port indexes rather than NetDevice pointers; the owner
+ * maps them back to its ports.
+ */
+class MacLearningTable
+{
+  public:
+    /// Returned by Lookup() when no valid entry exists
+    static constexpr uint32_t NO_PORT = 0xffffffff;
+
+    MacLearningTable();
+
+    /**
+     * \brief Set the number of entries the table holds before growing
+     * \param capacity the initial capacity (rounded up to a power of two)
+     *
+     * Existing entries are kept.
+     */
+    void SetCapacity(uint32_t capacity);
+
+    /**
+     * \brief Set the lifetime of a learned entry
+     * \param expirationTime time after which an entry that was not refreshed expires
+     */
+    void SetExpirationTime(Time expirationTime);
+
+    /**
+     * \brief Set the number of timer wheel slots
+     * \param numSlots number of slots; the wheel tick is ExpirationTime / numSlots
+     */
+    void SetWheelSlots(uint32_t numSlots);
+
+    /**
+     * \brief Learn or refresh the port an address is sending from
+     * \param address the source address
+     * \param port the port index
+     * \returns true if the address was new or moved to a different port
+     */
+    bool Learn(Mac48Address address, uint32_t port);
+
+    /**
+     * \brief Look up the port associated to an address
+     * \param address the destination address
+     * \returns the port index, or NO_PORT if no valid entry exists
+     */
+    uint32_t Lookup(Mac48Address address);
+
+    /// Remove all entries and reset the counters
+    void Clear();
+
+    /// \returns the number of valid entries
+    uint32_t GetOccupancy() const;
+    /// \returns the number of timer wheel slots
+    uint32_t GetWheelSlots() const;
+    /// \returns the number of entries the table can hold before growing
+    uint32_t GetCapacity() const;
+    /// \returns the number of lookups that found a valid entry
+    uint64_t GetHits() const;
+    /// \returns the number of lookups that did not find a valid entry
+    uint64_t GetMisses() const;
+    /// \returns the number of entries removed because they expired
+    uint64_t GetEvictions() const;
+
+  private:
+    /// Table slot
+    struct Entry
+    {
+        uint64_t key;       //!< MAC address with the occupied bit set, 0 if empty
+        int64_t expiration; //!< expiration time in simulator time steps
+        uint32_t port;      //!< port index
+        uint32_t wheelSlot; //!< wheel slot currently holding this key
+    };
+
+    static uint64_t MakeKey(Mac48Address address);
+    uint32_t Hash(uint64_t key) const;
+    uint32_t Find(uint64_t key) const;
+    void Erase(uint32_t index);
+    void Resize(uint32_t numBuckets);
+    uint32_t WheelSlotFor(int64_t expiration) const;
+    void AdvanceWheel(int64_t now);
+    void ExpireSlot(uint32_t slot, int64_t now);
+    void RebuildWheel();
+
+    std::vector<Entry> m_entries; //!< open-addressing array (power of two size)
+    uint32_t m_mask;              //!< m_entries.size () - 1
+    uint32_t m_size;              //!< number of occupied entries
+    uint32_t m_capacity;          //!< entries held before the array doubles
+
+    std::vector<std::vector<uint64_t>> m_wheel; //!< keys bucketed by expiration tick
+    int64_t m_expiration;                       //!< entry lifetime in time steps
+    int64_t m_tick;                             //!< wheel tick length in time steps
+    int64_t m_wheelTick;                        //!< last tick processed by the wheel
+
+    uint64_t m_hits;      //!< lookups that found a valid entry
+    uint64_t m_misses;    //!< lookups that did not find a valid entry
+    uint64_t m_evictions; //!< entries removed by aging
+};
+
+} // namespace ns3
+
+#endif /* MAC_LEARNING_TABLE_H */
@@ -1,5 +1,8 @@
 #include "custom-packet-sink.h"
 
+#include "metadata-tag.h"
+#include "slicescope-header.h"
+#include "slicescope-tag.h"
 #include "time-tag.h"
 
 #include "ns3/boolean.h"
@@ -10,6 +13,7 @@
 #include "ns3/udp-socket-factory.h"
 #include "ns3/uinteger.h"
 
+#include <algorithm>
 #include <cstdint>
 
 namespace ns3
@@ -43,7 +47,8 @@ CustomPacketSink::CustomPacketSink()
     : m_socket(nullptr),
       m_port(9),
       m_totalRxBytes(0),
-      m_totalRxPackets(0)
+      m_totalRxPackets(0),
+      m_intLastHopStats()
 {
 }
 
@@ -128,6 +133,12 @@ CustomPacketSink::HandleRead(Ptr<Socket> socket)
             m_owdRecords.emplace_back(Simulator::Now(), owd);
         }
 
+        SlicescopeTag slicescopeTag;
+        if (packet->PeekPacketTag(slicescopeTag))
+        {
+            RecordIntStack(packet);
+        }
+
         InetSocketAddress senderAddress = InetSocketAddress::ConvertFrom(from);
         Ipv4Address srcIp = senderAddress.GetIpv4();
         uint16_t srcPort = senderAddress.GetPort();
@@ -152,6 +163,47 @@ CustomPacketSink::HandleRead(Ptr<Socket> socket)
     }
 }
 
+void
+CustomPacketSink::RecordIntStack(Ptr<const Packet> packet)
+{
+    SlicescopeHeader slicescopeHeader;
+    packet->PeekHeader(slicescopeHeader);
+    for (const auto& record : slicescopeHeader.GetHops())
+    {
+        UpdateIntHopStats(m_intHopStats[record.switchId],
+                          record.hopLatency * 1e-9,
+                          record.queueDepth);
+    }
+
+    // One entry per distinct path, whatever the number of packets
+    if (slicescopeHeader.GetPathFilterSize() > 0)
+    {
+        m_pathFilters[slicescopeHeader.GetPathFilter()]++;
+    }
+
+    MetadataTag metadataTag;
+    if (slicescopeHeader.GetHopCount() > 0 && packet->PeekPacketTag(metadataTag))
+    {
+        Time lastHop = Simulator::Now() - metadataTag.GetEgressTimestamp();
+        UpdateIntHopStats(m_intLastHopStats, lastHop.GetSeconds(), 0);
+    }
+    NS_LOG_DEBUG("[INT] Node " << GetNode()->GetId() << " → " << slicescopeHeader);
+}
+
+void
+CustomPacketSink::UpdateIntHopStats(IntHopStats& stats, double latency, uint32_t queueDepth)
+{
+    if (stats.packets == 0 || latency < stats.minLatency)
+    {
+        stats.minLatency = latency;
+    }
+    stats.maxLatency = std::max(stats.maxLatency, latency);
+    stats.totalLatency += latency;
+    stats.totalQueueDepth += queueDepth;
+    stats.maxQueueDepth = std::max(stats.maxQueueDepth, queueDepth);
+    stats.packets++;
+}
+
 uint32_t
 CustomPacketSink::GetTotalRxPackets() const
 {
@@ -202,4 +254,54 @@ CustomPacketSink::GetOwdRecords() const
     return m_owdRecords;
 }
 
+std::map<uint16_t, IntHopStats>
+CustomPacketSink::GetIntHopStats() const
+{
+    return m_intHopStats;
+}
+
+IntHopStats
+CustomPacketSink::GetIntLastHopStats() const
+{
+    return m_intLastHopStats;
+}
+
+std::map<std::vector<uint8_t>, uint64_t>
+CustomPacketSink::GetPathFilters() const
+{
+    return m_pathFilters;
+}
+
+std::vector<uint64_t>
+CustomPacketSink::CountPaths(const std::vector<std::vector<uint16_t>>& paths,
+                             uint64_t& unresolved) const
+{
+    std::vector<uint64_t> counts(paths.size(), 0);
+    unresolved = 0;
+    SlicescopeHeader header;
+    for (const auto& [filter, packets] : m_pathFilters)
+    {
+        header.SetPathFilter(filter);
+        uint32_t match = 0;
+        uint32_t matches = 0;
+        for (uint32_t i = 0; i < paths.size(); i++)
+        {
+            if (header.MatchesPath(paths[i]))
+            {
+                match = i;
+                matches++;
+            }
+        }
+        if (matches == 1)
+        {
+            counts[match] += packets;
+        }
+        else
+        {
+            unresolved += packets;
+        }
+    }
+    return counts;
+}
+
 } // namespace ns3
@@ -8,6 +8,7 @@
 
 #include <cstdint>
 #include <map>
+#include <vector>
 
 namespace ns3
 {
@@ -18,6 +19,17 @@ struct FlowStats
     uint32_t totalPackets;
 };
 
+/// Telemetry statistics of one hop, decoded from the slicescope header
+struct IntHopStats
+{
+    uint64_t packets;         //!< packets that carried a record of the hop
+    double totalLatency;      //!< sum of the hop latencies, in seconds
+    double minLatency;        //!< smallest hop latency, in seconds
+    double maxLatency;        //!< largest hop latency, in seconds
+    uint64_t totalQueueDepth; //!< sum of the egress queue depths, in packets
+    uint32_t maxQueueDepth;   //!< largest egress queue depth, in packets
+};
+
 class CustomPacketSink : public Application
 {
   public:
@@ -31,11 +43,52 @@ class CustomPacketSink : public Application
     std::vector<double> GetOwd() const;
     std::vector<std::pair<Time, double>> GetOwdRecords() const;
 
+    /**
+     * \brief Gets the per-hop latency statistics of the received INT stacks
+     * \returns the statistics of each switch, by switch id
+     */
+    std::map<uint16_t, IntHopStats> GetIntHopStats() const;
+
+    /**
+     * \brief Gets the latency statistics between the last switch and this sink
+     * \returns the statistics of the last hop (queue depths are not known)
+     */
+    IntHopStats GetIntLastHopStats() const;
+
+    /**
+     * \brief Gets the path filters of the received slicescope headers
+     * \returns the number of packets received with each filter value
+     */
+    std::map<std::vector<uint8_t>, uint64_t> GetPathFilters() const;
+
+    /**
+     * \brief Attributes the received packets to the known paths of the topology
+     * \param paths the candidate paths, as switch ids (SwitchId or node ids)
+     * \param unresolved set to the packets matching no path or several paths
+     * \returns the number of packets that took each path
+     */
+    std::vector<uint64_t> CountPaths(const std::vector<std::vector<uint16_t>>& paths,
+                                     uint64_t& unresolved) const;
+
   private:
     void StartApplication() override;
     void StopApplication() override;
     void HandleRead(Ptr<Socket> socket);
 
+    /**
+     * \brief Decodes the INT stack and path filter of a packet into the statistics
+     * \param packet a received payload starting with a SlicescopeHeader
+     */
+    void RecordIntStack(Ptr<const Packet> packet);
+
+    /**
+     * \brief Adds one hop sample to a statistics entry
+     * \param stats the entry
+     * \param latency the hop latency, in seconds
+     * \param queueDepth the egress queue depth, in packets
+     */
+    static void UpdateIntHopStats(IntHopStats& stats, double latency, uint32_t queueDepth);
+
     Ptr<Socket> m_socket;
     Address m_localAddress;
     uint16_t m_port;
@@ -44,6 +97,9 @@ class CustomPacketSink : public Application
     std::map<std::pair<Ipv4Address, uint16_t>, FlowStats> m_flowStats;
     std::vector<double> m_owd;
     std::vector<std::pair<Time, double>> m_owdRecords;
+    std::map<uint16_t, IntHopStats> m_intHopStats;
+    IntHopStats m_intLastHopStats;
+    std::map<std::vector<uint8_t>, uint64_t> m_pathFilters;
 
     double m_firstPacketTime = 0.0;
     double m_lastPacketTime = 0.0;
@@ -1,10 +1,15 @@
 #include "custom-queue-disc.h"
 
+#include "flow-key.h"
 #include "metadata-tag.h"
+#include "postcard-exporter.h"
+#include "shared-buffer-pool.h"
+#include "slice-id-tag.h"
 #include "slice.h"
 #include "time-tag.h"
 
 #include "ns3/drop-tail-queue.h"
+#include "ns3/enum.h"
 #include "ns3/ipv4-queue-disc-item.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
@@ -12,6 +17,9 @@
 #include <ns3/pointer.h>
 #include <ns3/slice.h>
 
+#include <algorithm>
+#include <cmath>
+#include <numeric>
 #include <sys/types.h>
 
 namespace ns3
@@ -51,20 +59,74 @@ CustomQueueDisc::GetTypeId()
                                           "The port this queue disc is attached to",
                                           UintegerValue(0),
                                           MakeUintegerAccessor(&CustomQueueDisc::m_port),
-                                          MakeUintegerChecker<uint32_t>());
+                                          MakeUintegerChecker<uint32_t>())
+                            .AddAttribute("PostcardExporter",
+                                          "Exporter sending postcard reports about the "
+                                          "dequeued packets, if any",
+                                          PointerValue(),
+                                          MakePointerAccessor(&CustomQueueDisc::m_postcardExporter),
+                                          MakePointerChecker<PostcardExporter>())
+                            .AddAttribute("NumQueues",
+                                          "Number of internal queues: the URLLC, eMBB and "
+                                          "mMTC queues, then the queues given to DSCPs or "
+                                          "slices with MapDscp and MapSliceId",
+                                          UintegerValue(3),
+                                          MakeUintegerAccessor(&CustomQueueDisc::m_numQueues),
+                                          MakeUintegerChecker<uint32_t>(3))
+                            .AddAttribute("DefaultQueueSize",
+                                          "Size of the queues after the first three, unless "
+                                          "set with SetQueueSize",
+                                          QueueSizeValue(QueueSize("100KB")),
+                                          MakeQueueSizeAccessor(
+                                              &CustomQueueDisc::m_defaultQueueSize),
+                                          MakeQueueSizeChecker())
+                            .AddAttribute("Scheduler",
+                                          "How the internal queues share the port: deficit "
+                                          "round robin, or WF2Q+ for a smoother service",
+                                          EnumValue(CustomQueueDisc::DRR),
+                                          MakeEnumAccessor<Scheduler>(
+                                              &CustomQueueDisc::m_scheduler),
+                                          MakeEnumChecker<Scheduler>(CustomQueueDisc::DRR,
+                                                                     "Drr",
+                                                                     CustomQueueDisc::WF2Q,
+                                                                     "Wf2q"))
+                            .AddAttribute("QuantumBytes",
+                                          "Bytes the queue with the smallest weight may send "
+                                          "per round; the other queues send in proportion to "
+                                          "their weights",
+                                          UintegerValue(1500),
+                                          MakeUintegerAccessor(&CustomQueueDisc::m_quantumBytes),
+                                          MakeUintegerChecker<uint32_t>(1))
+                            .AddAttribute("SharedBuffer",
+                                          "Buffer shared with the other ports of the switch, "
+                                          "if any",
+                                          PointerValue(),
+                                          MakePointerAccessor(&CustomQueueDisc::SetSharedBuffer,
+                                                              &CustomQueueDisc::GetSharedBuffer),
+                                          MakePointerChecker<SharedBufferPool>());
     return tid;
 }
 
 CustomQueueDisc::CustomQueueDisc()
 {
-    m_queueDelays.resize(3);
-    m_maxPacketsinQueue.resize(3);
-    m_queueWeights.resize(3);
+    m_numQueues = 3;
+    ResizeQueues(3);
     m_queueWeights = {80, 15, 5}; // URLLC, eMBB, mMTC
-    m_lastServedQueueIndex = 0;
+    m_queueSizes = {QueueSize("20KB"), QueueSize("500KB"), QueueSize("200KB")};
+    for (const auto& [queueIndex, sliceType] : queueIndexToSliceTypeMap)
+    {
+        m_queueSliceTypes[queueIndex] = sliceType;
+    }
+    m_defaultQueueSize = QueueSize("100KB");
+    m_markRng = CreateObject<UniformRandomVariable>();
+    m_quantumBytes = 1500;
+    m_scheduler = DRR;
+    m_virtualTime = 0;
+    UpdateQuantums();
     m_node = nullptr;
     m_netDevice = nullptr;
     m_port = 0;
+    m_bufferPort = 0;
 }
 
 CustomQueueDisc::~CustomQueueDisc()
@@ -72,18 +134,31 @@ CustomQueueDisc::~CustomQueueDisc()
 }
 
 uint32_t
-CustomQueueDisc::GetQueueIndexFromDscp(uint8_t dscp) const
+CustomQueueDisc::GetQueueIndex(Ptr<const Ipv4QueueDiscItem> item) const
 {
-    if (dscp == 0)
+    // Only packets of the slices given their own queue pay for the tag lookup
+    if (!m_queueIndexBySliceId.empty())
     {
-        return 1; // Default to eMBB
+        SliceIdTag sliceIdTag;
+        if (item->GetPacket()->PeekPacketTag(sliceIdTag) &&
+            sliceIdTag.GetSliceId() < m_queueIndexBySliceId.size() &&
+            m_queueIndexBySliceId[sliceIdTag.GetSliceId()] != NO_QUEUE)
+        {
+            return m_queueIndexBySliceId[sliceIdTag.GetSliceId()];
+        }
     }
-    auto it = sliceTypeToQueueIndexMap.find(Slice::dscpToSliceTypeMap.at(dscp));
-    if (it != sliceTypeToQueueIndexMap.end())
+    return m_dscpQueueMap.GetQueueIndex(item->GetHeader().GetDscp());
+}
+
+std::string
+CustomQueueDisc::GetQueueName(uint32_t queueIndex) const
+{
+    auto it = queueIndexToSliceTypeMap.find(queueIndex);
+    if (it != queueIndexToSliceTypeMap.end())
     {
-        return it->second;
+        return Slice::sliceTypeToStrMap.at(it->second);
     }
-    return 1; // Default to eMBB
+    return "Queue " + std::to_string(queueIndex);
 }
 
 bool
@@ -96,55 +171,173 @@ CustomQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
         return false;
     }
 
-    std::string nodeName = Names::FindName(m_node);
-
+    // Packets that crossed telemetry-enabled switches already carry the tag
     MetadataTag metadataTag;
+    item->GetPacket()->RemovePacketTag(metadataTag);
     metadataTag.SetIngressTimestamp(Simulator::Now());
     item->GetPacket()->AddPacketTag(metadataTag);
 
-    uint32_t queueIndex = GetQueueIndexFromDscp(ipv4Item->GetHeader().GetDscp());
+    uint32_t queueIndex = GetQueueIndex(ipv4Item);
 
     m_maxPacketsinQueue[queueIndex] =
         std::max(m_maxPacketsinQueue[queueIndex], GetInternalQueue(queueIndex)->GetNPackets());
 
     NS_LOG_DEBUG("[QueueDisc] Enqueueing packet on "
-                 << nodeName << " port " << m_port << " | DSCP "
+                 << Names::FindName(m_node) << " port " << m_port << " | DSCP "
                  << static_cast<uint32_t>(ipv4Item->GetHeader().GetDscp()) << " | Queue "
-                 << Slice::sliceTypeToStrMap.at(queueIndexToSliceTypeMap.at(queueIndex))
+                 << GetQueueName(queueIndex)
                  << " | Queue size: " << GetInternalQueue(queueIndex)->GetNPackets()
                  << " | Max queue size: " << m_maxPacketsinQueue[queueIndex]);
 
-    return GetInternalQueue(queueIndex)->Enqueue(item);
+    Ptr<SliceAqm> aqm = m_aqms[queueIndex].aqm;
+    if (aqm)
+    {
+        uint32_t queueBytes = GetInternalQueue(queueIndex)->GetNBytes();
+        SliceAqm::Verdict verdict = aqm->Enqueue(item, queueBytes);
+        if (!ApplyAqmVerdict(item, queueIndex, verdict, false))
+        {
+            return false;
+        }
+    }
+
+    if (m_sharedBuffer && !m_sharedBuffer->Admit(m_bufferPort, queueIndex, item->GetSize()))
+    {
+        DropBeforeEnqueue(item, SHARED_BUFFER_DROP);
+        return false;
+    }
+
+    // The marking follows the queue met by the packet, but a packet dropped
+    // by the queue limit is not marked as well
+    bool markingDue = IsMarkingDue(queueIndex);
+    if (!GetInternalQueue(queueIndex)->Enqueue(item))
+    {
+        if (m_sharedBuffer)
+        {
+            m_sharedBuffer->Release(m_bufferPort, queueIndex, item->GetSize());
+        }
+        return false;
+    }
+    if (markingDue)
+    {
+        // Only ECT packets are marked; the others are left to the queue limit
+        Mark(item, ECN_MARK);
+    }
+    if (!m_isActive[queueIndex])
+    {
+        m_isActive[queueIndex] = true;
+        if (m_scheduler == WF2Q)
+        {
+            // A queue idle since its last finish tag starts at the current virtual time
+            m_startTags[queueIndex] = std::max(m_finishTags[queueIndex], m_virtualTime);
+            m_finishTags[queueIndex] =
+                m_startTags[queueIndex] + GetVirtualCost(queueIndex, item->GetSize());
+            m_pendingQueues.emplace(m_startTags[queueIndex], queueIndex);
+        }
+        else
+        {
+            m_activeQueues.push_back(queueIndex);
+        }
+    }
+    return true;
+}
+
+bool
+CustomQueueDisc::IsMarkingDue(uint32_t queueIndex)
+{
+    const EcnThresholds& thresholds = m_ecnThresholds[queueIndex];
+    if (!thresholds.minBytes)
+    {
+        return false;
+    }
+    uint32_t bytes = GetInternalQueue(queueIndex)->GetNBytes();
+    if (bytes >= thresholds.maxBytes)
+    {
+        return true;
+    }
+    if (bytes < thresholds.minBytes)
+    {
+        return false;
+    }
+    double p = thresholds.maxP * (bytes - thresholds.minBytes) /
+               (thresholds.maxBytes - thresholds.minBytes);
+    return m_markRng->GetValue() < p;
+}
+
+bool
+CustomQueueDisc::ApplyAqmVerdict(Ptr<QueueDiscItem> item,
+                                 uint32_t queueIndex,
+                                 SliceAqm::Verdict verdict,
+                                 bool dequeued)
+{
+    QueueAqm& queueAqm = m_aqms[queueIndex];
+    if (verdict == SliceAqm::PASS)
+    {
+        return true;
+    }
+    if (verdict == SliceAqm::CONGESTED && queueAqm.aqm->IsEcnEnabled() && Mark(item, AQM_MARK))
+    {
+        queueAqm.marks++;
+        return true;
+    }
+    queueAqm.drops++;
+    if (dequeued)
+    {
+        DropAfterDequeue(item, AQM_DROP);
+    }
+    else
+    {
+        DropBeforeEnqueue(item, AQM_DROP);
+    }
+    return false;
 }
 
 Ptr<QueueDiscItem>
 CustomQueueDisc::DoDequeue()
 {
-    static uint32_t currentQueueIndex = 0;
-    // Packets served from each queue
-    static std::vector<uint32_t> packetsServed(m_queueWeights.size(), 0);
-
-    uint32_t numQueues = m_queueWeights.size();
+    return m_scheduler == WF2Q ? DequeueWf2q() : DequeueDrr();
+}
 
-    for (uint32_t i = 0; i < numQueues; i++)
+Ptr<QueueDiscItem>
+CustomQueueDisc::DequeueDrr()
+{
+    // Deficit round robin over the non-empty queues only: the queue at the
+    // head of the list sends while its deficit covers its next packet, then
+    // moves to the back of the list with one more quantum
+    while (!m_activeQueues.empty())
     {
-        uint32_t queueIndex = (currentQueueIndex + i) % numQueues;
-        if (!GetInternalQueue(queueIndex)->IsEmpty())
+        uint32_t queueIndex = m_activeQueues.front();
+        Ptr<const QueueDiscItem> head = GetInternalQueue(queueIndex)->Peek();
+        if (!head)
         {
-            Ptr<QueueDiscItem> item = GetInternalQueue(queueIndex)->Dequeue();
-            MetadataTag metadataTag;
-            item->GetPacket()->RemovePacketTag(metadataTag);
-            Time ingressTimestamp = metadataTag.GetIngressTimestamp();
-            Time queueDelay = Simulator::Now() - ingressTimestamp;
-            m_queueDelays[queueIndex].push_back(queueDelay);
-
-            packetsServed[queueIndex]++;
-            if (packetsServed[queueIndex] >= m_queueWeights[queueIndex])
-            {
-                packetsServed[queueIndex] = 0;
-                currentQueueIndex = (queueIndex + 1) % numQueues; // Move to the next queue
-            }
+            m_activeQueues.pop_front();
+            m_isActive[queueIndex] = false;
+            m_deficits[queueIndex] = 0;
+            continue;
+        }
+        if (m_deficits[queueIndex] < head->GetSize())
+        {
+            m_deficits[queueIndex] += m_quantums[queueIndex];
+            m_activeQueues.pop_front();
+            m_activeQueues.push_back(queueIndex);
+            continue;
+        }
 
+        // The packets dropped by the AQM cost their queue no deficit; the one
+        // sent after them may exceed it, which only empties the deficit
+        Ptr<QueueDiscItem> item = DequeueFromQueue(queueIndex);
+        if (item)
+        {
+            m_deficits[queueIndex] -= std::min<uint64_t>(m_deficits[queueIndex], item->GetSize());
+        }
+        if (GetInternalQueue(queueIndex)->IsEmpty())
+        {
+            // An idle queue does not keep credit for later
+            m_activeQueues.pop_front();
+            m_isActive[queueIndex] = false;
+            m_deficits[queueIndex] = 0;
+        }
+        if (item)
+        {
             return item;
         }
     }
@@ -152,36 +345,230 @@ CustomQueueDisc::DoDequeue()
     return nullptr; // No packets in any queue
 }
 
-Ptr<const QueueDiscItem>
-CustomQueueDisc::DoPeek()
+Ptr<QueueDiscItem>
+CustomQueueDisc::DequeueWf2q()
 {
-    for (uint32_t i = 0; i < m_queueWeights.size(); i++)
+    // WF2Q+: among the queues whose head packet has started in virtual
+    // time, the one whose head packet finishes first is served
+    while (!m_eligibleQueues.empty() || !m_pendingQueues.empty())
     {
-        if (!GetInternalQueue(i)->IsEmpty())
+        if (m_eligibleQueues.empty())
+        {
+            // The virtual time jumps to the earliest start when no queue is eligible
+            m_virtualTime = std::max(m_virtualTime, m_pendingQueues.top().first);
+        }
+        while (!m_pendingQueues.empty() && m_pendingQueues.top().first <= m_virtualTime)
+        {
+            uint32_t queueIndex = m_pendingQueues.top().second;
+            m_pendingQueues.pop();
+            m_eligibleQueues.emplace(m_finishTags[queueIndex], queueIndex);
+        }
+        uint32_t queueIndex = m_eligibleQueues.top().second;
+        m_eligibleQueues.pop();
+
+        Ptr<QueueDiscItem> item = DequeueFromQueue(queueIndex);
+        if (item)
+        {
+            // The packet sent may follow packets dropped by the AQM, so its
+            // own size gives the start of the next one
+            m_virtualTime += uint64_t(item->GetSize()) * VIRTUAL_TIME_SCALE;
+            m_startTags[queueIndex] += GetVirtualCost(queueIndex, item->GetSize());
+        }
+        // The next packet is tagged after the one sent, or in place of the ones dropped
+        Ptr<const QueueDiscItem> head = GetInternalQueue(queueIndex)->Peek();
+        if (head)
         {
-            return GetInternalQueue(i)->Peek();
+            m_finishTags[queueIndex] =
+                m_startTags[queueIndex] + GetVirtualCost(queueIndex, head->GetSize());
+            m_pendingQueues.emplace(m_startTags[queueIndex], queueIndex);
+        }
+        else
+        {
+            m_isActive[queueIndex] = false;
+        }
+        if (item)
+        {
+            return item;
         }
     }
+
     return nullptr; // No packets in any queue
 }
 
+uint64_t
+CustomQueueDisc::GetVirtualCost(uint32_t queueIndex, uint32_t bytes) const
+{
+    // The virtual time of a queue runs at the link rate over its share of the weights
+    return std::llround(double(bytes) * VIRTUAL_TIME_SCALE * m_weightSum /
+                        m_queueWeights[queueIndex]);
+}
+
+Ptr<QueueDiscItem>
+CustomQueueDisc::DequeueFromQueue(uint32_t queueIndex)
+{
+    // As in the dequeue loop of RFC 8289, the packets the AQM drops are
+    // followed by the next one of the same queue, at the same time, until
+    // one goes on: CoDel drops every packet whose drop time is past
+    Ptr<SliceAqm> aqm = m_aqms[queueIndex].aqm;
+    while (Ptr<QueueDiscItem> item = GetInternalQueue(queueIndex)->Dequeue())
+    {
+        if (m_sharedBuffer)
+        {
+            m_sharedBuffer->Release(m_bufferPort, queueIndex, item->GetSize());
+        }
+        MetadataTag metadataTag;
+        item->GetPacket()->RemovePacketTag(metadataTag);
+        Time ingressTimestamp = metadataTag.GetIngressTimestamp();
+        Time queueDelay = Simulator::Now() - ingressTimestamp;
+
+        if (aqm)
+        {
+            uint32_t queueBytes = GetInternalQueue(queueIndex)->GetNBytes();
+            SliceAqm::Verdict verdict = aqm->Dequeue(item, queueDelay, queueBytes);
+            if (!ApplyAqmVerdict(item, queueIndex, verdict, true))
+            {
+                continue;
+            }
+        }
+
+        m_queueDelays[queueIndex].Record(queueDelay);
+        // Left on the packet so that the next telemetry hop can measure its latency
+        metadataTag.SetEgressTimestamp(Simulator::Now());
+        item->GetPacket()->AddPacketTag(metadataTag);
+        if (m_postcardExporter)
+        {
+            ReportPostcard(item, queueIndex, ingressTimestamp);
+        }
+        return item;
+    }
+    return nullptr;
+}
+
+void
+CustomQueueDisc::ReportPostcard(Ptr<QueueDiscItem> item, uint32_t queueIndex, Time ingressTime)
+{
+    uint32_t queueDepth = GetInternalQueue(queueIndex)->GetNPackets();
+    uint8_t selected = m_postcardExporter->Select(item->GetPacket()->GetUid(), queueDepth);
+    auto ipv4Item = DynamicCast<Ipv4QueueDiscItem>(item);
+    if (!selected || !ipv4Item)
+    {
+        return;
+    }
+
+    FlowKey flow;
+    flow.Extract(ipv4Item->GetHeader(), item->GetPacket());
+    PostcardRecord record;
+    record.flowHash = flow.Hash(FlowKey::FIVE_TUPLE, 0);
+    record.ingressTime = ingressTime.GetNanoSeconds();
+    record.egressTime = Simulator::Now().GetNanoSeconds();
+    record.queueDepth = queueDepth;
+    record.hop = m_node ? m_node->GetId() : 0;
+    record.dscp = flow.dscp;
+    record.flagged = selected == 2;
+    m_postcardExporter->Report(record);
+}
+
 bool
 CustomQueueDisc::CheckConfig()
 {
-    AddInternalQueue(CreateObject<DropTailQueue<QueueDiscItem>>()); // URLLC
-    AddInternalQueue(CreateObject<DropTailQueue<QueueDiscItem>>()); // eMBB
-    AddInternalQueue(CreateObject<DropTailQueue<QueueDiscItem>>()); // mMTC
+    if (m_queueWeights.size() > m_numQueues)
+    {
+        NS_LOG_ERROR("Queue " << m_queueWeights.size() - 1 << " is configured but NumQueues is "
+                              << m_numQueues);
+        return false;
+    }
+    ResizeQueues(m_numQueues);
+    UpdateQuantums();
 
-    GetInternalQueue(0)->SetMaxSize(QueueSize("20KB"));  // URLLC
-    GetInternalQueue(1)->SetMaxSize(QueueSize("500KB")); // eMBB
-    GetInternalQueue(2)->SetMaxSize(QueueSize("200KB")); // mMTC
+    // URLLC, eMBB and mMTC, then the queues of DSCPs or slices mapped by hand
+    for (uint32_t i = 0; i < m_numQueues; i++)
+    {
+        AddInternalQueue(CreateObject<DropTailQueue<QueueDiscItem>>());
+    }
+    if (m_sharedBuffer)
+    {
+        m_bufferPort = m_sharedBuffer->AddPort(m_numQueues);
+    }
+    SetInternalQueueLimits();
 
     return true;
 }
 
+void
+CustomQueueDisc::ResizeQueues(uint32_t numQueues)
+{
+    if (numQueues <= m_queueWeights.size())
+    {
+        return;
+    }
+    m_queueDelays.resize(numQueues);
+    m_maxPacketsinQueue.resize(numQueues, 0);
+    m_queueWeights.resize(numQueues, 1);
+    m_queueSizes.resize(numQueues, QueueSize());
+    m_queueSliceTypes.resize(numQueues, -1);
+    m_ecnThresholds.resize(numQueues, EcnThresholds{0, 0, 1.0});
+    m_isActive.resize(numQueues, false);
+    m_deficits.resize(numQueues, 0);
+    m_startTags.resize(numQueues, 0);
+    m_finishTags.resize(numQueues, 0);
+    m_aqms.resize(numQueues, QueueAqm{ObjectFactory(), nullptr, 0, 0});
+}
+
+void
+CustomQueueDisc::SetInternalQueueLimits()
+{
+    if (m_sharedBuffer)
+    {
+        // The shared buffer admits the packets; a queue can grow up to the whole buffer
+        QueueSize size(QueueSizeUnit::BYTES, m_sharedBuffer->GetBufferSize());
+        for (uint32_t i = 0; i < GetNInternalQueues(); i++)
+        {
+            GetInternalQueue(i)->SetMaxSize(size);
+        }
+        return;
+    }
+
+    for (uint32_t i = 0; i < GetNInternalQueues(); i++)
+    {
+        GetInternalQueue(i)->SetMaxSize(GetQueueSize(i));
+    }
+}
+
 void
 CustomQueueDisc::InitializeParams()
 {
+    UpdateQuantums();
+}
+
+void
+CustomQueueDisc::UpdateQuantums()
+{
+    // The lightest queue gets QuantumBytes per round, the others in proportion
+    double minWeight = *std::min_element(m_queueWeights.begin(), m_queueWeights.end());
+    m_quantums.resize(m_queueWeights.size());
+    for (uint32_t i = 0; i < m_queueWeights.size(); i++)
+    {
+        double quantum = double(m_quantumBytes) * m_queueWeights[i] / minWeight;
+        m_quantums[i] = std::max<uint64_t>(std::llround(quantum), 1);
+    }
+    m_weightSum = std::accumulate(m_queueWeights.begin(), m_queueWeights.end(), 0.0);
+}
+
+Time
+CustomQueueDisc::GetLatencyBound(uint32_t queueIndex,
+                                 DataRate linkRate,
+                                 uint32_t maxPacketBytes) const
+{
+    double bytesPerSecond = linkRate.GetBitRate() / 8.0;
+    if (m_scheduler == WF2Q)
+    {
+        // A full packet at the rate of the queue, after one of another queue already started
+        double share = bytesPerSecond * m_queueWeights.at(queueIndex) / m_weightSum;
+        return Seconds(maxPacketBytes / share + maxPacketBytes / bytesPerSecond);
+    }
+    // The queue may wait for almost a round of every other quantum, twice
+    uint64_t frame = std::accumulate(m_quantums.begin(), m_quantums.end(), uint64_t(0));
+    return Seconds((3.0 * frame - 2.0 * m_quantums.at(queueIndex)) / bytesPerSecond);
 }
 
 void
@@ -189,29 +576,37 @@ CustomQueueDisc::PrintQueueStatistics()
 {
     for (size_t i = 0; i < m_queueDelays.size(); ++i)
     {
-        if (!m_queueDelays[i].empty())
+        const DelayHistogram& delays = m_queueDelays[i];
+        if (delays.GetCount())
         {
-            std::sort(m_queueDelays[i].begin(), m_queueDelays[i].end());
-            uint32_t maxQueueSize = m_maxPacketsinQueue[i];
-            double maxQueueDelay = m_queueDelays[i].back().GetMilliSeconds();
-
-            double averageQueueDelay = 0;
-            for (const auto& delay : m_queueDelays[i])
-            {
-                averageQueueDelay += delay.GetMilliSeconds();
-            }
-            averageQueueDelay /= m_queueDelays[i].size();
-
             NS_LOG_INFO("[QueueDisc] Node: "
-                        << Names::FindName(m_node) << " | Port: " << m_port << " | Queue: "
-                        << Slice::sliceTypeToStrMap.at(queueIndexToSliceTypeMap.at(i))
-                        << " | Max size: " << maxQueueSize << " | Max delay: " << maxQueueDelay
-                        << " ms"
-                        << " | Average delay: " << averageQueueDelay << " ms");
+                        << Names::FindName(m_node) << " | Port: " << m_port
+                        << " | Queue: " << GetQueueName(i)
+                        << " | Max size: " << m_maxPacketsinQueue[i]
+                        << " | Packets: " << delays.GetCount()
+                        << " | Average delay: " << delays.GetMean().GetSeconds() * 1000 << " ms"
+                        << " | p50/p99/p99.9: " << delays.GetPercentile(50).GetSeconds() * 1000
+                        << "/" << delays.GetPercentile(99).GetSeconds() * 1000 << "/"
+                        << delays.GetPercentile(99.9).GetSeconds() * 1000 << " ms"
+                        << " | Max delay: " << delays.GetMax().GetSeconds() * 1000 << " ms");
+        }
+        if (m_aqms[i].aqm)
+        {
+            NS_LOG_INFO("[QueueDisc] Node: "
+                        << Names::FindName(m_node) << " | Port: " << m_port
+                        << " | Queue: " << GetQueueName(i) << " | "
+                        << m_aqms[i].aqm->GetInstanceTypeId().GetName()
+                        << " drops: " << m_aqms[i].drops << " | marks: " << m_aqms[i].marks);
         }
     }
 }
 
+const DelayHistogram&
+CustomQueueDisc::GetDelayHistogram(uint32_t queueIndex) const
+{
+    return m_queueDelays.at(queueIndex);
+}
+
 void
 CustomQueueDisc::SetQueueWeights(std::map<Slice::SliceType, uint32_t> queueWeights)
 {
@@ -222,9 +617,208 @@ CustomQueueDisc::SetQueueWeights(std::map<Slice::SliceType, uint32_t> queueWeigh
         auto it2 = sliceTypeToQueueIndexMap.find(sliceType);
         if (it2 != sliceTypeToQueueIndexMap.end())
         {
+            NS_ASSERT_MSG(weight > 0, "Weights must be positive");
             m_queueWeights[it2->second] = weight;
         }
     }
+    UpdateQuantums();
+}
+
+void
+CustomQueueDisc::SetQueueWeight(uint32_t queueIndex, double weight)
+{
+    NS_ASSERT_MSG(GetNInternalQueues() == 0 || queueIndex < m_numQueues,
+                  "Unknown queue " << queueIndex);
+    NS_ASSERT_MSG(weight > 0, "Weights must be positive");
+    ResizeQueues(queueIndex + 1);
+    m_queueWeights[queueIndex] = weight;
+    UpdateQuantums();
+}
+
+double
+CustomQueueDisc::GetQueueWeight(uint32_t queueIndex) const
+{
+    return queueIndex < m_queueWeights.size() ? m_queueWeights[queueIndex] : 1;
+}
+
+void
+CustomQueueDisc::SetQueueSize(uint32_t queueIndex, QueueSize size)
+{
+    NS_ASSERT_MSG(GetNInternalQueues() == 0, "Queue sizes are set before initialization");
+    ResizeQueues(queueIndex + 1);
+    m_queueSizes[queueIndex] = size;
+}
+
+QueueSize
+CustomQueueDisc::GetQueueSize(uint32_t queueIndex) const
+{
+    if (queueIndex < m_queueSizes.size() && m_queueSizes[queueIndex].GetValue())
+    {
+        return m_queueSizes[queueIndex];
+    }
+    return m_defaultQueueSize;
+}
+
+void
+CustomQueueDisc::MapDscp(uint8_t dscp, uint32_t queueIndex)
+{
+    NS_ASSERT_MSG(GetNInternalQueues() == 0 || queueIndex < m_numQueues,
+                  "Unknown queue " << queueIndex);
+    ResizeQueues(queueIndex + 1);
+    m_dscpQueueMap.Map(dscp, queueIndex);
+    auto it = Slice::dscpToSliceTypeMap.find(dscp & 0x3f);
+    if (it != Slice::dscpToSliceTypeMap.end())
+    {
+        m_queueSliceTypes[queueIndex] = it->second;
+    }
+}
+
+const DscpQueueMap&
+CustomQueueDisc::GetDscpQueueMap() const
+{
+    return m_dscpQueueMap;
+}
+
+void
+CustomQueueDisc::MapSliceId(uint32_t sliceId, uint32_t queueIndex, Slice::SliceType sliceType)
+{
+    NS_ASSERT_MSG(GetNInternalQueues() == 0 || queueIndex < m_numQueues,
+                  "Unknown queue " << queueIndex);
+    ResizeQueues(queueIndex + 1);
+    if (sliceId >= m_queueIndexBySliceId.size())
+    {
+        m_queueIndexBySliceId.resize(sliceId + 1, NO_QUEUE);
+    }
+    m_queueIndexBySliceId[sliceId] = queueIndex;
+    m_queueSliceTypes[queueIndex] = sliceType;
+}
+
+bool
+CustomQueueDisc::GetQueueSliceType(uint32_t queueIndex, Slice::SliceType& sliceType) const
+{
+    if (queueIndex >= m_queueSliceTypes.size() || m_queueSliceTypes[queueIndex] < 0)
+    {
+        return false;
+    }
+    sliceType = static_cast<Slice::SliceType>(m_queueSliceTypes[queueIndex]);
+    return true;
+}
+
+void
+CustomQueueDisc::SetEcnThresholds(std::map<Slice::SliceType, EcnThresholds> thresholds)
+{
+    for (const auto& [sliceType, sliceThresholds] : thresholds)
+    {
+        auto it = sliceTypeToQueueIndexMap.find(sliceType);
+        if (it == sliceTypeToQueueIndexMap.end())
+        {
+            continue;
+        }
+        SetQueueEcnThresholds(it->second, sliceThresholds);
+    }
+}
+
+void
+CustomQueueDisc::SetQueueEcnThresholds(uint32_t queueIndex, EcnThresholds thresholds)
+{
+    NS_ASSERT_MSG(thresholds.minBytes <= thresholds.maxBytes,
+                  "The minimum marking threshold exceeds the maximum");
+    ResizeQueues(queueIndex + 1);
+    m_ecnThresholds[queueIndex] = thresholds;
+}
+
+CustomQueueDisc::EcnThresholds
+CustomQueueDisc::GetQueueEcnThresholds(uint32_t queueIndex) const
+{
+    return queueIndex < m_ecnThresholds.size() ? m_ecnThresholds[queueIndex]
+                                               : EcnThresholds{0, 0, 1.0};
+}
+
+int64_t
+CustomQueueDisc::AssignStreams(int64_t stream)
+{
+    m_markRng->SetStream(stream);
+    int64_t streams = 1;
+    for (const auto& queueAqm : m_aqms)
+    {
+        if (queueAqm.aqm)
+        {
+            streams += queueAqm.aqm->AssignStreams(stream + streams);
+        }
+    }
+    return streams;
+}
+
+void
+CustomQueueDisc::SetAqm(std::map<Slice::SliceType, ObjectFactory> aqms)
+{
+    for (const auto& [sliceType, factory] : aqms)
+    {
+        SetQueueAqm(sliceTypeToQueueIndexMap.at(sliceType), factory);
+    }
+}
+
+void
+CustomQueueDisc::SetQueueAqm(uint32_t queueIndex, ObjectFactory factory)
+{
+    NS_ASSERT_MSG(GetNInternalQueues() == 0, "AQMs are set before initialization");
+    ResizeQueues(queueIndex + 1);
+    m_aqms[queueIndex] = QueueAqm{factory, factory.Create<SliceAqm>(), 0, 0};
+}
+
+Ptr<SliceAqm>
+CustomQueueDisc::GetQueueAqm(uint32_t queueIndex) const
+{
+    return queueIndex < m_aqms.size() ? m_aqms[queueIndex].aqm : nullptr;
+}
+
+ObjectFactory
+CustomQueueDisc::GetQueueAqmFactory(uint32_t queueIndex) const
+{
+    return queueIndex < m_aqms.size() ? m_aqms[queueIndex].factory : ObjectFactory();
+}
+
+uint64_t
+CustomQueueDisc::GetAqmDrops(uint32_t queueIndex) const
+{
+    return queueIndex < m_aqms.size() ? m_aqms[queueIndex].drops : 0;
+}
+
+uint64_t
+CustomQueueDisc::GetAqmMarks(uint32_t queueIndex) const
+{
+    return queueIndex < m_aqms.size() ? m_aqms[queueIndex].marks : 0;
+}
+
+void
+CustomQueueDisc::SetSharedBuffer(Ptr<SharedBufferPool> pool)
+{
+    if (pool == m_sharedBuffer)
+    {
+        return;
+    }
+    NS_ASSERT_MSG(GetNPackets() == 0,
+                  "The shared buffer cannot change while packets are queued");
+    // The port is only registered once CheckConfig knows the number of queues
+    if (m_sharedBuffer && GetNInternalQueues() > 0)
+    {
+        m_sharedBuffer->RemovePort(m_bufferPort);
+    }
+    m_sharedBuffer = pool;
+    if (GetNInternalQueues() > 0)
+    {
+        if (m_sharedBuffer)
+        {
+            m_bufferPort = m_sharedBuffer->AddPort(GetNInternalQueues());
+        }
+        SetInternalQueueLimits();
+    }
+}
+
+Ptr<SharedBufferPool>
+CustomQueueDisc::GetSharedBuffer() const
+{
+    return m_sharedBuffer;
 }
 
 } // namespace ns3
\ No newline at end of file
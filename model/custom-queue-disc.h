@@ -1,17 +1,31 @@
 #ifndef CUSTOM_QUEUE_DISC_H
 #define CUSTOM_QUEUE_DISC_H
 
+#include "ns3/data-rate.h"
+#include "ns3/delay-histogram.h"
+#include "ns3/dscp-queue-map.h"
+#include "ns3/ipv4-queue-disc-item.h"
 #include "ns3/net-device.h"
+#include "ns3/object-factory.h"
 #include "ns3/queue-disc.h"
+#include "ns3/random-variable-stream.h"
 #include <ns3/drop-tail-queue.h>
 #include <ns3/node.h>
+#include <ns3/slice-aqm.h>
 #include <ns3/slice.h>
 
+#include <array>
+#include <deque>
+#include <functional>
+#include <queue>
 #include <vector>
 
 namespace ns3
 {
 
+class PostcardExporter;
+class SharedBufferPool;
+
 class CustomQueueDisc : public QueueDisc
 {
   public:
@@ -28,27 +42,345 @@ class CustomQueueDisc : public QueueDisc
      * \brief Print queue statistics (e.g., delays).
      */
     void PrintQueueStatistics();
+
+    /**
+     * \brief Get the queueing delays of an internal queue
+     *
+     * Histograms of several queues, ports or runs can be merged, e.g. to
+     * report the delay percentiles of a slice type over the whole network.
+     *
+     * \param queueIndex the internal queue
+     * \returns the histogram of the delays of the packets dequeued so far
+     */
+    const DelayHistogram& GetDelayHistogram(uint32_t queueIndex) const;
     Ptr<NetDevice> GetNetDevice() const;
     static const std::unordered_map<Slice::SliceType, uint32_t> sliceTypeToQueueIndexMap;
     static const std::unordered_map<uint32_t, Slice::SliceType> queueIndexToSliceTypeMap;
+
+    /// How the internal queues share the port
+    enum Scheduler
+    {
+        /// Deficit round robin: O(1) per packet, but a queue may send its
+        /// whole quantum back to back while the others wait
+        DRR,
+        /// WF2Q+: the eligible queue whose head packet finishes first in
+        /// virtual time sends, so every queue is served within about one
+        /// packet of its share; O(log n) per packet in the active queues
+        WF2Q
+    };
+
+    /**
+     * \brief Worst-case latency of a queue under the current scheduler
+     *
+     * Once backlogged, the queue is served at least at its share of the
+     * link rate, its weight over the sum of the weights, after at most this
+     * latency. A slice whose traffic is shaped by a token bucket of depth b
+     * and a rate below its share thus waits at most b over its share plus
+     * this latency. The DRR bound assumes the quanta are at least
+     * maxPacketBytes.
+     *
+     * \param queueIndex the internal queue
+     * \param linkRate the rate of the port
+     * \param maxPacketBytes the largest packet
+     * \returns the latency
+     */
+    Time GetLatencyBound(uint32_t queueIndex,
+                         DataRate linkRate,
+                         uint32_t maxPacketBytes = 1500) const;
+
+    /**
+     * \brief Sets the deficit round robin weights of the slice queues
+     *
+     * Weights are relative: each round, the queue with the smallest weight
+     * may send QuantumBytes, and every other queue QuantumBytes times its
+     * weight over the smallest weight. Bandwidth is thus shared in
+     * proportion to the weights, whatever the packet sizes.
+     *
+     * \param queueWeights the weight of each slice
+     */
     void SetQueueWeights(std::map<Slice::SliceType, uint32_t> queueWeights);
 
+    /**
+     * \brief Sets the deficit round robin weight of one internal queue
+     *
+     * Weights need not be integers, e.g. the weight of a slice type split
+     * among its slices; quantums are rounded to whole bytes.
+     *
+     * \param queueIndex the internal queue, below NumQueues
+     * \param weight the weight, positive, relative to the other queues
+     */
+    void SetQueueWeight(uint32_t queueIndex, double weight);
+    double GetQueueWeight(uint32_t queueIndex) const;
+
+    /**
+     * \brief Sets the size of one internal queue, before the queue disc is initialized
+     *
+     * Queues whose size is not set get DefaultQueueSize, except the URLLC,
+     * eMBB and mMTC queues (20KB, 500KB and 200KB). With a shared buffer,
+     * the pool bounds the queues instead.
+     *
+     * \param queueIndex the internal queue
+     * \param size the queue size
+     */
+    void SetQueueSize(uint32_t queueIndex, QueueSize size);
+    QueueSize GetQueueSize(uint32_t queueIndex) const;
+
+    /**
+     * \brief Sends the packets of a DSCP to an internal queue
+     *
+     * By default every DSCP goes to the queue of its slice type. The queue
+     * is reported under the slice type of the DSCP, if it has one.
+     *
+     * \param dscp the DSCP
+     * \param queueIndex the internal queue, below NumQueues
+     */
+    void MapDscp(uint8_t dscp, uint32_t queueIndex);
+
+    /**
+     * \brief Get the internal queue of each DSCP, with the MapDscp overrides
+     *
+     * A slicescope switch given this map queues the packets like this queue disc.
+     *
+     * \returns the map
+     */
+    const DscpQueueMap& GetDscpQueueMap() const;
+
+    /**
+     * \brief Sends the packets of a slice instance to an internal queue
+     *
+     * Packets are recognized by the SliceIdTag of their traffic generator,
+     * and a mapped slice id takes precedence over the DSCP of the packet.
+     *
+     * \param sliceId the slice id
+     * \param queueIndex the internal queue, below NumQueues
+     * \param sliceType the type of the slice, under which the queue is reported
+     */
+    void MapSliceId(uint32_t sliceId, uint32_t queueIndex, Slice::SliceType sliceType);
+
+    /**
+     * \brief Get the slice type of the packets of an internal queue
+     * \param queueIndex the internal queue
+     * \param sliceType the slice type, set if the queue has one
+     * \returns false if no slice, DSCP or slice type was mapped to the queue
+     */
+    bool GetQueueSliceType(uint32_t queueIndex, Slice::SliceType& sliceType) const;
+
+    /**
+     * \brief Charges the internal queues to a buffer shared with other queue discs
+     *
+     * The pool then decides which packets are admitted, and the internal
+     * queues are only bounded by its size. The queue disc leaves the pool it
+     * was charged to before, if any; setting the same pool again does nothing.
+     *
+     * \param pool the shared buffer, or nullptr for independent queue limits
+     */
+    void SetSharedBuffer(Ptr<SharedBufferPool> pool);
+    Ptr<SharedBufferPool> GetSharedBuffer() const;
+
+    static constexpr const char* SHARED_BUFFER_DROP = "Shared buffer threshold exceeded";
+
+    /**
+     * \brief ECN marking thresholds of an internal queue, in bytes
+     *
+     * An ECT packet arriving when the queue holds maxBytes or more is marked
+     * CE; between minBytes and maxBytes it is marked with a probability
+     * growing linearly up to maxP, as in RED but on the instantaneous queue
+     * size. minBytes equal to maxBytes gives the step marking of DCTCP.
+     * Packets that are not ECT are never marked, and only dropped when the
+     * queue is full.
+     */
+    struct EcnThresholds
+    {
+        uint32_t minBytes; //!< queue size from which packets may be marked, 0 to disable marking
+        uint32_t maxBytes; //!< queue size from which packets are always marked
+        double maxP;       //!< marking probability just below maxBytes
+    };
+
+    void SetEcnThresholds(std::map<Slice::SliceType, EcnThresholds> thresholds);
+    void SetQueueEcnThresholds(uint32_t queueIndex, EcnThresholds thresholds);
+    EcnThresholds GetQueueEcnThresholds(uint32_t queueIndex) const;
+
+    /**
+     * Assign a fixed random variable stream number to the random variables
+     * used by this model.
+     *
+     * \param stream first stream index to use
+     * \return the number of stream indices assigned by this model
+     */
+    int64_t AssignStreams(int64_t stream);
+
+    static constexpr const char* ECN_MARK = "ECN threshold exceeded";
+
+    /**
+     * \brief Sets the active queue management of the slice queues
+     *
+     * Each slice queue gets an AQM of its own from the factory of its slice,
+     * e.g. a CoDelAqm with a tight Target for URLLC; the queues of the
+     * slices left out stay drop-tail.
+     *
+     * \param aqms the factory of the AQM of each slice, e.g. with its Target
+     */
+    void SetAqm(std::map<Slice::SliceType, ObjectFactory> aqms);
+
+    /**
+     * \brief Sets the active queue management of one internal queue
+     *
+     * Called before the queue disc is initialized; AssignStreams covers the
+     * AQMs set before it is called.
+     *
+     * \param queueIndex the internal queue
+     * \param factory factory of a SliceAqm
+     */
+    void SetQueueAqm(uint32_t queueIndex, ObjectFactory factory);
+
+    /**
+     * \param queueIndex the internal queue
+     * \returns the AQM of the queue, or nullptr for a drop-tail queue
+     */
+    Ptr<SliceAqm> GetQueueAqm(uint32_t queueIndex) const;
+
+    /**
+     * \param queueIndex the internal queue
+     * \returns the factory given to SetQueueAqm, to copy the AQM of the queue
+     */
+    ObjectFactory GetQueueAqmFactory(uint32_t queueIndex) const;
+
+    /**
+     * \param queueIndex the internal queue
+     * \returns the packets of the queue dropped by its AQM
+     */
+    uint64_t GetAqmDrops(uint32_t queueIndex) const;
+
+    /**
+     * \param queueIndex the internal queue
+     * \returns the packets of the queue marked CE by its AQM
+     */
+    uint64_t GetAqmMarks(uint32_t queueIndex) const;
+
+    static constexpr const char* AQM_DROP = "AQM drop";
+    static constexpr const char* AQM_MARK = "AQM mark";
+
   private:
     bool DoEnqueue(Ptr<QueueDiscItem> item) override;
     Ptr<QueueDiscItem> DoDequeue() override;
-    Ptr<const QueueDiscItem> DoPeek() override;
     bool CheckConfig() override;
     void InitializeParams() override;
-    uint32_t GetQueueIndexFromDscp(uint8_t dscp) const;
+    void SetInternalQueueLimits();
+
+    /// \returns the next packet sent by deficit round robin, if any
+    Ptr<QueueDiscItem> DequeueDrr();
+
+    /// \returns the next packet sent by WF2Q+, if any
+    Ptr<QueueDiscItem> DequeueWf2q();
+
+    /**
+     * \brief Dequeues the first packet of an internal queue its AQM lets through
+     * \param queueIndex the internal queue, not empty
+     * \returns the packet, or nullptr if the AQM dropped all the packets
+     */
+    Ptr<QueueDiscItem> DequeueFromQueue(uint32_t queueIndex);
 
-    std::vector<std::vector<ns3::Time>> m_queueDelays;
+    /**
+     * \param queueIndex the internal queue
+     * \param bytes the size of a packet of the queue
+     * \returns the virtual time the packet takes at the share of the queue
+     */
+    uint64_t GetVirtualCost(uint32_t queueIndex, uint32_t bytes) const;
+
+    /**
+     * \brief Classifies a packet, by slice id if its slice has a queue, by DSCP otherwise
+     * \param item the packet
+     * \returns the internal queue of the packet
+     */
+    uint32_t GetQueueIndex(Ptr<const Ipv4QueueDiscItem> item) const;
+
+    /// \returns the slice type of the first three queues, "Queue <index>" for the others
+    std::string GetQueueName(uint32_t queueIndex) const;
+
+    /// Grows the per-queue state to at least numQueues queues
+    void ResizeQueues(uint32_t numQueues);
+
+    /// Derives the byte quantum of each queue and the WF2Q+ weight sum from the queue weights
+    void UpdateQuantums();
+
+    /**
+     * \brief Tells whether a packet arriving in a queue must be marked CE
+     * \param queueIndex the internal queue
+     * \returns true if the thresholds of the queue select the packet
+     */
+    bool IsMarkingDue(uint32_t queueIndex);
+
+    /**
+     * \brief Marks or drops a packet the AQM of its queue found congested
+     * \param item the packet
+     * \param queueIndex the internal queue of the packet
+     * \param verdict the verdict of the AQM
+     * \param dequeued true if the packet was dequeued, false if it is being enqueued
+     * \returns true if the packet goes on, marked or not
+     */
+    bool ApplyAqmVerdict(Ptr<QueueDiscItem> item,
+                         uint32_t queueIndex,
+                         SliceAqm::Verdict verdict,
+                         bool dequeued);
+
+    /**
+     * \brief Reports a dequeued packet to the postcard exporter if it selects it
+     * \param item the dequeued item
+     * \param queueIndex the internal queue the item left
+     * \param ingressTime the time the item was enqueued
+     */
+    void ReportPostcard(Ptr<QueueDiscItem> item, uint32_t queueIndex, Time ingressTime);
+
+    std::vector<DelayHistogram> m_queueDelays;
     std::vector<uint32_t> m_maxPacketsinQueue;
-    std::vector<uint32_t> m_queueWeights;
-    uint32_t m_lastServedQueueIndex;
+    uint32_t m_numQueues;
+    QueueSize m_defaultQueueSize;
+    std::vector<double> m_queueWeights;
+    std::vector<QueueSize> m_queueSizes;
+    std::vector<int32_t> m_queueSliceTypes; // Slice::SliceType, or -1 for none
+    uint32_t m_quantumBytes;
+    std::vector<uint64_t> m_quantums;
+    std::vector<uint64_t> m_deficits;
+    std::vector<bool> m_isActive;
+    std::deque<uint32_t> m_activeQueues;
+    Scheduler m_scheduler;
+
+    /// Virtual time units per byte sent, so that virtual costs keep a fraction of a byte
+    static constexpr uint64_t VIRTUAL_TIME_SCALE = 1 << 16;
+    /// A queue and its start or finish tag
+    using TaggedQueue = std::pair<uint64_t, uint32_t>;
+    /// Min-heap of queues by tag
+    using TagHeap =
+        std::priority_queue<TaggedQueue, std::vector<TaggedQueue>, std::greater<TaggedQueue>>;
+    uint64_t m_virtualTime;
+    double m_weightSum;
+    std::vector<uint64_t> m_startTags;
+    std::vector<uint64_t> m_finishTags;
+    TagHeap m_eligibleQueues; // backlogged queues that have started, by finish tag
+    TagHeap m_pendingQueues;  // backlogged queues that have not, by start tag
     Ptr<NetDevice> m_netDevice;
     Ptr<Node> m_node;
     uint32_t m_port;
     std::vector<Ptr<DropTailQueue<QueueDiscItem>>> m_internalQueues;
+    Ptr<PostcardExporter> m_postcardExporter;
+    Ptr<SharedBufferPool> m_sharedBuffer;
+    uint32_t m_bufferPort;
+    std::vector<EcnThresholds> m_ecnThresholds;
+
+    /// Active queue management of an internal queue
+    struct QueueAqm
+    {
+        ObjectFactory factory; //!< factory of the AQM
+        Ptr<SliceAqm> aqm;     //!< the AQM, nullptr for drop-tail
+        uint64_t drops;        //!< packets dropped by the AQM
+        uint64_t marks;        //!< packets marked by the AQM
+    };
+
+    std::vector<QueueAqm> m_aqms;
+    Ptr<UniformRandomVariable> m_markRng;
+    DscpQueueMap m_dscpQueueMap;
+    std::vector<uint32_t> m_queueIndexBySliceId;
+    static constexpr uint32_t NO_QUEUE = UINT32_MAX;
 };
 
 } // namespace ns3
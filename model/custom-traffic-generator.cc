@@ -1,5 +1,6 @@
 #include "custom-traffic-generator.h"
 
+#include "slice-id-tag.h"
 #include "time-tag.h"
 
 #include "ns3/double.h"
@@ -60,13 +61,19 @@ CustomTrafficGenerator::GetTypeId()
                           "The DSCP value to set in the IP header",
                           UintegerValue(0),
                           MakeUintegerAccessor(&CustomTrafficGenerator::m_dscp),
-                          MakeUintegerChecker<uint8_t>());
+                          MakeUintegerChecker<uint8_t>())
+            .AddAttribute("SliceId",
+                          "Id of the slice the traffic belongs to, carried in a tag; 0 for none",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&CustomTrafficGenerator::m_sliceId),
+                          MakeUintegerChecker<uint32_t>());
     return tid;
 }
 
 CustomTrafficGenerator::CustomTrafficGenerator()
     : m_socket(nullptr),
-      m_packetsSent(0) // Ensure correct initialization
+      m_packetsSent(0), // Ensure correct initialization
+      m_sliceId(0)
 {
     NS_LOG_INFO("CustomTrafficGenerator created");
 }
@@ -159,6 +166,13 @@ CustomTrafficGenerator::SendPacket()
     timestamp.SetTime(Simulator::Now());
     packet->AddPacketTag(timestamp);
 
+    if (m_sliceId)
+    {
+        SliceIdTag sliceIdTag;
+        sliceIdTag.SetSliceId(m_sliceId);
+        packet->AddPacketTag(sliceIdTag);
+    }
+
     // Set ToS (Traffic Class field)
     int tos = m_dscp << 2;
     m_socket->SetIpTos(tos);
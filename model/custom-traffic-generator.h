@@ -38,6 +38,7 @@ class CustomTrafficGenerator : public Application
     double m_bytesSent;
     double m_dataRate;
     uint8_t m_dscp;
+    uint32_t m_sliceId;
     bool m_running;
     Ptr<RandomVariableStream> m_packetSizeVar;
     Ptr<RandomVariableStream> m_jitterVar;
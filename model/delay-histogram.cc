@@ -0,0 +1,178 @@
+#include "delay-histogram.h"
+
+#include "ns3/assert.h"
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::DelayHistogram implementation.
+ */
+
+namespace ns3
+{
+
+DelayHistogram::DelayHistogram(uint8_t significantBits)
+    : m_significantBits(significantBits),
+      m_count(0),
+      m_sum(0),
+      m_min(0),
+      m_max(0)
+{
+    NS_ASSERT_MSG(significantBits >= 1 && significantBits <= 16,
+                  "Significant bits must be between 1 and 16");
+}
+
+uint32_t
+DelayHistogram::GetIndex(uint64_t value) const
+{
+    uint64_t exact = uint64_t(1) << m_significantBits;
+    if (value < exact)
+    {
+        return value;
+    }
+    // Power of two of the value, counted from the first one split in buckets
+    uint32_t shift = 64 - __builtin_clzll(value) - m_significantBits;
+    uint64_t half = exact >> 1;
+    return exact + (shift - 1) * half + ((value >> shift) - half);
+}
+
+uint64_t
+DelayHistogram::GetLowest(uint32_t index) const
+{
+    uint64_t exact = uint64_t(1) << m_significantBits;
+    if (index < exact)
+    {
+        return index;
+    }
+    uint64_t half = exact >> 1;
+    uint32_t shift = (index - exact) / half + 1;
+    return ((index - exact) % half + half) << shift;
+}
+
+uint64_t
+DelayHistogram::GetWidth(uint32_t index) const
+{
+    uint64_t exact = uint64_t(1) << m_significantBits;
+    if (index < exact)
+    {
+        return 1;
+    }
+    return uint64_t(1) << ((index - exact) / (exact >> 1) + 1);
+}
+
+void
+DelayHistogram::Record(Time delay)
+{
+    uint64_t value = std::max<int64_t>(delay.GetNanoSeconds(), 0);
+    uint32_t index = GetIndex(value);
+    if (index >= m_counts.size())
+    {
+        m_counts.resize(index + 1, 0);
+    }
+    m_counts[index]++;
+    m_min = m_count ? std::min(m_min, value) : value;
+    m_max = std::max(m_max, value);
+    m_sum += value;
+    m_count++;
+}
+
+void
+DelayHistogram::Merge(const DelayHistogram& other)
+{
+    NS_ASSERT_MSG(other.m_significantBits == m_significantBits,
+                  "Only histograms of the same precision merge");
+    if (!other.m_count)
+    {
+        return;
+    }
+    if (other.m_counts.size() > m_counts.size())
+    {
+        m_counts.resize(other.m_counts.size(), 0);
+    }
+    for (uint32_t i = 0; i < other.m_counts.size(); i++)
+    {
+        m_counts[i] += other.m_counts[i];
+    }
+    m_min = m_count ? std::min(m_min, other.m_min) : other.m_min;
+    m_max = std::max(m_max, other.m_max);
+    m_sum += other.m_sum;
+    m_count += other.m_count;
+}
+
+void
+DelayHistogram::Clear()
+{
+    m_counts.clear();
+    m_count = 0;
+    m_sum = 0;
+    m_min = 0;
+    m_max = 0;
+}
+
+uint64_t
+DelayHistogram::GetCount() const
+{
+    return m_count;
+}
+
+Time
+DelayHistogram::GetMean() const
+{
+    return m_count ? NanoSeconds(m_sum / m_count) : Time(0);
+}
+
+Time
+DelayHistogram::GetMin() const
+{
+    return NanoSeconds(m_min);
+}
+
+Time
+DelayHistogram::GetMax() const
+{
+    return NanoSeconds(m_max);
+}
+
+Time
+DelayHistogram::GetPercentile(double percentile) const
+{
+    if (!m_count)
+    {
+        return Time(0);
+    }
+    // Rank of the delay in the sorted delays, from 1
+    double clamped = std::min(std::max(percentile, 0.0), 100.0);
+    uint64_t rank = std::max<uint64_t>(std::ceil(clamped / 100 * m_count), 1);
+    if (rank >= m_count)
+    {
+        return NanoSeconds(m_max);
+    }
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < m_counts.size(); i++)
+    {
+        seen += m_counts[i];
+        if (seen >= rank)
+        {
+            uint64_t value = GetLowest(i) + GetWidth(i) / 2;
+            return NanoSeconds(std::min(std::max(value, m_min), m_max));
+        }
+    }
+    return NanoSeconds(m_max);
+}
+
+double
+DelayHistogram::GetRelativeError() const
+{
+    return 1.0 / (uint64_t(1) << m_significantBits);
+}
+
+uint32_t
+DelayHistogram::GetMemoryBytes() const
+{
+    return m_counts.capacity() * sizeof(uint64_t);
+}
+
+} // namespace ns3
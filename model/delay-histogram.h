@@ -0,0 +1,114 @@
+#ifndef DELAY_HISTOGRAM_H
+#define DELAY_HISTOGRAM_H
+
+#include "ns3/nstime.h"
+
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::DelayHistogram declaration.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup bridge
+ * \brief Log-linear histogram of delays, in nanoseconds
+ *
+ * Delays below 2^SignificantBits ns have a bucket each. Above, every power
+ * of two is split into 2^(SignificantBits - 1) buckets of equal width, so
+ * a bucket is never wider than 2^(1 - SignificantBits) times the delays it
+ * holds. Percentiles are read from the bucket counts, as the middle of
+ * their bucket, so within 2^-SignificantBits of the exact delay and
+ * without sorting; count, mean, min and max are exact.
+ *
+ * Recording is a few shifts and one increment. The buckets are allocated
+ * up to the largest delay recorded, at most about 7400 counters with the
+ * default precision whatever the number of delays. Histograms of the same
+ * precision merge exactly, e.g. the queues of all the ports of a run, or
+ * the same queue over several runs.
+ */
+class DelayHistogram
+{
+  public:
+    static constexpr uint8_t DEFAULT_SIGNIFICANT_BITS = 8; //!< relative error below 0.4%
+
+    /**
+     * \param significantBits bits of the delays kept exact, 1 to 16
+     */
+    explicit DelayHistogram(uint8_t significantBits = DEFAULT_SIGNIFICANT_BITS);
+
+    /**
+     * \brief Count a delay; negative delays count as zero
+     * \param delay the delay
+     */
+    void Record(Time delay);
+
+    /**
+     * \brief Add the delays of another histogram of the same precision
+     * \param other the histogram
+     */
+    void Merge(const DelayHistogram& other);
+
+    /// Remove all the delays, keeping the precision
+    void Clear();
+
+    /// \returns the number of delays recorded
+    uint64_t GetCount() const;
+
+    /// \returns the mean delay, zero if none was recorded
+    Time GetMean() const;
+
+    /// \returns the smallest delay, zero if none was recorded
+    Time GetMin() const;
+
+    /// \returns the largest delay, zero if none was recorded
+    Time GetMax() const;
+
+    /**
+     * \param percentile the percentile, between 0 and 100
+     * \returns the delay below which this percentile of the delays lie,
+     *          within the relative error of the histogram
+     */
+    Time GetPercentile(double percentile) const;
+
+    /// \returns the largest relative error of the percentiles
+    double GetRelativeError() const;
+
+    /// \returns the memory used by the buckets, in bytes
+    uint32_t GetMemoryBytes() const;
+
+  private:
+    /**
+     * \param value a delay, in ns
+     * \returns the index of its bucket
+     */
+    uint32_t GetIndex(uint64_t value) const;
+
+    /**
+     * \param index a bucket index
+     * \returns the smallest delay of the bucket, in ns
+     */
+    uint64_t GetLowest(uint32_t index) const;
+
+    /**
+     * \param index a bucket index
+     * \returns the width of the bucket, in ns
+     */
+    uint64_t GetWidth(uint32_t index) const;
+
+    uint8_t m_significantBits;      //!< bits kept exact
+    std::vector<uint64_t> m_counts; //!< delays per bucket, up to the largest one
+    uint64_t m_count;               //!< delays recorded
+    uint64_t m_sum;                 //!< sum of the delays, in ns
+    uint64_t m_min;                 //!< smallest delay, in ns
+    uint64_t m_max;                 //!< largest delay, in ns
+};
+
+} // namespace ns3
+
+#endif /* DELAY_HISTOGRAM_H */
@@ -0,0 +1,42 @@
+#include "dscp-queue-map.h"
+
+#include "custom-queue-disc.h"
+#include "slice.h"
+
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::DscpQueueMap implementation.
+ */
+
+namespace ns3
+{
+
+DscpQueueMap::DscpQueueMap()
+{
+    m_queueIndexByDscp.fill(1); // Default to eMBB
+    for (const auto& [dscp, sliceType] : Slice::dscpToSliceTypeMap)
+    {
+        auto it = CustomQueueDisc::sliceTypeToQueueIndexMap.find(sliceType);
+        if (dscp != 0 && it != CustomQueueDisc::sliceTypeToQueueIndexMap.end())
+        {
+            m_queueIndexByDscp[dscp & 0x3f] = it->second;
+        }
+    }
+}
+
+void
+DscpQueueMap::Map(uint8_t dscp, uint32_t queueIndex)
+{
+    m_queueIndexByDscp[dscp & 0x3f] = queueIndex;
+}
+
+uint32_t
+DscpQueueMap::GetNQueues() const
+{
+    return *std::max_element(m_queueIndexByDscp.begin(), m_queueIndexByDscp.end()) + 1;
+}
+
+} // namespace ns3
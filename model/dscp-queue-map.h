@@ -0,0 +1,59 @@
+#ifndef DSCP_QUEUE_MAP_H
+#define DSCP_QUEUE_MAP_H
+
+#include <array>
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::DscpQueueMap declaration.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup bridge
+ * \brief Slice queue of each DSCP
+ *
+ * By default every slice DSCP goes to the queue of its slice type in
+ * CustomQueueDisc (0 = URLLC, 1 = eMBB, 2 = mMTC), and every other DSCP to
+ * the eMBB queue. The queues are resolved once, so that classifying a
+ * packet is a single array access.
+ *
+ * CustomQueueDisc and the egress schedulers of SlicescopeSwitchNetDevice
+ * both classify through a map, so a map with DSCP overrides can be given
+ * to both, and they queue the packets alike.
+ */
+class DscpQueueMap
+{
+  public:
+    DscpQueueMap();
+
+    /**
+     * \brief Sends the packets of a DSCP to a queue
+     * \param dscp the DSCP
+     * \param queueIndex the queue index
+     */
+    void Map(uint8_t dscp, uint32_t queueIndex);
+
+    /**
+     * \param dscp the DSCP
+     * \returns the queue of its packets
+     */
+    uint32_t GetQueueIndex(uint8_t dscp) const
+    {
+        return m_queueIndexByDscp[dscp & 0x3f];
+    }
+
+    /// \returns the number of queues the map needs, one more than its largest queue index
+    uint32_t GetNQueues() const;
+
+  private:
+    std::array<uint32_t, 64> m_queueIndexByDscp; //!< queue of each DSCP
+};
+
+} // namespace ns3
+
+#endif /* DSCP_QUEUE_MAP_H */
@@ -0,0 +1,154 @@
+#include "flow-cache.h"
+
+#include "ns3/log.h"
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::FlowCache implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("FlowCache");
+
+bool
+FlowCache::PackedKey::operator==(const PackedKey& other) const
+{
+    return addresses == other.addresses && others == other.others;
+}
+
+size_t
+FlowCache::PackedKeyHash::operator()(const PackedKey& key) const
+{
+    return FlowKey::Mix(FlowKey::Mix(key.addresses) ^ key.others);
+}
+
+FlowCache::FlowCache()
+    : m_capacity(0),
+      m_hand(0),
+      m_hits(0),
+      m_misses(0),
+      m_evictions(0)
+{
+}
+
+void
+FlowCache::SetCapacity(uint32_t capacity)
+{
+    NS_LOG_FUNCTION(this << capacity);
+    m_capacity = capacity;
+    Flush();
+    m_entries.reserve(capacity);
+    m_index.reserve(capacity);
+}
+
+const SlicescopePipeline::Result*
+FlowCache::Lookup(const SlicescopePipeline::Key& key)
+{
+    auto it = m_index.find(Pack(key));
+    if (it == m_index.end())
+    {
+        m_misses++;
+        return nullptr;
+    }
+    m_hits++;
+    Entry& entry = m_entries[it->second];
+    entry.referenced = true;
+    return &entry.value;
+}
+
+void
+FlowCache::Insert(const SlicescopePipeline::Key& key, const SlicescopePipeline::Result& result)
+{
+    if (m_capacity == 0)
+    {
+        return;
+    }
+    PackedKey packed = Pack(key);
+    if (m_entries.size() < m_capacity)
+    {
+        m_index[packed] = m_entries.size();
+        m_entries.push_back({packed, result, false});
+        return;
+    }
+
+    // Referenced entries get a second chance; the hand stops at the first
+    // entry that was not hit since its last pass
+    while (m_entries[m_hand].referenced)
+    {
+        m_entries[m_hand].referenced = false;
+        m_hand = (m_hand + 1) % m_capacity;
+    }
+    Entry& victim = m_entries[m_hand];
+    NS_LOG_LOGIC("Evicting entry " << m_hand);
+    m_index.erase(victim.key);
+    m_index[packed] = m_hand;
+    victim.key = packed;
+    victim.value = result;
+    victim.referenced = false;
+    m_hand = (m_hand + 1) % m_capacity;
+    m_evictions++;
+}
+
+void
+FlowCache::Flush()
+{
+    NS_LOG_FUNCTION(this);
+    m_entries.clear();
+    m_index.clear();
+    m_hand = 0;
+}
+
+void
+FlowCache::Clear()
+{
+    Flush();
+    m_hits = 0;
+    m_misses = 0;
+    m_evictions = 0;
+}
+
+uint32_t
+FlowCache::GetCapacity() const
+{
+    return m_capacity;
+}
+
+uint32_t
+FlowCache::GetOccupancy() const
+{
+    return m_entries.size();
+}
+
+uint64_t
+FlowCache::GetHits() const
+{
+    return m_hits;
+}
+
+uint64_t
+FlowCache::GetMisses() const
+{
+    return m_misses;
+}
+
+uint64_t
+FlowCache::GetEvictions() const
+{
+    return m_evictions;
+}
+
+FlowCache::PackedKey
+FlowCache::Pack(const SlicescopePipeline::Key& key)
+{
+    PackedKey packed;
+    packed.addresses = (uint64_t(key.flow.srcAddress) << 32) | key.flow.dstAddress;
+    packed.others = (uint64_t(key.flow.srcPort) << 48) | (uint64_t(key.flow.dstPort) << 32) |
+                    (uint64_t(key.flow.protocol) << 24) | (uint64_t(key.flow.dscp & 0x3f) << 16) |
+                    (key.inPort & 0xffff);
+    return packed;
+}
+
+} // namespace ns3
@@ -0,0 +1,117 @@
+#ifndef FLOW_CACHE_H
+#define FLOW_CACHE_H
+
+#include "slicescope-pipeline.h"
+
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::FlowCache declaration.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup bridge
+ * \brief Exact-match cache of the pipeline outcome of each flow
+ *
+ * Entries are keyed by the full pipeline key (5-tuple, DSCP and ingress
+ * port), so a cached result is the one the pipeline would return. The
+ * entries live in a fixed array of the configured capacity; when it is full,
+ * a CLOCK hand evicts the first entry that was not hit since the hand last
+ * passed it, which approximates LRU without touching a list on every hit.
+ */
+class FlowCache
+{
+  public:
+    FlowCache();
+
+    /**
+     * \brief Set the number of entries; existing entries are removed
+     * \param capacity the capacity, 0 to disable the cache
+     */
+    void SetCapacity(uint32_t capacity);
+
+    /**
+     * \brief Look the result of a flow up
+     * \param key the pipeline key of the packet
+     * \returns the cached result, or nullptr on a miss
+     */
+    const SlicescopePipeline::Result* Lookup(const SlicescopePipeline::Key& key);
+
+    /**
+     * \brief Cache the result of a flow, evicting an entry if the cache is full
+     * \param key the pipeline key of the packet
+     * \param result the pipeline result
+     */
+    void Insert(const SlicescopePipeline::Key& key, const SlicescopePipeline::Result& result);
+
+    /// Remove all entries, e.g. after the pipeline changed; counters are kept
+    void Flush();
+
+    /// Remove all entries and reset the counters
+    void Clear();
+
+    /// \returns the number of entries the cache holds
+    uint32_t GetCapacity() const;
+    /// \returns the number of cached flows
+    uint32_t GetOccupancy() const;
+    /// \returns the number of lookups that found the flow
+    uint64_t GetHits() const;
+    /// \returns the number of lookups that did not find the flow
+    uint64_t GetMisses() const;
+    /// \returns the number of entries evicted to make room for another flow
+    uint64_t GetEvictions() const;
+
+  private:
+    /// Key fields packed in two words
+    struct PackedKey
+    {
+        uint64_t addresses; //!< source address (high half) and destination address
+        uint64_t others;    //!< ports, protocol, DSCP and ingress port
+
+        /// \returns true if both words are equal
+        bool operator==(const PackedKey& other) const;
+    };
+
+    /// Hash of a PackedKey
+    struct PackedKeyHash
+    {
+        /**
+         * \param key the key
+         * \returns the hash of the key
+         */
+        size_t operator()(const PackedKey& key) const;
+    };
+
+    /// Cached flow
+    struct Entry
+    {
+        PackedKey key;                    //!< flow key
+        SlicescopePipeline::Result value; //!< pipeline result
+        bool referenced;                  //!< hit since the CLOCK hand last passed
+    };
+
+    /**
+     * \param key the pipeline key
+     * \returns the packed key
+     */
+    static PackedKey Pack(const SlicescopePipeline::Key& key);
+
+    std::vector<Entry> m_entries;                                   //!< cached flows
+    std::unordered_map<PackedKey, uint32_t, PackedKeyHash> m_index; //!< key to entry index
+    uint32_t m_capacity;                                            //!< maximum number of entries
+    uint32_t m_hand;                                                //!< CLOCK hand
+    uint64_t m_hits;                                                //!< lookups that hit
+    uint64_t m_misses;                                              //!< lookups that missed
+    uint64_t m_evictions;                                           //!< entries evicted
+};
+
+} // namespace ns3
+
+#endif /* FLOW_CACHE_H */
@@ -0,0 +1,150 @@
+#include "flow-key.h"
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::FlowKey implementation.
+ */
+
+namespace ns3
+{
+
+FlowKey::FlowKey()
+    : srcAddress(0),
+      dstAddress(0),
+      srcPort(0),
+      dstPort(0),
+      protocol(0),
+      dscp(0)
+{
+}
+
+bool
+FlowKey::Extract(Ptr<const Packet> packet)
+{
+    // Largest IPv4 header (60 bytes) followed by the two port fields
+    uint8_t buffer[64];
+    uint32_t length = packet->CopyData(buffer, sizeof(buffer));
+    if (length < 20 || (buffer[0] >> 4) != 4)
+    {
+        return false;
+    }
+    dscp = buffer[1] >> 2;
+    protocol = buffer[9];
+    srcAddress = (uint32_t(buffer[12]) << 24) | (uint32_t(buffer[13]) << 16) |
+                 (uint32_t(buffer[14]) << 8) | buffer[15];
+    dstAddress = (uint32_t(buffer[16]) << 24) | (uint32_t(buffer[17]) << 16) |
+                 (uint32_t(buffer[18]) << 8) | buffer[19];
+
+    uint32_t headerLength = (buffer[0] & 0x0f) * 4;
+    bool firstFragment = ((buffer[6] & 0x1f) | buffer[7]) == 0;
+    if ((protocol == 6 || protocol == 17) && firstFragment && length >= headerLength + 4)
+    {
+        srcPort = (uint16_t(buffer[headerLength]) << 8) | buffer[headerLength + 1];
+        dstPort = (uint16_t(buffer[headerLength + 2]) << 8) | buffer[headerLength + 3];
+    }
+    else
+    {
+        srcPort = 0;
+        dstPort = 0;
+    }
+    return true;
+}
+
+void
+FlowKey::Extract(const Ipv4Header& header, Ptr<const Packet> payload)
+{
+    srcAddress = header.GetSource().Get();
+    dstAddress = header.GetDestination().Get();
+    protocol = header.GetProtocol();
+    dscp = header.GetDscp();
+
+    uint8_t buffer[4];
+    bool firstFragment = header.GetFragmentOffset() == 0;
+    if ((protocol == 6 || protocol == 17) && firstFragment &&
+        payload->CopyData(buffer, sizeof(buffer)) == sizeof(buffer))
+    {
+        srcPort = (uint16_t(buffer[0]) << 8) | buffer[1];
+        dstPort = (uint16_t(buffer[2]) << 8) | buffer[3];
+    }
+    else
+    {
+        srcPort = 0;
+        dstPort = 0;
+    }
+}
+
+uint64_t
+FlowKey::Hash(uint32_t fields, uint64_t seed) const
+{
+    uint64_t hash = Mix(seed + 0x9e3779b97f4a7c15ULL);
+    if (fields & SRC_ADDRESS)
+    {
+        hash = Mix(hash ^ srcAddress);
+    }
+    if (fields & DST_ADDRESS)
+    {
+        hash = Mix(hash ^ (uint64_t(dstAddress) << 32));
+    }
+    uint64_t rest = 0;
+    if (fields & PROTOCOL)
+    {
+        rest |= uint64_t(protocol);
+    }
+    if (fields & SRC_PORT)
+    {
+        rest |= uint64_t(srcPort) << 8;
+    }
+    if (fields & DST_PORT)
+    {
+        rest |= uint64_t(dstPort) << 24;
+    }
+    if (fields & DSCP)
+    {
+        rest |= uint64_t(dscp) << 40;
+    }
+    return Mix(hash ^ rest);
+}
+
+Ipv4Address
+FlowKey::GetSource() const
+{
+    return Ipv4Address(srcAddress);
+}
+
+Ipv4Address
+FlowKey::GetDestination() const
+{
+    return Ipv4Address(dstAddress);
+}
+
+uint64_t
+FlowKey::Mix(uint64_t value)
+{
+    // MurmurHash3 fmix64
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return value;
+}
+
+bool
+FlowKey::operator==(const FlowKey& other) const
+{
+    return srcAddress == other.srcAddress && dstAddress == other.dstAddress &&
+           srcPort == other.srcPort && dstPort == other.dstPort && protocol == other.protocol &&
+           dscp == other.dscp;
+}
+
+std::ostream&
+operator<<(std::ostream& os, const FlowKey& key)
+{
+    os << key.GetSource() << ":" << key.srcPort << " -> " << key.GetDestination() << ":"
+       << key.dstPort << " proto " << static_cast<uint32_t>(key.protocol) << " dscp "
+       << static_cast<uint32_t>(key.dscp);
+    return os;
+}
+
+} // namespace ns3
@@ -0,0 +1,105 @@
+#ifndef FLOW_KEY_H
+#define FLOW_KEY_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/packet.h"
+#include "ns3/ptr.h"
+
+#include <ostream>
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::FlowKey declaration.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup bridge
+ * \brief IPv4 5-tuple plus DSCP of a packet
+ *
+ * The key is read straight from the first bytes of an IPv4 packet, without
+ * deserializing Ipv4Header/UdpHeader/TcpHeader objects, so it is cheap enough
+ * to compute on the switch forwarding path.
+ */
+struct FlowKey
+{
+    /// Fields that can take part in the flow hash
+    enum Field
+    {
+        SRC_ADDRESS = 1 << 0, //!< IPv4 source address
+        DST_ADDRESS = 1 << 1, //!< IPv4 destination address
+        PROTOCOL = 1 << 2,    //!< IPv4 protocol number
+        SRC_PORT = 1 << 3,    //!< UDP/TCP source port
+        DST_PORT = 1 << 4,    //!< UDP/TCP destination port
+        DSCP = 1 << 5,        //!< DSCP of the IPv4 TOS byte
+        FIVE_TUPLE = SRC_ADDRESS | DST_ADDRESS | PROTOCOL | SRC_PORT | DST_PORT,
+        ALL_FIELDS = FIVE_TUPLE | DSCP
+    };
+
+    uint32_t srcAddress; //!< IPv4 source address
+    uint32_t dstAddress; //!< IPv4 destination address
+    uint16_t srcPort;    //!< UDP/TCP source port, 0 for other protocols
+    uint16_t dstPort;    //!< UDP/TCP destination port, 0 for other protocols
+    uint8_t protocol;    //!< IPv4 protocol number
+    uint8_t dscp;        //!< DSCP of the IPv4 TOS byte
+
+    FlowKey();
+
+    /**
+     * \brief Read the key from an IPv4 packet
+     * \param packet a packet starting with an IPv4 header
+     * \returns true if the packet was long enough to hold an IPv4 header
+     *
+     * Ports are only read for UDP and TCP first fragments.
+     */
+    bool Extract(Ptr<const Packet> packet);
+
+    /**
+     * \brief Read the key from an already parsed IPv4 header
+     * \param header the IPv4 header
+     * \param payload the packet without its IPv4 header
+     *
+     * Used where the IPv4 header has been removed, e.g. in queue discs.
+     */
+    void Extract(const Ipv4Header& header, Ptr<const Packet> payload);
+
+    /**
+     * \brief Hash a subset of the fields
+     * \param fields bitmask of Field values
+     * \param seed hash seed, so that switches can hash differently
+     * \returns a 64-bit hash of the selected fields
+     */
+    uint64_t Hash(uint32_t fields, uint64_t seed) const;
+
+    /// \returns the source address
+    Ipv4Address GetSource() const;
+    /// \returns the destination address
+    Ipv4Address GetDestination() const;
+
+    /**
+     * \brief 64-bit finalizer used to mix hash inputs
+     * \param value the value to mix
+     * \returns the mixed value
+     */
+    static uint64_t Mix(uint64_t value);
+
+    /// \returns true if all fields are equal
+    bool operator==(const FlowKey& other) const;
+};
+
+/**
+ * \brief Stream insertion operator
+ * \param os the stream
+ * \param key the flow key
+ * \returns a reference to the stream
+ */
+std::ostream& operator<<(std::ostream& os, const FlowKey& key);
+
+} // namespace ns3
+
+#endif /* FLOW_KEY_H */
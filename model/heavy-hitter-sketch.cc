@@ -0,0 +1,171 @@
+#include "heavy-hitter-sketch.h"
+
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::HeavyHitterSketch implementation.
+ */
+
+namespace ns3
+{
+
+HeavyHitterSketch::HeavyHitterSketch()
+    : m_width(0),
+      m_depth(0),
+      m_topK(0),
+      m_totalBytes(0)
+{
+}
+
+void
+HeavyHitterSketch::Configure(uint32_t width, uint32_t depth, uint32_t topK)
+{
+    m_width = 1;
+    while (m_width < width)
+    {
+        m_width <<= 1;
+    }
+    m_depth = std::min(std::max<uint32_t>(depth, 1), MAX_DEPTH);
+    m_topK = topK;
+    m_counters.assign(topK ? m_width * m_depth : 0, 0);
+    m_top.clear();
+    m_top.reserve(topK);
+    m_totalBytes = 0;
+}
+
+void
+HeavyHitterSketch::Update(const FlowKey& flow, uint32_t bytes)
+{
+    if (!m_topK)
+    {
+        return;
+    }
+    uint64_t hash = flow.Hash(FlowKey::FIVE_TUPLE, 0);
+    uint32_t indices[MAX_DEPTH];
+    GetIndices(hash, indices);
+    for (uint32_t i = 0; i < m_depth; i++)
+    {
+        m_counters[indices[i]] += bytes;
+    }
+    uint64_t estimate = UINT64_MAX;
+    for (uint32_t i = 0; i < m_depth; i++)
+    {
+        estimate = std::min(estimate, m_counters[indices[i]]);
+    }
+    m_totalBytes += bytes;
+
+    if (m_top.size() == m_topK && estimate <= m_top.front().bytes)
+    {
+        return;
+    }
+    for (uint32_t i = 0; i < m_top.size(); i++)
+    {
+        if (m_top[i].hash == hash)
+        {
+            m_top[i].bytes = estimate;
+            SiftDown(i);
+            return;
+        }
+    }
+    Entry entry = {flow, hash, estimate};
+    if (m_top.size() < m_topK)
+    {
+        m_top.push_back(entry);
+        std::push_heap(m_top.begin(), m_top.end(), [](const Entry& a, const Entry& b) {
+            return a.bytes > b.bytes;
+        });
+        return;
+    }
+    m_top.front() = entry;
+    SiftDown(0);
+}
+
+void
+HeavyHitterSketch::GetIndices(uint64_t hash, uint32_t* indices) const
+{
+    // Independent lanes: the compiler computes all the rows at once
+    uint32_t h1 = hash;
+    uint32_t h2 = (hash >> 32) | 1;
+    uint32_t mask = m_width - 1;
+    for (uint32_t i = 0; i < m_depth; i++)
+    {
+        indices[i] = i * m_width + ((h1 + i * h2) & mask);
+    }
+}
+
+void
+HeavyHitterSketch::SiftDown(uint32_t position)
+{
+    uint32_t size = m_top.size();
+    while (true)
+    {
+        uint32_t smallest = position;
+        uint32_t left = 2 * position + 1;
+        uint32_t right = left + 1;
+        if (left < size && m_top[left].bytes < m_top[smallest].bytes)
+        {
+            smallest = left;
+        }
+        if (right < size && m_top[right].bytes < m_top[smallest].bytes)
+        {
+            smallest = right;
+        }
+        if (smallest == position)
+        {
+            return;
+        }
+        std::swap(m_top[position], m_top[smallest]);
+        position = smallest;
+    }
+}
+
+uint64_t
+HeavyHitterSketch::Estimate(const FlowKey& flow) const
+{
+    if (!m_topK)
+    {
+        return 0;
+    }
+    uint32_t indices[MAX_DEPTH];
+    GetIndices(flow.Hash(FlowKey::FIVE_TUPLE, 0), indices);
+    uint64_t estimate = UINT64_MAX;
+    for (uint32_t i = 0; i < m_depth; i++)
+    {
+        estimate = std::min(estimate, m_counters[indices[i]]);
+    }
+    return estimate;
+}
+
+std::vector<HeavyHitterSketch::Entry>
+HeavyHitterSketch::GetTopK() const
+{
+    std::vector<Entry> top = m_top;
+    std::sort(top.begin(), top.end(), [](const Entry& a, const Entry& b) {
+        return a.bytes > b.bytes;
+    });
+    return top;
+}
+
+uint64_t
+HeavyHitterSketch::GetTotalBytes() const
+{
+    return m_totalBytes;
+}
+
+uint32_t
+HeavyHitterSketch::GetMemoryBytes() const
+{
+    return m_counters.size() * sizeof(uint64_t) + m_topK * sizeof(Entry);
+}
+
+void
+HeavyHitterSketch::Clear()
+{
+    std::fill(m_counters.begin(), m_counters.end(), 0);
+    m_top.clear();
+    m_totalBytes = 0;
+}
+
+} // namespace ns3
@@ -0,0 +1,102 @@
+#ifndef HEAVY_HITTER_SKETCH_H
+#define HEAVY_HITTER_SKETCH_H
+
+#include "flow-key.h"
+
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::HeavyHitterSketch declaration.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup bridge
+ * \brief Count-min sketch of the bytes per flow, with the top-k flows
+ *
+ * The sketch has Depth rows of Width byte counters. A flow adds its bytes
+ * to one counter per row, at indices derived from a single 64-bit hash of
+ * its 5-tuple (h1 + row * h2), and its estimate is the smallest of these
+ * counters: estimates never undercount, and overcount by at most
+ * e / Width of the total bytes with probability 1 - exp(-Depth).
+ *
+ * The k flows with the largest estimates are kept in a min-heap, so that a
+ * flow whose estimate does not exceed the smallest of them costs one
+ * comparison. Memory is fixed by Width, Depth and k, whatever the number
+ * of flows.
+ */
+class HeavyHitterSketch
+{
+  public:
+    static constexpr uint32_t MAX_DEPTH = 8; //!< largest number of rows
+
+    /// A flow of the top-k
+    struct Entry
+    {
+        FlowKey flow;   //!< the flow
+        uint64_t hash;  //!< hash of its 5-tuple
+        uint64_t bytes; //!< estimated bytes
+    };
+
+    HeavyHitterSketch();
+
+    /**
+     * \brief Set the dimensions of the sketch; counters and flows are removed
+     * \param width counters per row, rounded up to a power of two
+     * \param depth number of rows, at most MAX_DEPTH
+     * \param topK number of flows kept, 0 to disable the sketch
+     */
+    void Configure(uint32_t width, uint32_t depth, uint32_t topK);
+
+    /**
+     * \brief Count the bytes of a packet
+     * \param flow the flow of the packet
+     * \param bytes the packet size
+     */
+    void Update(const FlowKey& flow, uint32_t bytes);
+
+    /**
+     * \param flow the flow
+     * \returns the estimated bytes of the flow
+     */
+    uint64_t Estimate(const FlowKey& flow) const;
+
+    /// \returns the top-k flows, largest first
+    std::vector<Entry> GetTopK() const;
+
+    /// \returns the bytes counted since the last Clear
+    uint64_t GetTotalBytes() const;
+
+    /// \returns the memory used by the counters and the top-k, in bytes
+    uint32_t GetMemoryBytes() const;
+
+    /// Reset the counters and the top-k, keeping the dimensions
+    void Clear();
+
+  private:
+    /**
+     * \brief Computes the counter of a flow in each row
+     * \param hash the flow hash
+     * \param indices set to the index of the counter of each row in m_counters
+     */
+    void GetIndices(uint64_t hash, uint32_t* indices) const;
+
+    /// Moves the top-k entry at a position down to restore the min-heap
+    void SiftDown(uint32_t position);
+
+    std::vector<uint64_t> m_counters; //!< Depth rows of Width counters
+    std::vector<Entry> m_top;         //!< top-k flows, min-heap on bytes
+    uint32_t m_width;                 //!< counters per row
+    uint32_t m_depth;                 //!< number of rows
+    uint32_t m_topK;                  //!< number of flows kept
+    uint64_t m_totalBytes;            //!< bytes counted
+};
+
+} // namespace ns3
+
+#endif /* HEAVY_HITTER_SKETCH_H */
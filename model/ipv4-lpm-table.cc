@@ -0,0 +1,135 @@
+#include "ipv4-lpm-table.h"
+
+#include "ns3/log.h"
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::Ipv4LpmTable implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("Ipv4LpmTable");
+
+Ipv4LpmTable::Ipv4LpmTable()
+{
+}
+
+void
+Ipv4LpmTable::AddRoute(uint32_t network, uint8_t prefixLength, uint32_t nextHop)
+{
+    NS_LOG_FUNCTION(this << network << (uint32_t)prefixLength << nextHop);
+    NS_ASSERT_MSG(prefixLength <= 32, "Invalid prefix length " << (uint32_t)prefixLength);
+    NS_ASSERT_MSG(nextHop <= MAX_NEXT_HOP, "Next hop identifier out of range");
+
+    if (m_tbl16.empty())
+    {
+        m_tbl16.assign(1 << 16, 0);
+    }
+
+    uint32_t mask = prefixLength == 0 ? 0 : 0xffffffff << (32 - prefixLength);
+    network &= mask;
+    uint32_t entry = (static_cast<uint32_t>(prefixLength) << DEPTH_SHIFT) | (nextHop + 1);
+
+    if (prefixLength <= 16)
+    {
+        Fill(0, network >> 16, 1 << (16 - prefixLength), prefixLength, entry, false);
+    }
+    else
+    {
+        uint32_t group = Extend(network >> 16, false);
+        if (prefixLength <= 24)
+        {
+            Fill(group << 8,
+                 (network >> 8) & 0xff,
+                 1 << (24 - prefixLength),
+                 prefixLength,
+                 entry,
+                 true);
+        }
+        else
+        {
+            group = Extend((group << 8) | ((network >> 8) & 0xff), true);
+            Fill(group << 8, network & 0xff, 1 << (32 - prefixLength), prefixLength, entry, true);
+        }
+    }
+    m_prefixes.emplace(network, prefixLength);
+}
+
+void
+Ipv4LpmTable::AddRoute(Ipv4Address network, Ipv4Mask mask, uint32_t nextHop)
+{
+    AddRoute(network.Get(), mask.GetPrefixLength(), nextHop);
+}
+
+uint32_t
+Ipv4LpmTable::Lookup(Ipv4Address destination) const
+{
+    return Lookup(destination.Get());
+}
+
+uint32_t
+Ipv4LpmTable::GetNRoutes() const
+{
+    return m_prefixes.size();
+}
+
+void
+Ipv4LpmTable::Clear()
+{
+    NS_LOG_FUNCTION(this);
+    std::vector<uint32_t>().swap(m_tbl16);
+    std::vector<uint32_t>().swap(m_groups);
+    m_prefixes.clear();
+}
+
+void
+Ipv4LpmTable::Fill(uint32_t base,
+                   uint32_t first,
+                   uint32_t count,
+                   uint8_t depth,
+                   uint32_t entry,
+                   bool groups)
+{
+    std::vector<uint32_t>& table = groups ? m_groups : m_tbl16;
+    for (uint32_t i = base + first; i < base + first + count; i++)
+    {
+        uint32_t current = table[i];
+        if (current & EXTENDED)
+        {
+            // More specific routes live below; overwrite the ones this route covers
+            Fill((current & VALUE_MASK) << 8, 0, 256, depth, entry, true);
+        }
+        else if (((current >> DEPTH_SHIFT) & DEPTH_MASK) <= depth)
+        {
+            table[i] = entry;
+        }
+    }
+}
+
+uint32_t
+Ipv4LpmTable::Extend(uint32_t index, bool groups)
+{
+    uint32_t current = groups ? m_groups[index] : m_tbl16[index];
+    if (current & EXTENDED)
+    {
+        return current & VALUE_MASK;
+    }
+    // The new group inherits the route that covered the whole entry
+    uint32_t group = m_groups.size() >> 8;
+    NS_ASSERT_MSG(group <= VALUE_MASK, "Too many LPM groups");
+    m_groups.resize(m_groups.size() + 256, current);
+    if (groups)
+    {
+        m_groups[index] = EXTENDED | group;
+    }
+    else
+    {
+        m_tbl16[index] = EXTENDED | group;
+    }
+    return group;
+}
+
+} // namespace ns3
@@ -0,0 +1,132 @@
+#ifndef IPV4_LPM_TABLE_H
+#define IPV4_LPM_TABLE_H
+
+#include "ns3/ipv4-address.h"
+
+#include <set>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::Ipv4LpmTable declaration.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup bridge
+ * \brief Longest-prefix-match table for IPv4 destinations
+ *
+ * A DIR-16-8-8 multibit trie: a flat first-level array indexed by the top
+ * 16 address bits, followed by 256-entry groups for the next two bytes that
+ * are only allocated below prefixes longer than /16 and /24. A lookup is at
+ * most three dependent array reads. Prefix lengths are stored in each entry so
+ * routes can be added in any order.
+ *
+ * The first level (256 KiB) is allocated on the first insertion, so switches
+ * that never route pay nothing. Next hops are opaque 24-bit identifiers.
+ */
+class Ipv4LpmTable
+{
+  public:
+    /// Returned by Lookup() when no route matches
+    static constexpr uint32_t NO_ROUTE = 0xffffffff;
+    /// Largest next hop identifier that can be stored
+    static constexpr uint32_t MAX_NEXT_HOP = 0x00fffffe;
+
+    Ipv4LpmTable();
+
+    /**
+     * \brief Add or replace a route
+     * \param network the destination network
+     * \param prefixLength the prefix length (0 to 32)
+     * \param nextHop the next hop identifier (at most MAX_NEXT_HOP)
+     */
+    void AddRoute(uint32_t network, uint8_t prefixLength, uint32_t nextHop);
+
+    /**
+     * \brief Add or replace a route
+     * \param network the destination network
+     * \param mask the network mask
+     * \param nextHop the next hop identifier (at most MAX_NEXT_HOP)
+     */
+    void AddRoute(Ipv4Address network, Ipv4Mask mask, uint32_t nextHop);
+
+    /**
+     * \brief Find the longest matching route
+     * \param destination the destination address
+     * \returns the next hop identifier, or NO_ROUTE
+     */
+    uint32_t Lookup(uint32_t destination) const
+    {
+        if (m_tbl16.empty())
+        {
+            return NO_ROUTE;
+        }
+        uint32_t entry = m_tbl16[destination >> 16];
+        if (entry & EXTENDED)
+        {
+            entry = m_groups[((entry & VALUE_MASK) << 8) | ((destination >> 8) & 0xff)];
+            if (entry & EXTENDED)
+            {
+                entry = m_groups[((entry & VALUE_MASK) << 8) | (destination & 0xff)];
+            }
+        }
+        return (entry & VALUE_MASK) - 1;
+    }
+
+    /**
+     * \brief Find the longest matching route
+     * \param destination the destination address
+     * \returns the next hop identifier, or NO_ROUTE
+     */
+    uint32_t Lookup(Ipv4Address destination) const;
+
+    /// \returns the number of routes, a replaced route counting once
+    uint32_t GetNRoutes() const;
+
+    /// Remove all routes and release the tables
+    void Clear();
+
+  private:
+    static constexpr uint32_t EXTENDED = 0x80000000;   //!< entry points to a group
+    static constexpr uint32_t DEPTH_SHIFT = 24;        //!< position of the prefix length
+    static constexpr uint32_t DEPTH_MASK = 0x3f;       //!< prefix length bits
+    static constexpr uint32_t VALUE_MASK = 0x00ffffff; //!< next hop + 1, or group index
+
+    /**
+     * \brief Write a route over a range of entries of one level
+     * \param base offset of the first entry of the level array
+     * \param first first entry to write
+     * \param count number of entries to write
+     * \param depth prefix length of the route
+     * \param entry the encoded route
+     * \param groups true if base refers to m_groups rather than m_tbl16
+     */
+    void Fill(uint32_t base,
+              uint32_t first,
+              uint32_t count,
+              uint8_t depth,
+              uint32_t entry,
+              bool groups);
+
+    /**
+     * \brief Make sure an entry points to a group, creating it if needed
+     * \param index the entry index in m_tbl16 or m_groups
+     * \param groups true if index refers to m_groups
+     * \returns the group index
+     */
+    uint32_t Extend(uint32_t index, bool groups);
+
+    std::vector<uint32_t> m_tbl16;                     //!< first level, indexed by the top 16 bits
+    std::vector<uint32_t> m_groups;                    //!< 256-entry groups for the lower levels
+    std::set<std::pair<uint32_t, uint8_t>> m_prefixes; //!< network and length of each route
+};
+
+} // namespace ns3
+
+#endif /* IPV4_LPM_TABLE_H */
@@ -0,0 +1,343 @@
+#include "mac-learning-table.h"
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::MacLearningTable implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("MacLearningTable");
+
+/// Index returned by Find() when the key is not in the table
+static const uint32_t NOT_FOUND = 0xffffffff;
+
+MacLearningTable::MacLearningTable()
+    : m_mask(0),
+      m_size(0),
+      m_capacity(0),
+      m_expiration(Seconds(300).GetTimeStep()),
+      m_tick(1),
+      m_wheelTick(0),
+      m_hits(0),
+      m_misses(0),
+      m_evictions(0)
+{
+    m_wheel.resize(64);
+    Resize(8);
+    RebuildWheel();
+}
+
+void
+MacLearningTable::SetCapacity(uint32_t capacity)
+{
+    NS_LOG_FUNCTION(this << capacity);
+    uint32_t numBuckets = 8;
+    while (numBuckets - numBuckets / 4 < capacity)
+    {
+        numBuckets <<= 1;
+    }
+    if (numBuckets > m_entries.size())
+    {
+        Resize(numBuckets);
+    }
+}
+
+void
+MacLearningTable::SetExpirationTime(Time expirationTime)
+{
+    NS_LOG_FUNCTION(this << expirationTime);
+    m_expiration = std::max<int64_t>(1, expirationTime.GetTimeStep());
+    RebuildWheel();
+}
+
+void
+MacLearningTable::SetWheelSlots(uint32_t numSlots)
+{
+    NS_LOG_FUNCTION(this << numSlots);
+    m_wheel.assign(std::max<uint32_t>(1, numSlots), std::vector<uint64_t>());
+    RebuildWheel();
+}
+
+bool
+MacLearningTable::Learn(Mac48Address address, uint32_t port)
+{
+    int64_t now = Simulator::Now().GetTimeStep();
+    AdvanceWheel(now);
+
+    uint64_t key = MakeKey(address);
+    int64_t expiration = now + m_expiration;
+    uint32_t slot = WheelSlotFor(expiration);
+
+    uint32_t index = Find(key);
+    if (index == NOT_FOUND)
+    {
+        if (m_size >= m_capacity)
+        {
+            Resize(m_entries.size() * 2);
+        }
+        index = Hash(key);
+        while (m_entries[index].key != 0)
+        {
+            index = (index + 1) & m_mask;
+        }
+        m_entries[index] = {key, expiration, port, slot};
+        m_size++;
+        m_wheel[slot].push_back(key);
+        return true;
+    }
+
+    Entry& entry = m_entries[index];
+    bool changed = entry.port != port || entry.expiration <= now;
+    entry.port = port;
+    entry.expiration = expiration;
+    if (entry.wheelSlot != slot)
+    {
+        entry.wheelSlot = slot;
+        m_wheel[slot].push_back(key);
+    }
+    return changed;
+}
+
+uint32_t
+MacLearningTable::Lookup(Mac48Address address)
+{
+    int64_t now = Simulator::Now().GetTimeStep();
+    AdvanceWheel(now);
+
+    uint32_t index = Find(MakeKey(address));
+    if (index != NOT_FOUND)
+    {
+        if (m_entries[index].expiration > now)
+        {
+            m_hits++;
+            return m_entries[index].port;
+        }
+        Erase(index);
+        m_evictions++;
+    }
+    m_misses++;
+    return NO_PORT;
+}
+
+void
+MacLearningTable::Clear()
+{
+    NS_LOG_FUNCTION(this);
+    for (auto& entry : m_entries)
+    {
+        entry.key = 0;
+    }
+    for (auto& keys : m_wheel)
+    {
+        keys.clear();
+    }
+    m_size = 0;
+    m_hits = 0;
+    m_misses = 0;
+    m_evictions = 0;
+}
+
+uint32_t
+MacLearningTable::GetOccupancy() const
+{
+    return m_size;
+}
+
+uint32_t
+MacLearningTable::GetWheelSlots() const
+{
+    return m_wheel.size();
+}
+
+uint32_t
+MacLearningTable::GetCapacity() const
+{
+    return m_capacity;
+}
+
+uint64_t
+MacLearningTable::GetHits() const
+{
+    return m_hits;
+}
+
+uint64_t
+MacLearningTable::GetMisses() const
+{
+    return m_misses;
+}
+
+uint64_t
+MacLearningTable::GetEvictions() const
+{
+    return m_evictions;
+}
+
+uint64_t
+MacLearningTable::MakeKey(Mac48Address address)
+{
+    uint8_t buffer[6];
+    address.CopyTo(buffer);
+    uint64_t key = 0;
+    for (uint32_t i = 0; i < 6; i++)
+    {
+        key = (key << 8) | buffer[i];
+    }
+    // The top bit marks the slot as occupied, so the all-zero address is valid
+    return key | (1ULL << 63);
+}
+
+uint32_t
+MacLearningTable::Hash(uint64_t key) const
+{
+    uint64_t h = key * 0x9e3779b97f4a7c15ULL;
+    return static_cast<uint32_t>(h ^ (h >> 32)) & m_mask;
+}
+
+uint32_t
+MacLearningTable::Find(uint64_t key) const
+{
+    uint32_t index = Hash(key);
+    while (m_entries[index].key != 0)
+    {
+        if (m_entries[index].key == key)
+        {
+            return index;
+        }
+        index = (index + 1) & m_mask;
+    }
+    return NOT_FOUND;
+}
+
+void
+MacLearningTable::Erase(uint32_t index)
+{
+    // Backward shift deletion: pull later entries of the probe chain into the
+    // hole so that lookups never need tombstones.
+    uint32_t hole = index;
+    uint32_t next = index;
+    while (true)
+    {
+        next = (next + 1) & m_mask;
+        if (m_entries[next].key == 0)
+        {
+            break;
+        }
+        uint32_t home = Hash(m_entries[next].key);
+        if (((next - home) & m_mask) >= ((next - hole) & m_mask))
+        {
+            m_entries[hole] = m_entries[next];
+            hole = next;
+        }
+    }
+    m_entries[hole].key = 0;
+    m_size--;
+}
+
+void
+MacLearningTable::Resize(uint32_t numBuckets)
+{
+    NS_LOG_FUNCTION(this << numBuckets);
+    std::vector<Entry> old;
+    old.swap(m_entries);
+    m_entries.assign(numBuckets, Entry{0, 0, 0, 0});
+    m_mask = numBuckets - 1;
+    m_capacity = numBuckets - numBuckets / 4;
+    m_size = 0;
+    for (const auto& entry : old)
+    {
+        if (entry.key != 0)
+        {
+            uint32_t index = Hash(entry.key);
+            while (m_entries[index].key != 0)
+            {
+                index = (index + 1) & m_mask;
+            }
+            m_entries[index] = entry;
+            m_size++;
+        }
+    }
+}
+
+uint32_t
+MacLearningTable::WheelSlotFor(int64_t expiration) const
+{
+    // Rounded up, so that a slot is only processed once all its entries have expired
+    int64_t tick = (expiration + m_tick - 1) / m_tick;
+    return static_cast<uint32_t>(tick % static_cast<int64_t>(m_wheel.size()));
+}
+
+void
+MacLearningTable::AdvanceWheel(int64_t now)
+{
+    int64_t nowTick = now / m_tick;
+    if (nowTick <= m_wheelTick)
+    {
+        return;
+    }
+    int64_t numSlots = m_wheel.size();
+    int64_t first = m_wheelTick + 1;
+    if (nowTick - m_wheelTick >= numSlots)
+    {
+        // Idle for a full revolution: every slot is visited exactly once
+        first = nowTick - numSlots + 1;
+    }
+    for (int64_t tick = first; tick <= nowTick; tick++)
+    {
+        ExpireSlot(static_cast<uint32_t>(tick % numSlots), now);
+    }
+    m_wheelTick = nowTick;
+}
+
+void
+MacLearningTable::ExpireSlot(uint32_t slot, int64_t now)
+{
+    std::vector<uint64_t>& keys = m_wheel[slot];
+    size_t kept = 0;
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        uint32_t index = Find(keys[i]);
+        if (index == NOT_FOUND || m_entries[index].wheelSlot != slot)
+        {
+            // Entry already gone, or refreshed into a later slot
+            continue;
+        }
+        if (m_entries[index].expiration <= now)
+        {
+            Erase(index);
+            m_evictions++;
+            continue;
+        }
+        keys[kept++] = keys[i];
+    }
+    keys.resize(kept);
+}
+
+void
+MacLearningTable::RebuildWheel()
+{
+    m_tick = std::max<int64_t>(1, m_expiration / static_cast<int64_t>(m_wheel.size()));
+    m_wheelTick = Simulator::Now().GetTimeStep() / m_tick;
+    for (auto& keys : m_wheel)
+    {
+        keys.clear();
+    }
+    for (auto& entry : m_entries)
+    {
+        if (entry.key != 0)
+        {
+            entry.wheelSlot = WheelSlotFor(entry.expiration);
+            m_wheel[entry.wheelSlot].push_back(entry.key);
+        }
+    }
+}
+
+} // namespace ns3
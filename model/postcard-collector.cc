@@ -0,0 +1,114 @@
+#include "postcard-collector.h"
+
+#include "ns3/log.h"
+
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::PostcardCollector implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("PostcardCollector");
+
+NS_OBJECT_ENSURE_REGISTERED(PostcardCollector);
+
+TypeId
+PostcardCollector::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::PostcardCollector")
+                            .SetParent<Application>()
+                            .SetGroupName("Applications")
+                            .AddConstructor<PostcardCollector>();
+    return tid;
+}
+
+PostcardCollector::PostcardCollector()
+    : m_batches(0),
+      m_bytes(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+PostcardCollector::~PostcardCollector()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+PostcardCollector::ReceiveBatch(uint32_t reporterId, std::vector<PostcardRecord> records)
+{
+    NS_LOG_FUNCTION(this << reporterId << records.size());
+    m_batches++;
+    m_bytes += records.size() * PostcardRecord::SIZE;
+    m_reporterRecords[reporterId] += records.size();
+    for (const auto& record : records)
+    {
+        auto it = m_sliceStats.find(record.dscp);
+        if (it == m_sliceStats.end())
+        {
+            it = m_sliceStats.emplace(record.dscp, PostcardSliceStats()).first;
+        }
+        PostcardSliceStats& stats = it->second;
+        int64_t residence = record.egressTime - record.ingressTime;
+        stats.records++;
+        stats.flagged += record.flagged;
+        stats.totalResidence += residence;
+        stats.maxResidence = std::max(stats.maxResidence, residence);
+        stats.totalQueueDepth += record.queueDepth;
+        stats.maxQueueDepth = std::max(stats.maxQueueDepth, record.queueDepth);
+    }
+}
+
+std::map<uint8_t, PostcardSliceStats>
+PostcardCollector::GetSliceStats() const
+{
+    return m_sliceStats;
+}
+
+std::map<uint32_t, uint64_t>
+PostcardCollector::GetReporterRecords() const
+{
+    return m_reporterRecords;
+}
+
+uint64_t
+PostcardCollector::GetBatchesReceived() const
+{
+    return m_batches;
+}
+
+uint64_t
+PostcardCollector::GetBytesReceived() const
+{
+    return m_bytes;
+}
+
+void
+PostcardCollector::StartApplication()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+PostcardCollector::StopApplication()
+{
+    NS_LOG_FUNCTION(this);
+    NS_LOG_INFO("Postcards: " << m_batches << " batches, " << m_bytes << " bytes from "
+                              << m_reporterRecords.size() << " reporters");
+    for (const auto& [dscp, stats] : m_sliceStats)
+    {
+        NS_LOG_INFO("  DSCP " << +dscp << ": " << stats.records << " records, " << stats.flagged
+                              << " flagged, mean residence "
+                              << stats.totalResidence / static_cast<double>(stats.records)
+                              << " ns, max " << stats.maxResidence << " ns, mean queue "
+                              << stats.totalQueueDepth / static_cast<double>(stats.records)
+                              << ", max " << stats.maxQueueDepth);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,84 @@
+#ifndef POSTCARD_COLLECTOR_H
+#define POSTCARD_COLLECTOR_H
+
+#include "postcard-exporter.h"
+
+#include "ns3/application.h"
+
+#include <map>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::PostcardCollector declaration.
+ */
+
+namespace ns3
+{
+
+/// Aggregated postcard statistics of one slice
+struct PostcardSliceStats
+{
+    uint64_t records;         //!< postcards received
+    uint64_t flagged;         //!< postcards flagged by a queue threshold
+    int64_t totalResidence;   //!< sum of the hop residence times, in ns
+    int64_t maxResidence;     //!< largest hop residence time, in ns
+    uint64_t totalQueueDepth; //!< sum of the reported queue depths, in packets
+    uint32_t maxQueueDepth;   //!< largest reported queue depth, in packets
+};
+
+/**
+ * \ingroup bridge
+ * \brief Receives postcard batches and aggregates them per slice
+ *
+ * The collector is installed on a designated node and fed by the
+ * PostcardExporter instances of the switches and queue discs. Records are
+ * folded into per-slice (DSCP) and per-reporter statistics as the batches
+ * arrive, so memory does not grow with the number of postcards.
+ */
+class PostcardCollector : public Application
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    PostcardCollector();
+    ~PostcardCollector() override;
+
+    /**
+     * \brief Aggregates a batch of postcards
+     * \param reporterId the identifier of the exporter
+     * \param records the records of the batch
+     */
+    void ReceiveBatch(uint32_t reporterId, std::vector<PostcardRecord> records);
+
+    /// \returns the statistics of each slice, by DSCP
+    std::map<uint8_t, PostcardSliceStats> GetSliceStats() const;
+
+    /// \returns the number of records received from each reporter
+    std::map<uint32_t, uint64_t> GetReporterRecords() const;
+
+    /// \returns the number of batches received
+    uint64_t GetBatchesReceived() const;
+
+    /// \returns the number of report bytes received
+    uint64_t GetBytesReceived() const;
+
+  private:
+    void StartApplication() override;
+    void StopApplication() override;
+
+    std::map<uint8_t, PostcardSliceStats> m_sliceStats; //!< statistics by DSCP
+    std::map<uint32_t, uint64_t> m_reporterRecords;     //!< records by reporter
+    uint64_t m_batches;                                 //!< batches received
+    uint64_t m_bytes;                                   //!< report bytes received
+};
+
+} // namespace ns3
+
+#endif /* POSTCARD_COLLECTOR_H */
@@ -0,0 +1,170 @@
+#include "postcard-exporter.h"
+
+#include "flow-key.h"
+#include "postcard-collector.h"
+
+#include "ns3/log.h"
+#include "ns3/pointer.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::PostcardExporter implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("PostcardExporter");
+
+NS_OBJECT_ENSURE_REGISTERED(PostcardExporter);
+
+TypeId
+PostcardExporter::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::PostcardExporter")
+            .SetParent<Object>()
+            .SetGroupName("Bridge")
+            .AddConstructor<PostcardExporter>()
+            .AddAttribute("Collector",
+                          "The collector receiving the postcards.",
+                          PointerValue(),
+                          MakePointerAccessor(&PostcardExporter::m_collector),
+                          MakePointerChecker<PostcardCollector>())
+            .AddAttribute("ReporterId",
+                          "Identifier sent with each batch, e.g. the node id.",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&PostcardExporter::m_reporterId),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("SamplingRate",
+                          "Report one packet in N (chosen by packet UID); 0 disables sampling.",
+                          UintegerValue(100),
+                          MakeUintegerAccessor(&PostcardExporter::m_samplingRate),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("QueueThreshold",
+                          "Report every packet that sees at least this many queued packets; "
+                          "0 disables flagging.",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&PostcardExporter::m_queueThreshold),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("Interval",
+                          "Records are coalesced into one batch per interval.",
+                          TimeValue(MilliSeconds(10)),
+                          MakeTimeAccessor(&PostcardExporter::m_interval),
+                          MakeTimeChecker())
+            .AddAttribute("ReportDelay",
+                          "Time for a batch to reach the collector.",
+                          TimeValue(MicroSeconds(100)),
+                          MakeTimeAccessor(&PostcardExporter::m_reportDelay),
+                          MakeTimeChecker())
+            .AddAttribute("MaxRecordsPerInterval",
+                          "Records sent per interval; further records are discarded.",
+                          UintegerValue(256),
+                          MakeUintegerAccessor(&PostcardExporter::m_maxRecords),
+                          MakeUintegerChecker<uint32_t>(1));
+    return tid;
+}
+
+PostcardExporter::PostcardExporter()
+    : m_reporterId(0),
+      m_samplingRate(100),
+      m_queueThreshold(0),
+      m_maxRecords(256),
+      m_flushPending(false),
+      m_exported(0),
+      m_discarded(0),
+      m_batches(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+PostcardExporter::~PostcardExporter()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+PostcardExporter::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_collector = nullptr;
+    m_buffer.clear();
+    Object::DoDispose();
+}
+
+uint8_t
+PostcardExporter::Select(uint64_t packetUid, uint32_t queueDepth) const
+{
+    if (m_queueThreshold && queueDepth >= m_queueThreshold)
+    {
+        return 2;
+    }
+    if (m_samplingRate && FlowKey::Mix(packetUid) % m_samplingRate == 0)
+    {
+        return 1;
+    }
+    return 0;
+}
+
+void
+PostcardExporter::Report(const PostcardRecord& record)
+{
+    if (!m_collector)
+    {
+        return;
+    }
+    if (m_buffer.size() >= m_maxRecords)
+    {
+        m_discarded++;
+        return;
+    }
+    m_buffer.push_back(record);
+    m_exported++;
+    if (!m_flushPending)
+    {
+        m_flushPending = true;
+        Simulator::Schedule(m_interval, &PostcardExporter::Flush, this);
+    }
+}
+
+void
+PostcardExporter::Flush()
+{
+    NS_LOG_FUNCTION(this << m_buffer.size());
+    m_flushPending = false;
+    if (m_buffer.empty() || !m_collector)
+    {
+        return;
+    }
+    std::vector<PostcardRecord> batch;
+    batch.swap(m_buffer);
+    m_batches++;
+    Simulator::Schedule(m_reportDelay,
+                        &PostcardCollector::ReceiveBatch,
+                        m_collector,
+                        m_reporterId,
+                        batch);
+}
+
+uint64_t
+PostcardExporter::GetRecordsExported() const
+{
+    return m_exported;
+}
+
+uint64_t
+PostcardExporter::GetRecordsDiscarded() const
+{
+    return m_discarded;
+}
+
+uint64_t
+PostcardExporter::GetBatchesSent() const
+{
+    return m_batches;
+}
+
+} // namespace ns3
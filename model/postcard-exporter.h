@@ -0,0 +1,114 @@
+#ifndef POSTCARD_EXPORTER_H
+#define POSTCARD_EXPORTER_H
+
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::PostcardExporter declaration.
+ */
+
+namespace ns3
+{
+
+class PostcardCollector;
+
+/**
+ * \ingroup bridge
+ * \brief Telemetry report about one packet at one hop
+ *
+ * Postcards are the out-of-band alternative to the INT stack of the
+ * SlicescopeHeader: packets keep their size, and every hop that samples a
+ * packet reports it to a collector instead.
+ */
+struct PostcardRecord
+{
+    static constexpr uint32_t SIZE = 32; //!< size of a record on the wire
+
+    uint64_t flowHash;   //!< hash of the packet 5-tuple
+    int64_t ingressTime; //!< time the packet entered the hop, in ns
+    int64_t egressTime;  //!< time the packet left the hop, in ns
+    uint32_t queueDepth; //!< packets queued at the hop when the packet left
+    uint16_t hop;        //!< identifier of the reporting switch or node
+    uint8_t dscp;        //!< DSCP of the packet, i.e. its slice
+    uint8_t flagged;     //!< 1 if reported because of the queue threshold
+};
+
+/**
+ * \ingroup bridge
+ * \brief Samples packets at one hop and sends postcards to a collector
+ *
+ * A packet is reported when its UID falls in the 1-in-SamplingRate sample
+ * (the same packets are sampled at every hop, so their paths can be
+ * rebuilt), or when the queue depth at the hop reaches the threshold.
+ *
+ * Records are coalesced: the first record of an interval arms one flush
+ * event, which sends the whole batch to the collector after the report
+ * delay. At most MaxRecordsPerInterval records are sent per interval, so
+ * the collector load is bounded whatever the traffic; the others are
+ * counted and discarded. No event is scheduled while nothing is sampled.
+ */
+class PostcardExporter : public Object
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    PostcardExporter();
+    ~PostcardExporter() override;
+
+    /**
+     * \brief Tells whether a packet must be reported
+     * \param packetUid the packet UID
+     * \param queueDepth the queue depth the packet sees at this hop
+     * \returns 0 if not, 1 if sampled, 2 if flagged by the queue threshold
+     */
+    uint8_t Select(uint64_t packetUid, uint32_t queueDepth) const;
+
+    /**
+     * \brief Queues a record for the next batch
+     * \param record the record
+     */
+    void Report(const PostcardRecord& record);
+
+    /// \returns the number of records queued for a batch
+    uint64_t GetRecordsExported() const;
+
+    /// \returns the number of records discarded by the per-interval limit
+    uint64_t GetRecordsDiscarded() const;
+
+    /// \returns the number of batches sent to the collector
+    uint64_t GetBatchesSent() const;
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    /// Sends the current batch to the collector
+    void Flush();
+
+    Ptr<PostcardCollector> m_collector;   //!< collector receiving the batches
+    uint32_t m_reporterId;                //!< identifier sent with the batches
+    uint32_t m_samplingRate;              //!< report 1 packet in N, 0 to disable
+    uint32_t m_queueThreshold;            //!< queue depth that flags a packet, 0 to disable
+    Time m_interval;                      //!< coalescing interval
+    Time m_reportDelay;                   //!< delay for a batch to reach the collector
+    uint32_t m_maxRecords;                //!< records sent per interval
+    std::vector<PostcardRecord> m_buffer; //!< records of the current interval
+    bool m_flushPending;                  //!< true if a flush event is scheduled
+    uint64_t m_exported;                  //!< records queued for a batch
+    uint64_t m_discarded;                 //!< records over the per-interval limit
+    uint64_t m_batches;                   //!< batches sent
+};
+
+} // namespace ns3
+
+#endif /* POSTCARD_EXPORTER_H */
@@ -0,0 +1,219 @@
+#include "sflow-agent.h"
+
+#include "sflow-collector.h"
+
+#include "ns3/log.h"
+#include "ns3/pointer.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::SflowAgent implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("SflowAgent");
+
+NS_OBJECT_ENSURE_REGISTERED(SflowAgent);
+
+uint32_t
+SflowDatagram::GetSize() const
+{
+    return HEADER_SIZE + flowSamples.size() * SflowFlowSample::SIZE +
+           counterSamples.size() * SflowCounterSample::SIZE;
+}
+
+TypeId
+SflowAgent::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::SflowAgent")
+            .SetParent<Object>()
+            .SetGroupName("Bridge")
+            .AddConstructor<SflowAgent>()
+            .AddAttribute("Collector",
+                          "The collector receiving the datagrams.",
+                          PointerValue(),
+                          MakePointerAccessor(&SflowAgent::m_collector),
+                          MakePointerChecker<SflowCollector>())
+            .AddAttribute("AgentId",
+                          "Identifier sent with each datagram, e.g. the node id.",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&SflowAgent::m_agentId),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("SamplingRate",
+                          "Sample one frame in N on average, on each port.",
+                          UintegerValue(1000),
+                          MakeUintegerAccessor(&SflowAgent::m_samplingRate),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("PollingInterval",
+                          "Minimum time between two polls of the port counters; 0 disables "
+                          "counter polling.",
+                          TimeValue(Seconds(1)),
+                          MakeTimeAccessor(&SflowAgent::m_pollingInterval),
+                          MakeTimeChecker())
+            .AddAttribute("MaxSamplesPerDatagram",
+                          "Flow and counter samples after which a datagram is sent.",
+                          UintegerValue(32),
+                          MakeUintegerAccessor(&SflowAgent::m_maxSamples),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("FlushInterval",
+                          "Time after its first sample at which a partial datagram is sent.",
+                          TimeValue(MilliSeconds(100)),
+                          MakeTimeAccessor(&SflowAgent::m_flushInterval),
+                          MakeTimeChecker())
+            .AddAttribute("ReportDelay",
+                          "Time for a datagram to reach the collector, through a scheduled "
+                          "call rather than the network.",
+                          TimeValue(MicroSeconds(100)),
+                          MakeTimeAccessor(&SflowAgent::m_reportDelay),
+                          MakeTimeChecker());
+    return tid;
+}
+
+SflowAgent::SflowAgent()
+    : m_agentId(0),
+      m_samplingRate(1000),
+      m_maxSamples(32),
+      m_nextPoll(Seconds(0)),
+      m_samples(0),
+      m_datagrams(0)
+{
+    NS_LOG_FUNCTION(this);
+    m_skipRng = CreateObject<UniformRandomVariable>();
+}
+
+SflowAgent::~SflowAgent()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+SflowAgent::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_flushEvent.Cancel();
+    m_collector = nullptr;
+    m_skipRng = nullptr;
+    m_skip.clear();
+    m_pool.clear();
+    Object::DoDispose();
+}
+
+int64_t
+SflowAgent::AssignStreams(int64_t stream)
+{
+    NS_LOG_FUNCTION(this << stream);
+    m_skipRng->SetStream(stream);
+    return 1;
+}
+
+uint32_t
+SflowAgent::NextSkip()
+{
+    return m_skipRng->GetInteger(1, 2 * m_samplingRate - 1);
+}
+
+bool
+SflowAgent::Sample(uint32_t port)
+{
+    if (!m_collector)
+    {
+        return false;
+    }
+    if (port >= m_skip.size())
+    {
+        m_pool.resize(port + 1, 0);
+        while (m_skip.size() <= port)
+        {
+            m_skip.push_back(NextSkip());
+        }
+    }
+    m_pool[port]++;
+    if (--m_skip[port])
+    {
+        return false;
+    }
+    m_skip[port] = NextSkip();
+    return true;
+}
+
+void
+SflowAgent::ReportFlowSample(SflowFlowSample sample)
+{
+    sample.samplingRate = m_samplingRate;
+    sample.samplePool = sample.inputPort < m_pool.size() ? m_pool[sample.inputPort] : 0;
+    m_datagram.flowSamples.push_back(sample);
+    m_samples++;
+    Enqueue();
+}
+
+bool
+SflowAgent::IsPollDue() const
+{
+    return m_pollingInterval.IsStrictlyPositive() && Simulator::Now() >= m_nextPoll;
+}
+
+void
+SflowAgent::ReportCounters(const std::vector<SflowCounterSample>& counters)
+{
+    NS_LOG_FUNCTION(this << counters.size());
+    m_nextPoll = Simulator::Now() + m_pollingInterval;
+    m_datagram.counterSamples.insert(m_datagram.counterSamples.end(),
+                                     counters.begin(),
+                                     counters.end());
+    Enqueue();
+}
+
+void
+SflowAgent::Enqueue()
+{
+    if (m_datagram.flowSamples.size() + m_datagram.counterSamples.size() >= m_maxSamples)
+    {
+        m_flushEvent.Cancel();
+        Flush();
+    }
+    else if (m_flushEvent.IsExpired())
+    {
+        m_flushEvent = Simulator::Schedule(m_flushInterval, &SflowAgent::Flush, this);
+    }
+}
+
+void
+SflowAgent::Flush()
+{
+    NS_LOG_FUNCTION(this << m_datagram.flowSamples.size() << m_datagram.counterSamples.size());
+    if (!m_collector ||
+        (m_datagram.flowSamples.empty() && m_datagram.counterSamples.empty()))
+    {
+        return;
+    }
+    SflowDatagram datagram;
+    datagram.agentId = m_agentId;
+    datagram.sequence = m_datagrams++;
+    datagram.uptime = Simulator::Now().GetNanoSeconds();
+    datagram.flowSamples.swap(m_datagram.flowSamples);
+    datagram.counterSamples.swap(m_datagram.counterSamples);
+    Simulator::Schedule(m_reportDelay,
+                        &SflowCollector::ReceiveDatagram,
+                        m_collector,
+                        datagram);
+}
+
+uint64_t
+SflowAgent::GetSamplesTaken() const
+{
+    return m_samples;
+}
+
+uint64_t
+SflowAgent::GetDatagramsSent() const
+{
+    return m_datagrams;
+}
+
+} // namespace ns3
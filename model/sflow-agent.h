@@ -0,0 +1,186 @@
+#ifndef SFLOW_AGENT_H
+#define SFLOW_AGENT_H
+
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/random-variable-stream.h"
+
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::SflowAgent declaration.
+ */
+
+namespace ns3
+{
+
+class SflowCollector;
+
+/**
+ * \ingroup bridge
+ * \brief Header fields of one sampled frame
+ */
+struct SflowFlowSample
+{
+    static constexpr uint32_t SIZE = 40; //!< size of a flow sample on the wire
+
+    uint32_t srcAddress;   //!< IPv4 source address, 0 for other protocols
+    uint32_t dstAddress;   //!< IPv4 destination address, 0 for other protocols
+    uint16_t srcPort;      //!< UDP/TCP source port
+    uint16_t dstPort;      //!< UDP/TCP destination port
+    uint16_t etherType;    //!< protocol of the frame
+    uint8_t protocol;      //!< IPv4 protocol number
+    uint8_t dscp;          //!< DSCP of the frame, i.e. its slice
+    uint32_t inputPort;    //!< port the frame was received on
+    uint8_t edge;          //!< 1 if the input port is an edge port
+    uint32_t frameLength;  //!< size of the frame
+    uint32_t samplingRate; //!< 1-in-N rate the frame was sampled with
+    uint64_t samplePool;   //!< frames seen on the input port so far
+};
+
+/**
+ * \ingroup bridge
+ * \brief Cumulative counters of one port
+ */
+struct SflowCounterSample
+{
+    static constexpr uint32_t SIZE = 48; //!< size of a counter sample on the wire
+
+    uint32_t port;      //!< port index
+    uint64_t rxPackets; //!< frames received
+    uint64_t rxBytes;   //!< bytes received
+    uint64_t txPackets; //!< frames transmitted
+    uint64_t txBytes;   //!< bytes transmitted
+    uint64_t drops;     //!< received frames dropped, all reasons
+};
+
+/**
+ * \ingroup bridge
+ * \brief Samples sent by an agent in one datagram
+ */
+struct SflowDatagram
+{
+    static constexpr uint32_t HEADER_SIZE = 28; //!< size of the datagram header
+
+    uint32_t agentId;                               //!< identifier of the agent
+    uint32_t sequence;                              //!< datagram number, from 0
+    int64_t uptime;                                 //!< time the datagram was sent, in ns
+    std::vector<SflowFlowSample> flowSamples;       //!< flow samples
+    std::vector<SflowCounterSample> counterSamples; //!< counter samples
+
+    /// \returns the size of the datagram on the wire
+    uint32_t GetSize() const;
+};
+
+/**
+ * \ingroup bridge
+ * \brief sFlow-style sampling agent of a switch
+ *
+ * Every port samples one frame in SamplingRate on average: a countdown per
+ * port is drawn uniformly in [1, 2 * SamplingRate - 1] after each sample,
+ * so that periodic traffic cannot alias with the sampling. Sampled headers
+ * are batched into datagrams, sent to the collector when
+ * MaxSamplesPerDatagram samples are queued or FlushInterval after the first
+ * one.
+ *
+ * Port counters are polled with the samples: the first sample taken once
+ * PollingInterval has elapsed since the last poll carries the counters of
+ * every port. Counters are cumulative, so a late poll loses nothing. The
+ * per-frame cost is one countdown, and the number of events and datagrams
+ * grows with the number of samples, not with the number of frames.
+ *
+ * Datagrams are not sent over UDP: the switches are L2 devices with no IP
+ * stack, so a datagram reaches the SflowCollector through a call scheduled
+ * ReportDelay after the flush, as postcards do. The export traffic thus
+ * takes no link capacity and is never lost; GetSize gives the bytes it
+ * would take on the wire, for accounting its overhead.
+ */
+class SflowAgent : public Object
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    SflowAgent();
+    ~SflowAgent() override;
+
+    /**
+     * \brief Counts a frame received on a port, and tells whether to sample it
+     * \param port the port index
+     * \returns true if the frame must be sampled
+     */
+    bool Sample(uint32_t port);
+
+    /**
+     * \brief Queues a flow sample for the next datagram
+     * \param sample the sample; its rate and sample pool are filled in here
+     */
+    void ReportFlowSample(SflowFlowSample sample);
+
+    /// \returns true if the port counters must be polled
+    bool IsPollDue() const;
+
+    /**
+     * \brief Queues the port counters for the next datagram
+     * \param counters the counters of every port
+     */
+    void ReportCounters(const std::vector<SflowCounterSample>& counters);
+
+    /**
+     * Assign a fixed random variable stream number to the random variables
+     * used by this model.
+     *
+     * \param stream first stream index to use
+     * \return the number of stream indices assigned by this model
+     */
+    int64_t AssignStreams(int64_t stream);
+
+    /// \returns the number of flow samples taken
+    uint64_t GetSamplesTaken() const;
+
+    /// \returns the number of datagrams sent to the collector
+    uint64_t GetDatagramsSent() const;
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    /**
+     * \brief Draws the number of frames until the next sample
+     * \returns the countdown
+     */
+    uint32_t NextSkip();
+
+    /// Queues the datagram for sending, or sends it if it is full
+    void Enqueue();
+
+    /// Sends the current datagram to the collector
+    void Flush();
+
+    Ptr<SflowCollector> m_collector;      //!< collector receiving the datagrams
+    uint32_t m_agentId;                   //!< identifier sent with the datagrams
+    uint32_t m_samplingRate;              //!< sample 1 frame in N per port
+    Time m_pollingInterval;               //!< counter polling period, 0 to disable
+    uint32_t m_maxSamples;                //!< samples per datagram
+    Time m_flushInterval;                 //!< delay before a partial datagram is sent
+    Time m_reportDelay;                   //!< delay for a datagram to reach the collector
+    Ptr<UniformRandomVariable> m_skipRng; //!< countdown draws
+    std::vector<uint32_t> m_skip;         //!< frames until the next sample, per port
+    std::vector<uint64_t> m_pool;         //!< frames seen, per port
+    Time m_nextPoll;                      //!< earliest time of the next counter poll
+    SflowDatagram m_datagram;             //!< datagram being filled
+    EventId m_flushEvent;                 //!< flush of the current datagram
+    uint64_t m_samples;                   //!< flow samples taken
+    uint64_t m_datagrams;                 //!< datagrams sent
+};
+
+} // namespace ns3
+
+#endif /* SFLOW_AGENT_H */
@@ -0,0 +1,168 @@
+#include "sflow-collector.h"
+
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/log.h"
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::SflowCollector implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("SflowCollector");
+
+NS_OBJECT_ENSURE_REGISTERED(SflowCollector);
+
+TypeId
+SflowCollector::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::SflowCollector")
+                            .SetParent<Application>()
+                            .SetGroupName("Applications")
+                            .AddConstructor<SflowCollector>();
+    return tid;
+}
+
+SflowCollector::SflowCollector()
+    : m_datagrams(0),
+      m_lost(0),
+      m_flowSamples(0),
+      m_bytes(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+SflowCollector::~SflowCollector()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+SflowCollector::ReceiveDatagram(SflowDatagram datagram)
+{
+    NS_LOG_FUNCTION(this << datagram.agentId << datagram.sequence);
+    m_datagrams++;
+    m_bytes += datagram.GetSize();
+
+    auto seq = m_nextSequence.find(datagram.agentId);
+    if (seq == m_nextSequence.end())
+    {
+        seq = m_nextSequence.emplace(datagram.agentId, 0).first;
+    }
+    if (datagram.sequence > seq->second)
+    {
+        m_lost += datagram.sequence - seq->second;
+    }
+    seq->second = datagram.sequence + 1;
+
+    for (const auto& sample : datagram.flowSamples)
+    {
+        m_flowSamples++;
+        if (!sample.edge || sample.etherType != Ipv4L3Protocol::PROT_NUMBER)
+        {
+            continue;
+        }
+        // Unknown code points are served as eMBB, as in CustomQueueDisc
+        Slice::SliceType sliceType = Slice::eMBB;
+        auto it = Slice::dscpToSliceTypeMap.find(sample.dscp);
+        if (it != Slice::dscpToSliceTypeMap.end())
+        {
+            sliceType = it->second;
+        }
+        std::pair<Ipv4Address, Ipv4Address> hosts(Ipv4Address(sample.srcAddress),
+                                                  Ipv4Address(sample.dstAddress));
+        SflowTrafficEstimate& estimate = m_matrices[sliceType][hosts];
+        estimate.samples++;
+        estimate.packets += sample.samplingRate;
+        estimate.bytes += static_cast<uint64_t>(sample.frameLength) * sample.samplingRate;
+    }
+
+    if (!datagram.counterSamples.empty())
+    {
+        std::vector<SflowCounterSample>& counters = m_portCounters[datagram.agentId];
+        for (const auto& sample : datagram.counterSamples)
+        {
+            if (sample.port >= counters.size())
+            {
+                counters.resize(sample.port + 1, SflowCounterSample());
+            }
+            counters[sample.port] = sample;
+        }
+    }
+}
+
+SflowCollector::TrafficMatrix
+SflowCollector::GetTrafficMatrix(Slice::SliceType sliceType) const
+{
+    auto it = m_matrices.find(sliceType);
+    if (it == m_matrices.end())
+    {
+        return TrafficMatrix();
+    }
+    return it->second;
+}
+
+std::vector<SflowCounterSample>
+SflowCollector::GetPortCounters(uint32_t agentId) const
+{
+    auto it = m_portCounters.find(agentId);
+    if (it == m_portCounters.end())
+    {
+        return std::vector<SflowCounterSample>();
+    }
+    return it->second;
+}
+
+uint64_t
+SflowCollector::GetDatagramsReceived() const
+{
+    return m_datagrams;
+}
+
+uint64_t
+SflowCollector::GetDatagramsLost() const
+{
+    return m_lost;
+}
+
+uint64_t
+SflowCollector::GetFlowSamplesReceived() const
+{
+    return m_flowSamples;
+}
+
+uint64_t
+SflowCollector::GetBytesReceived() const
+{
+    return m_bytes;
+}
+
+void
+SflowCollector::StartApplication()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+SflowCollector::StopApplication()
+{
+    NS_LOG_FUNCTION(this);
+    NS_LOG_INFO("sFlow: " << m_datagrams << " datagrams (" << m_lost << " lost), " << m_bytes
+                          << " bytes, " << m_flowSamples << " flow samples from "
+                          << m_nextSequence.size() << " agents");
+    for (const auto& [sliceType, matrix] : m_matrices)
+    {
+        NS_LOG_INFO("  " << Slice::sliceTypeToStrMap.at(sliceType) << ":");
+        for (const auto& [hosts, estimate] : matrix)
+        {
+            NS_LOG_INFO("    " << hosts.first << " -> " << hosts.second << ": ~"
+                               << estimate.packets << " packets, ~" << estimate.bytes
+                               << " bytes (" << estimate.samples << " samples)");
+        }
+    }
+}
+
+} // namespace ns3
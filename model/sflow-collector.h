@@ -0,0 +1,107 @@
+#ifndef SFLOW_COLLECTOR_H
+#define SFLOW_COLLECTOR_H
+
+#include "sflow-agent.h"
+#include "slice.h"
+
+#include "ns3/application.h"
+#include "ns3/ipv4-address.h"
+
+#include <map>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::SflowCollector declaration.
+ */
+
+namespace ns3
+{
+
+/// Traffic between two hosts, scaled up from the samples
+struct SflowTrafficEstimate
+{
+    uint64_t samples; //!< flow samples received
+    uint64_t packets; //!< estimated frames
+    uint64_t bytes;   //!< estimated bytes
+};
+
+/**
+ * \ingroup bridge
+ * \brief Receives sFlow datagrams and decodes them into traffic matrices
+ *
+ * Each flow sample stands for SamplingRate frames of its kind. A frame is
+ * sampled by every switch it crosses, so the traffic matrices only count
+ * the samples taken on edge ports, where each frame enters the network
+ * once. The latest counters of each agent are kept, and gaps in the
+ * datagram sequence numbers are counted as lost datagrams.
+ *
+ * The agents hand the datagrams over directly rather than through a
+ * socket, see SflowAgent, so datagrams are only found lost when agents
+ * share an identifier; the bytes received are those they would take on
+ * the wire.
+ */
+class SflowCollector : public Application
+{
+  public:
+    /// Estimated traffic by (IPv4 source, IPv4 destination)
+    typedef std::map<std::pair<Ipv4Address, Ipv4Address>, SflowTrafficEstimate> TrafficMatrix;
+
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    SflowCollector();
+    ~SflowCollector() override;
+
+    /**
+     * \brief Decodes a datagram
+     * \param datagram the datagram
+     */
+    void ReceiveDatagram(SflowDatagram datagram);
+
+    /**
+     * \param sliceType the slice type
+     * \returns the estimated IPv4 traffic matrix of the slice
+     */
+    TrafficMatrix GetTrafficMatrix(Slice::SliceType sliceType) const;
+
+    /**
+     * \param agentId the identifier of the agent
+     * \returns the latest counters polled from each port of the agent
+     */
+    std::vector<SflowCounterSample> GetPortCounters(uint32_t agentId) const;
+
+    /// \returns the number of datagrams received
+    uint64_t GetDatagramsReceived() const;
+
+    /// \returns the number of datagrams missing from the sequence numbers
+    uint64_t GetDatagramsLost() const;
+
+    /// \returns the number of flow samples received
+    uint64_t GetFlowSamplesReceived() const;
+
+    /// \returns the number of datagram bytes received
+    uint64_t GetBytesReceived() const;
+
+  private:
+    void StartApplication() override;
+    void StopApplication() override;
+
+    std::map<Slice::SliceType, TrafficMatrix> m_matrices;               //!< matrices by slice
+    std::map<uint32_t, std::vector<SflowCounterSample>> m_portCounters; //!< counters by agent
+    std::map<uint32_t, uint32_t> m_nextSequence; //!< expected sequence number by agent
+    uint64_t m_datagrams;                        //!< datagrams received
+    uint64_t m_lost;                             //!< datagrams lost
+    uint64_t m_flowSamples;                      //!< flow samples received
+    uint64_t m_bytes;                            //!< datagram bytes received
+};
+
+} // namespace ns3
+
+#endif /* SFLOW_COLLECTOR_H */
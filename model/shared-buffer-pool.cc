@@ -0,0 +1,264 @@
+#include "shared-buffer-pool.h"
+
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::SharedBufferPool implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("SharedBufferPool");
+
+NS_OBJECT_ENSURE_REGISTERED(SharedBufferPool);
+
+TypeId
+SharedBufferPool::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::SharedBufferPool")
+            .SetParent<Object>()
+            .SetGroupName("Bridge")
+            .AddConstructor<SharedBufferPool>()
+            .AddAttribute("BufferSize",
+                          "Size of the buffer shared by the ports, in bytes.",
+                          UintegerValue(1000000),
+                          MakeUintegerAccessor(&SharedBufferPool::m_bufferSize),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("ReservedBytes",
+                          "Bytes guaranteed to each queue, outside of the shared part; a "
+                          "port keeps the value of the time it was added.",
+                          UintegerValue(3000),
+                          MakeUintegerAccessor(&SharedBufferPool::m_reservedBytes),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("Alpha",
+                          "Dynamic threshold factor of the queues that have no alpha of "
+                          "their own: a queue may hold Alpha times the free shared bytes.",
+                          DoubleValue(1.0),
+                          MakeDoubleAccessor(&SharedBufferPool::m_alpha),
+                          MakeDoubleChecker<double>(0))
+            .AddAttribute("PortAlpha",
+                          "Dynamic threshold factor of the ports: a port may hold PortAlpha "
+                          "times the free shared bytes; 0 disables the port threshold.",
+                          DoubleValue(0),
+                          MakeDoubleAccessor(&SharedBufferPool::m_portAlpha),
+                          MakeDoubleChecker<double>(0))
+            .AddAttribute("SampleInterval",
+                          "Period of the occupancy series; 0 disables it. No sample is "
+                          "taken while the buffer is empty.",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&SharedBufferPool::m_sampleInterval),
+                          MakeTimeChecker())
+            .AddTraceSource("Occupancy",
+                            "Bytes held by all the queues.",
+                            MakeTraceSourceAccessor(&SharedBufferPool::m_occupancy),
+                            "ns3::TracedValueCallback::Uint32")
+            .AddTraceSource("SharedOccupancy",
+                            "Bytes held in the shared part of the buffer.",
+                            MakeTraceSourceAccessor(&SharedBufferPool::m_shared),
+                            "ns3::TracedValueCallback::Uint32");
+    return tid;
+}
+
+SharedBufferPool::SharedBufferPool()
+    : m_bufferSize(1000000),
+      m_reservedBytes(3000),
+      m_alpha(1.0),
+      m_portAlpha(0),
+      m_reserved(0),
+      m_occupancy(0),
+      m_shared(0),
+      m_maxOccupancy(0),
+      m_samplePending(false)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+SharedBufferPool::~SharedBufferPool()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+uint32_t
+SharedBufferPool::AddPort(uint32_t nQueues)
+{
+    NS_LOG_FUNCTION(this << nQueues);
+    Port port;
+    port.queues.assign(nQueues, Queue{0, 0});
+    port.reserved = m_reservedBytes;
+    port.shared = 0;
+    m_ports.push_back(port);
+    m_reserved += nQueues * port.reserved;
+    if (m_reserved > m_bufferSize)
+    {
+        NS_LOG_WARN("Reserved bytes (" << m_reserved << ") exceed the buffer size ("
+                                       << m_bufferSize << ")");
+    }
+    return m_ports.size() - 1;
+}
+
+void
+SharedBufferPool::RemovePort(uint32_t port)
+{
+    NS_LOG_FUNCTION(this << port);
+    NS_ASSERT_MSG(port < m_ports.size(), "Unknown port " << port);
+    Port& p = m_ports[port];
+    for (const auto& q : p.queues)
+    {
+        NS_ASSERT_MSG(q.bytes == 0, "Removing port " << port << " while it holds packets");
+    }
+    m_reserved -= p.queues.size() * p.reserved;
+    p.queues.clear();
+}
+
+void
+SharedBufferPool::SetAlpha(uint32_t queue, double alpha)
+{
+    NS_LOG_FUNCTION(this << queue << alpha);
+    if (queue >= m_alphas.size())
+    {
+        m_alphas.resize(queue + 1, -1);
+    }
+    m_alphas[queue] = alpha;
+}
+
+double
+SharedBufferPool::GetAlpha(uint32_t queue) const
+{
+    return queue < m_alphas.size() && m_alphas[queue] >= 0 ? m_alphas[queue] : m_alpha;
+}
+
+uint32_t
+SharedBufferPool::GetSharedSize() const
+{
+    return m_reserved < m_bufferSize ? m_bufferSize - m_reserved : 0;
+}
+
+uint32_t
+SharedBufferPool::GetThreshold(uint32_t queue) const
+{
+    return GetAlpha(queue) * GetSharedFree();
+}
+
+uint32_t
+SharedBufferPool::GetSharedFree() const
+{
+    // Ports added while the buffer is in use may shrink the shared part below its occupancy
+    uint32_t size = GetSharedSize();
+    return size > m_shared ? size - m_shared : 0;
+}
+
+bool
+SharedBufferPool::Admit(uint32_t port, uint32_t queue, uint32_t bytes)
+{
+    NS_ASSERT_MSG(port < m_ports.size() && queue < m_ports[port].queues.size(),
+                  "Unknown queue " << queue << " of port " << port);
+    Port& p = m_ports[port];
+    Queue& q = p.queues[queue];
+
+    // Only the bytes above the reserved part of the queue are shared
+    uint32_t before = q.bytes > p.reserved ? q.bytes - p.reserved : 0;
+    uint32_t after = q.bytes + bytes > p.reserved ? q.bytes + bytes - p.reserved : 0;
+    uint32_t fromShared = after - before;
+    if (fromShared)
+    {
+        uint32_t free = GetSharedFree();
+        if (fromShared > free || after > GetThreshold(queue) ||
+            (m_portAlpha > 0 && p.shared + fromShared > m_portAlpha * free))
+        {
+            q.drops++;
+            return false;
+        }
+    }
+
+    q.bytes += bytes;
+    p.shared += fromShared;
+    m_shared += fromShared;
+    m_occupancy += bytes;
+    m_maxOccupancy = std::max<uint32_t>(m_maxOccupancy, m_occupancy);
+    if (!m_samplePending && m_sampleInterval.IsStrictlyPositive())
+    {
+        m_samplePending = true;
+        Simulator::ScheduleNow(&SharedBufferPool::SampleOccupancy, this);
+    }
+    return true;
+}
+
+void
+SharedBufferPool::Release(uint32_t port, uint32_t queue, uint32_t bytes)
+{
+    Port& p = m_ports[port];
+    Queue& q = p.queues[queue];
+    NS_ASSERT_MSG(q.bytes >= bytes, "Releasing more bytes than queue " << queue << " holds");
+    uint32_t before = q.bytes > p.reserved ? q.bytes - p.reserved : 0;
+    q.bytes -= bytes;
+    uint32_t after = q.bytes > p.reserved ? q.bytes - p.reserved : 0;
+    p.shared -= before - after;
+    m_shared -= before - after;
+    m_occupancy -= bytes;
+}
+
+void
+SharedBufferPool::SampleOccupancy()
+{
+    m_series.emplace_back(Simulator::Now(), m_occupancy);
+    if (m_occupancy == 0)
+    {
+        m_samplePending = false;
+        return;
+    }
+    Simulator::Schedule(m_sampleInterval, &SharedBufferPool::SampleOccupancy, this);
+}
+
+uint32_t
+SharedBufferPool::GetBufferSize() const
+{
+    return m_bufferSize;
+}
+
+uint32_t
+SharedBufferPool::GetOccupancy() const
+{
+    return m_occupancy;
+}
+
+uint32_t
+SharedBufferPool::GetSharedOccupancy() const
+{
+    return m_shared;
+}
+
+uint32_t
+SharedBufferPool::GetMaxOccupancy() const
+{
+    return m_maxOccupancy;
+}
+
+uint32_t
+SharedBufferPool::GetQueueBytes(uint32_t port, uint32_t queue) const
+{
+    return m_ports.at(port).queues.at(queue).bytes;
+}
+
+uint64_t
+SharedBufferPool::GetDrops(uint32_t port, uint32_t queue) const
+{
+    return m_ports.at(port).queues.at(queue).drops;
+}
+
+std::vector<std::pair<Time, uint32_t>>
+SharedBufferPool::GetOccupancySeries() const
+{
+    return m_series;
+}
+
+} // namespace ns3
@@ -0,0 +1,176 @@
+#ifndef SHARED_BUFFER_POOL_H
+#define SHARED_BUFFER_POOL_H
+
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/traced-value.h"
+
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::SharedBufferPool declaration.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup bridge
+ * \brief Packet buffer shared by all the egress queues of a switch
+ *
+ * Every queue has ReservedBytes of its own, as set when its port was
+ * added; the rest of BufferSize is
+ * shared. A packet that does not fit in the reserved part of its queue is
+ * admitted with dynamic thresholds: the shared bytes of the queue must stay
+ * below Alpha times the free shared bytes, and, with a PortAlpha, the
+ * shared bytes of the port below PortAlpha times the free shared bytes. The
+ * thresholds shrink as the buffer fills, so a few congested queues cannot
+ * take all of it, while a single active queue can still use most of an
+ * otherwise idle buffer.
+ *
+ * Queues are indexed like the internal queues of CustomQueueDisc, and each
+ * slice queue index may have its own alpha (SetAlpha).
+ */
+class SharedBufferPool : public Object
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    SharedBufferPool();
+    ~SharedBufferPool() override;
+
+    /**
+     * \brief Registers a port and reserves the minimum of its queues
+     *
+     * The port keeps the ReservedBytes of the time it is added.
+     *
+     * \param nQueues number of queues of the port
+     * \returns the port index in the pool
+     */
+    uint32_t AddPort(uint32_t nQueues);
+
+    /**
+     * \brief Unregisters an empty port and frees its reserved bytes
+     *
+     * The indices of the other ports do not change.
+     *
+     * \param port the port index
+     */
+    void RemovePort(uint32_t port);
+
+    /**
+     * \brief Sets the dynamic threshold factor of a queue index on every port
+     * \param queue the queue index
+     * \param alpha the factor
+     */
+    void SetAlpha(uint32_t queue, double alpha);
+
+    /**
+     * \param queue the queue index
+     * \returns the dynamic threshold factor of the queue index, Alpha if it has none
+     */
+    double GetAlpha(uint32_t queue) const;
+
+    /**
+     * \brief Admits a packet in a queue and charges its bytes to the buffer
+     * \param port the port index
+     * \param queue the queue index
+     * \param bytes the packet size
+     * \returns false if the packet must be dropped
+     */
+    bool Admit(uint32_t port, uint32_t queue, uint32_t bytes);
+
+    /**
+     * \brief Returns the bytes of a packet that left a queue to the buffer
+     * \param port the port index
+     * \param queue the queue index
+     * \param bytes the packet size
+     */
+    void Release(uint32_t port, uint32_t queue, uint32_t bytes);
+
+    /// \returns the size of the buffer, in bytes
+    uint32_t GetBufferSize() const;
+
+    /// \returns the bytes held by all the queues
+    uint32_t GetOccupancy() const;
+
+    /// \returns the bytes held in the shared part of the buffer
+    uint32_t GetSharedOccupancy() const;
+
+    /// \returns the largest occupancy so far
+    uint32_t GetMaxOccupancy() const;
+
+    /**
+     * \param queue the queue index
+     * \returns the shared bytes a queue of this index may currently hold
+     */
+    uint32_t GetThreshold(uint32_t queue) const;
+
+    /**
+     * \param port the port index
+     * \param queue the queue index
+     * \returns the bytes held by the queue
+     */
+    uint32_t GetQueueBytes(uint32_t port, uint32_t queue) const;
+
+    /**
+     * \param port the port index
+     * \param queue the queue index
+     * \returns the packets refused to the queue
+     */
+    uint64_t GetDrops(uint32_t port, uint32_t queue) const;
+
+    /// \returns the occupancy sampled every SampleInterval while the buffer was not empty
+    std::vector<std::pair<Time, uint32_t>> GetOccupancySeries() const;
+
+  private:
+    /// One queue of a port
+    struct Queue
+    {
+        uint32_t bytes; //!< bytes held
+        uint64_t drops; //!< packets refused
+    };
+
+    /// One port
+    struct Port
+    {
+        std::vector<Queue> queues; //!< queues of the port, none once removed
+        uint32_t reserved;         //!< bytes reserved per queue
+        uint32_t shared;           //!< shared bytes held by the port
+    };
+
+    /// \returns the size of the shared part of the buffer
+    uint32_t GetSharedSize() const;
+
+    /// \returns the free bytes of the shared part of the buffer
+    uint32_t GetSharedFree() const;
+
+    /// Records the occupancy in the series, and reschedules while not empty
+    void SampleOccupancy();
+
+    uint32_t m_bufferSize;                           //!< buffer size
+    uint32_t m_reservedBytes;                        //!< bytes reserved per queue
+    double m_alpha;                                  //!< default threshold factor
+    double m_portAlpha;                              //!< port threshold factor, 0 for none
+    std::vector<double> m_alphas;                    //!< threshold factor by queue index
+    std::vector<Port> m_ports;                       //!< registered ports
+    uint32_t m_reserved;                             //!< bytes reserved by all the queues
+    TracedValue<uint32_t> m_occupancy;               //!< bytes held by all the queues
+    TracedValue<uint32_t> m_shared;                  //!< bytes held in the shared part
+    uint32_t m_maxOccupancy;                         //!< largest occupancy
+    Time m_sampleInterval;                           //!< series period, 0 to disable
+    bool m_samplePending;                            //!< true if a sample is scheduled
+    std::vector<std::pair<Time, uint32_t>> m_series; //!< sampled occupancy
+};
+
+} // namespace ns3
+
+#endif /* SHARED_BUFFER_POOL_H */
@@ -0,0 +1,351 @@
+#include "slice-aqm.h"
+
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::SliceAqm, ns3::CoDelAqm and ns3::PieAqm implementations.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("SliceAqm");
+
+NS_OBJECT_ENSURE_REGISTERED(SliceAqm);
+NS_OBJECT_ENSURE_REGISTERED(CoDelAqm);
+NS_OBJECT_ENSURE_REGISTERED(PieAqm);
+
+TypeId
+SliceAqm::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::SliceAqm")
+                            .SetParent<Object>()
+                            .SetGroupName("TrafficControl")
+                            .AddAttribute("UseEcn",
+                                          "Mark congested ECT packets instead of dropping them",
+                                          BooleanValue(false),
+                                          MakeBooleanAccessor(&SliceAqm::m_useEcn),
+                                          MakeBooleanChecker());
+    return tid;
+}
+
+SliceAqm::SliceAqm()
+    : m_useEcn(false)
+{
+}
+
+SliceAqm::~SliceAqm()
+{
+}
+
+bool
+SliceAqm::IsEcnEnabled() const
+{
+    return m_useEcn;
+}
+
+int64_t
+SliceAqm::AssignStreams(int64_t stream)
+{
+    return 0;
+}
+
+TypeId
+CoDelAqm::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::CoDelAqm")
+            .SetParent<SliceAqm>()
+            .SetGroupName("TrafficControl")
+            .AddConstructor<CoDelAqm>()
+            .AddAttribute("Target",
+                          "Acceptable standing queueing delay",
+                          TimeValue(MilliSeconds(5)),
+                          MakeTimeAccessor(&CoDelAqm::m_target),
+                          MakeTimeChecker())
+            .AddAttribute("Interval",
+                          "Time the queueing delay may stay above Target before packets are "
+                          "dropped, about a round-trip time",
+                          TimeValue(MilliSeconds(100)),
+                          MakeTimeAccessor(&CoDelAqm::m_interval),
+                          MakeTimeChecker())
+            .AddAttribute("MinBytes",
+                          "Queue size at or below which no packet is dropped, about one MTU",
+                          UintegerValue(1500),
+                          MakeUintegerAccessor(&CoDelAqm::m_minBytes),
+                          MakeUintegerChecker<uint32_t>());
+    return tid;
+}
+
+CoDelAqm::CoDelAqm()
+    : m_target(MilliSeconds(5)),
+      m_interval(MilliSeconds(100)),
+      m_minBytes(1500),
+      m_dropping(false),
+      m_firstAboveTime(0),
+      m_dropNext(0),
+      m_count(0),
+      m_lastCount(0)
+{
+}
+
+CoDelAqm::~CoDelAqm()
+{
+}
+
+SliceAqm::Verdict
+CoDelAqm::Enqueue(Ptr<const QueueDiscItem> item, uint32_t queueBytes)
+{
+    return PASS;
+}
+
+bool
+CoDelAqm::IsAboveTarget(Time sojourn, uint32_t queueBytes)
+{
+    if (sojourn < m_target || queueBytes <= m_minBytes)
+    {
+        m_firstAboveTime = Time(0);
+        return false;
+    }
+    Time now = Simulator::Now();
+    if (m_firstAboveTime.IsZero())
+    {
+        m_firstAboveTime = now + m_interval;
+        return false;
+    }
+    return now >= m_firstAboveTime;
+}
+
+Time
+CoDelAqm::ControlLaw(Time t) const
+{
+    return t + Seconds(m_interval.GetSeconds() / std::sqrt(m_count));
+}
+
+SliceAqm::Verdict
+CoDelAqm::Dequeue(Ptr<const QueueDiscItem> item, Time sojourn, uint32_t queueBytes)
+{
+    Time now = Simulator::Now();
+    bool aboveTarget = IsAboveTarget(sojourn, queueBytes);
+    if (m_dropping)
+    {
+        if (!aboveTarget)
+        {
+            m_dropping = false;
+        }
+        else if (now >= m_dropNext)
+        {
+            m_count++;
+            m_dropNext = ControlLaw(m_dropNext);
+            return CONGESTED;
+        }
+        return PASS;
+    }
+    if (!aboveTarget)
+    {
+        return PASS;
+    }
+
+    // A dropping state entered soon after the previous one resumes near its rate
+    m_dropping = true;
+    uint32_t delta = m_count - m_lastCount;
+    m_count = delta > 1 && now - m_dropNext < m_interval * 16 ? delta : 1;
+    m_lastCount = m_count;
+    m_dropNext = ControlLaw(now);
+    NS_LOG_DEBUG("Entering the dropping state, sojourn " << sojourn.As(Time::MS) << ", count "
+                                                         << m_count);
+    return CONGESTED;
+}
+
+TypeId
+PieAqm::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::PieAqm")
+            .SetParent<SliceAqm>()
+            .SetGroupName("TrafficControl")
+            .AddConstructor<PieAqm>()
+            .AddAttribute("Target",
+                          "Target queueing delay",
+                          TimeValue(MilliSeconds(15)),
+                          MakeTimeAccessor(&PieAqm::m_target),
+                          MakeTimeChecker())
+            .AddAttribute("TUpdate",
+                          "Period of the drop probability updates",
+                          TimeValue(MilliSeconds(15)),
+                          MakeTimeAccessor(&PieAqm::m_tUpdate),
+                          MakeTimeChecker(MilliSeconds(1)))
+            .AddAttribute("Alpha",
+                          "Weight of the delay above Target, per second",
+                          DoubleValue(0.125),
+                          MakeDoubleAccessor(&PieAqm::m_alpha),
+                          MakeDoubleChecker<double>(0))
+            .AddAttribute("Beta",
+                          "Weight of the delay growth since the previous update, per second",
+                          DoubleValue(1.25),
+                          MakeDoubleAccessor(&PieAqm::m_beta),
+                          MakeDoubleChecker<double>(0))
+            .AddAttribute("MaxBurst",
+                          "Time after an idle period during which no packet is dropped",
+                          TimeValue(MilliSeconds(150)),
+                          MakeTimeAccessor(&PieAqm::m_maxBurst),
+                          MakeTimeChecker())
+            .AddAttribute("MarkThreshold",
+                          "Drop probability above which ECT packets are dropped, not marked",
+                          DoubleValue(0.1),
+                          MakeDoubleAccessor(&PieAqm::m_markThreshold),
+                          MakeDoubleChecker<double>(0, 1))
+            .AddAttribute("MtuBytes",
+                          "Size of a full packet; a queue of two is never congested",
+                          UintegerValue(1500),
+                          MakeUintegerAccessor(&PieAqm::m_mtuBytes),
+                          MakeUintegerChecker<uint32_t>());
+    return tid;
+}
+
+PieAqm::PieAqm()
+    : m_target(MilliSeconds(15)),
+      m_tUpdate(MilliSeconds(15)),
+      m_alpha(0.125),
+      m_beta(1.25),
+      m_maxBurst(MilliSeconds(150)),
+      m_markThreshold(0.1),
+      m_mtuBytes(1500),
+      m_dropProb(0),
+      m_qDelay(0),
+      m_qDelayOld(0),
+      m_burstAllowance(0),
+      m_nextUpdate(0)
+{
+    m_rng = CreateObject<UniformRandomVariable>();
+}
+
+PieAqm::~PieAqm()
+{
+}
+
+int64_t
+PieAqm::AssignStreams(int64_t stream)
+{
+    m_rng->SetStream(stream);
+    return 1;
+}
+
+double
+PieAqm::GetDropProbability() const
+{
+    return m_dropProb;
+}
+
+void
+PieAqm::UpdateProbability(uint32_t queueBytes)
+{
+    Time now = Simulator::Now();
+    if (m_nextUpdate.IsZero())
+    {
+        m_burstAllowance = m_maxBurst;
+        m_nextUpdate = now + m_tUpdate;
+        return;
+    }
+
+    while (now >= m_nextUpdate)
+    {
+        Time qDelay = queueBytes ? m_qDelay : Time(0);
+        double p = m_alpha * (qDelay - m_target).GetSeconds() +
+                   m_beta * (qDelay - m_qDelayOld).GetSeconds();
+        // Small probabilities move slowly, so that light congestion is not overcorrected
+        if (m_dropProb < 0.000001)
+        {
+            p /= 2048;
+        }
+        else if (m_dropProb < 0.00001)
+        {
+            p /= 512;
+        }
+        else if (m_dropProb < 0.0001)
+        {
+            p /= 128;
+        }
+        else if (m_dropProb < 0.001)
+        {
+            p /= 32;
+        }
+        else if (m_dropProb < 0.01)
+        {
+            p /= 8;
+        }
+        else if (m_dropProb < 0.1)
+        {
+            p /= 2;
+        }
+        else
+        {
+            p = std::min(p, 0.02);
+        }
+        m_dropProb += p;
+        if (qDelay.IsZero() && m_qDelayOld.IsZero())
+        {
+            m_dropProb *= 0.98;
+        }
+        m_dropProb = std::min(std::max(m_dropProb, 0.0), 1.0);
+
+        m_burstAllowance = std::max(m_burstAllowance - m_tUpdate, Time(0));
+        if (m_dropProb == 0 && qDelay < m_target / 2 && m_qDelayOld < m_target / 2)
+        {
+            m_burstAllowance = m_maxBurst;
+        }
+        m_qDelayOld = qDelay;
+        m_nextUpdate += m_tUpdate;
+
+        // The updates of an idle period change nothing once the probability is zero
+        if (m_dropProb == 0 && qDelay.IsZero() && m_burstAllowance == m_maxBurst)
+        {
+            m_nextUpdate = std::max(m_nextUpdate, now + m_tUpdate);
+            break;
+        }
+    }
+}
+
+SliceAqm::Verdict
+PieAqm::Enqueue(Ptr<const QueueDiscItem> item, uint32_t queueBytes)
+{
+    UpdateProbability(queueBytes);
+    if (m_burstAllowance.IsStrictlyPositive())
+    {
+        return PASS;
+    }
+    if (m_qDelayOld < m_target / 2 && m_dropProb < 0.2)
+    {
+        return PASS;
+    }
+    if (queueBytes <= 2 * m_mtuBytes)
+    {
+        return PASS;
+    }
+    if (m_rng->GetValue() >= m_dropProb)
+    {
+        return PASS;
+    }
+    return m_dropProb <= m_markThreshold ? CONGESTED : DROP;
+}
+
+SliceAqm::Verdict
+PieAqm::Dequeue(Ptr<const QueueDiscItem> item, Time sojourn, uint32_t queueBytes)
+{
+    // Updated here too, so that the probability follows a queue draining
+    // without arrivals
+    UpdateProbability(queueBytes);
+    m_qDelay = sojourn;
+    return PASS;
+}
+
+} // namespace ns3
@@ -0,0 +1,195 @@
+#ifndef SLICE_AQM_H
+#define SLICE_AQM_H
+
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/queue-item.h"
+#include "ns3/random-variable-stream.h"
+
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::SliceAqm, ns3::CoDelAqm and ns3::PieAqm declarations.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup bridge
+ * \brief Active queue management of one internal queue of CustomQueueDisc
+ *
+ * The queue disc asks the AQM of a queue about each packet it enqueues in
+ * the queue and each packet it dequeues from it. A congested packet is
+ * marked CE if the AQM uses ECN and the packet is ECT, and dropped
+ * otherwise; the queue disc counts the drops and marks of each queue.
+ *
+ * Every queue has an AQM instance of its own, since AQMs keep state.
+ */
+class SliceAqm : public Object
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    SliceAqm();
+    ~SliceAqm() override;
+
+    /// Decision about a packet
+    enum Verdict
+    {
+        PASS,      //!< the packet goes on
+        CONGESTED, //!< the packet is marked, or dropped if it cannot be
+        DROP       //!< the packet is dropped, even if it could be marked
+    };
+
+    /**
+     * \brief Decide about a packet arriving in the queue
+     * \param item the packet
+     * \param queueBytes the bytes in the queue before the packet
+     * \returns the verdict
+     */
+    virtual Verdict Enqueue(Ptr<const QueueDiscItem> item, uint32_t queueBytes) = 0;
+
+    /**
+     * \brief Decide about a packet leaving the queue
+     * \param item the packet
+     * \param sojourn the time the packet spent in the queue
+     * \param queueBytes the bytes left in the queue
+     * \returns the verdict
+     */
+    virtual Verdict Dequeue(Ptr<const QueueDiscItem> item, Time sojourn, uint32_t queueBytes) = 0;
+
+    /// \returns true if congested packets are marked rather than dropped
+    bool IsEcnEnabled() const;
+
+    /**
+     * Assign a fixed random variable stream number to the random variables
+     * used by this model.
+     *
+     * \param stream first stream index to use
+     * \return the number of stream indices assigned by this model
+     */
+    virtual int64_t AssignStreams(int64_t stream);
+
+  private:
+    bool m_useEcn; //!< mark ECT packets instead of dropping them
+};
+
+/**
+ * \ingroup bridge
+ * \brief CoDel (RFC 8289), deciding at dequeue
+ *
+ * Once the sojourn time of the packets has stayed above Target for an
+ * Interval, CoDel drops a packet, then the next ones at intervals
+ * shrinking with the square root of the number of drops, until a packet
+ * leaves in less than Target. A queue holding at most MinBytes is never
+ * congested.
+ *
+ * The verdicts are per packet: CustomQueueDisc asks about the next packet
+ * of the queue, at the same time, after each one dropped, so that all the
+ * drops due by now are made in one dequeue, as in RFC 8289.
+ */
+class CoDelAqm : public SliceAqm
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    CoDelAqm();
+    ~CoDelAqm() override;
+
+    Verdict Enqueue(Ptr<const QueueDiscItem> item, uint32_t queueBytes) override;
+    Verdict Dequeue(Ptr<const QueueDiscItem> item, Time sojourn, uint32_t queueBytes) override;
+
+  private:
+    /**
+     * \param sojourn the sojourn time of the packet leaving the queue
+     * \param queueBytes the bytes left in the queue
+     * \returns true if the queue has been above target for an interval
+     */
+    bool IsAboveTarget(Time sojourn, uint32_t queueBytes);
+
+    /// \returns the time of the next drop, an interval over the square root of the drops after t
+    Time ControlLaw(Time t) const;
+
+    Time m_target;         //!< acceptable standing delay
+    Time m_interval;       //!< time the delay may stay above target
+    uint32_t m_minBytes;   //!< queue size below which packets are never dropped
+    bool m_dropping;       //!< true in the dropping state
+    Time m_firstAboveTime; //!< end of the interval above target, zero if below target
+    Time m_dropNext;       //!< time of the next drop in the dropping state
+    uint32_t m_count;      //!< drops since the dropping state was entered
+    uint32_t m_lastCount;  //!< drops of the previous dropping state
+};
+
+/**
+ * \ingroup bridge
+ * \brief PIE (RFC 8033), deciding at enqueue
+ *
+ * Every TUpdate, the drop probability follows the queueing delay, taken as
+ * the sojourn time of the last packet dequeued: it grows by Alpha per
+ * second of delay above Target, and by Beta per second the delay grew
+ * since the previous update, both scaled down while the probability is
+ * small. Arriving packets are dropped with this probability, except during
+ * the MaxBurst that follows an idle period, while the delay is below half
+ * the target and the probability small, and while the queue holds at most
+ * two packets of MtuBytes. With ECN, packets are marked until the
+ * probability reaches MarkThreshold, and dropped above.
+ *
+ * The probability is updated when packets arrive or leave, for the periods
+ * elapsed since the previous update, so an idle queue schedules no event:
+ * the periods it stayed empty are run with no delay when it is used again.
+ */
+class PieAqm : public SliceAqm
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    PieAqm();
+    ~PieAqm() override;
+
+    Verdict Enqueue(Ptr<const QueueDiscItem> item, uint32_t queueBytes) override;
+    Verdict Dequeue(Ptr<const QueueDiscItem> item, Time sojourn, uint32_t queueBytes) override;
+    int64_t AssignStreams(int64_t stream) override;
+
+    /// \returns the current drop probability
+    double GetDropProbability() const;
+
+  private:
+    /**
+     * \brief Run the updates of the drop probability due by now
+     * \param queueBytes the bytes in the queue
+     */
+    void UpdateProbability(uint32_t queueBytes);
+
+    Time m_target;                    //!< target queueing delay
+    Time m_tUpdate;                   //!< period of the probability updates
+    double m_alpha;                   //!< weight of the delay above target, per second
+    double m_beta;                    //!< weight of the delay growth, per second
+    Time m_maxBurst;                  //!< burst allowed after an idle period
+    double m_markThreshold;           //!< probability above which ECT packets are dropped
+    uint32_t m_mtuBytes;              //!< size of a full packet
+    double m_dropProb;                //!< drop probability
+    Time m_qDelay;                    //!< sojourn time of the last packet dequeued
+    Time m_qDelayOld;                 //!< queueing delay of the previous update
+    Time m_burstAllowance;            //!< time left during which no packet is dropped
+    Time m_nextUpdate;                //!< time of the next probability update
+    Ptr<UniformRandomVariable> m_rng; //!< drop decisions
+};
+
+} // namespace ns3
+
+#endif /* SLICE_AQM_H */
@@ -0,0 +1,68 @@
+#ifndef SLICE_ID_TAG_H
+#define SLICE_ID_TAG_H
+
+#include "ns3/tag.h"
+
+namespace ns3
+{
+
+/**
+ * \brief Carries the id of the slice a packet belongs to
+ *
+ * Traffic generators of a slice add the tag, so that queue discs can give
+ * each slice its own queue even when several slices share a DSCP.
+ */
+class SliceIdTag : public Tag
+{
+  public:
+    static TypeId GetTypeId()
+    {
+        static TypeId tid = TypeId("ns3::SliceIdTag")
+                                .SetParent<Tag>()
+                                .SetGroupName("Network")
+                                .AddConstructor<SliceIdTag>();
+        return tid;
+    }
+
+    TypeId GetInstanceTypeId() const override
+    {
+        return GetTypeId();
+    }
+
+    uint32_t GetSerializedSize() const override
+    {
+        return sizeof(uint32_t);
+    }
+
+    void Serialize(TagBuffer i) const override
+    {
+        i.WriteU32(m_sliceId);
+    }
+
+    void Deserialize(TagBuffer i) override
+    {
+        m_sliceId = i.ReadU32();
+    }
+
+    void Print(std::ostream& os) const override
+    {
+        os << "Slice " << m_sliceId;
+    }
+
+    void SetSliceId(uint32_t sliceId)
+    {
+        m_sliceId = sliceId;
+    }
+
+    uint32_t GetSliceId() const
+    {
+        return m_sliceId;
+    }
+
+  private:
+    uint32_t m_sliceId{0};
+};
+
+} // namespace ns3
+
+#endif /* SLICE_ID_TAG_H */
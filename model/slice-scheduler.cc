@@ -0,0 +1,145 @@
+#include "slice-scheduler.h"
+
+#include "ns3/log.h"
+
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::SliceScheduler implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("SliceScheduler");
+
+SliceScheduler::SliceScheduler()
+    : m_packets(0)
+{
+    // Same queues as CustomQueueDisc: URLLC, eMBB, mMTC
+    m_queues.resize(3);
+    const uint32_t limits[] = {20000, 500000, 200000};
+    const uint32_t weights[] = {80, 15, 5};
+    for (uint32_t i = 0; i < m_queues.size(); i++)
+    {
+        m_queues[i].bytes = 0;
+        m_queues[i].limit = limits[i];
+        m_queues[i].weight = weights[i];
+        m_queues[i].drops = 0;
+        m_queues[i].deficit = 0;
+        m_queues[i].active = false;
+    }
+    UpdateQuantums();
+}
+
+void
+SliceScheduler::SetWeight(uint32_t queue, uint32_t weight)
+{
+    NS_ASSERT_MSG(queue < m_queues.size(), "Unknown queue " << queue);
+    m_queues[queue].weight = std::max<uint32_t>(1, weight);
+    UpdateQuantums();
+}
+
+void
+SliceScheduler::UpdateQuantums()
+{
+    uint32_t minWeight = UINT32_MAX;
+    for (const auto& q : m_queues)
+    {
+        minWeight = std::min(minWeight, q.weight);
+    }
+    for (auto& q : m_queues)
+    {
+        q.quantum = uint64_t(QUANTUM_BYTES) * q.weight / minWeight;
+    }
+}
+
+void
+SliceScheduler::SetLimit(uint32_t queue, uint32_t bytes)
+{
+    NS_ASSERT_MSG(queue < m_queues.size(), "Unknown queue " << queue);
+    m_queues[queue].limit = bytes;
+}
+
+bool
+SliceScheduler::Enqueue(uint32_t queue, const Item& item)
+{
+    Queue& q = m_queues[queue];
+    uint32_t size = item.packet->GetSize();
+    if (q.bytes + size > q.limit)
+    {
+        NS_LOG_LOGIC("Queue " << queue << " full: dropping UID " << item.packet->GetUid());
+        q.drops++;
+        return false;
+    }
+    q.items.push_back(item);
+    q.bytes += size;
+    m_packets++;
+    if (!q.active)
+    {
+        q.active = true;
+        m_active.push_back(queue);
+    }
+    return true;
+}
+
+bool
+SliceScheduler::Dequeue(Item& item)
+{
+    while (!m_active.empty())
+    {
+        uint32_t index = m_active.front();
+        Queue& q = m_queues[index];
+        uint32_t size = q.items.front().packet->GetSize();
+        if (q.deficit < size)
+        {
+            q.deficit += q.quantum;
+            m_active.pop_front();
+            m_active.push_back(index);
+            continue;
+        }
+        item = q.items.front();
+        q.items.pop_front();
+        q.bytes -= size;
+        q.deficit -= size;
+        m_packets--;
+        if (q.items.empty())
+        {
+            q.active = false;
+            q.deficit = 0;
+            m_active.pop_front();
+        }
+        return true;
+    }
+    return false;
+}
+
+uint32_t
+SliceScheduler::GetNQueues() const
+{
+    return m_queues.size();
+}
+
+uint32_t
+SliceScheduler::GetNPackets() const
+{
+    return m_packets;
+}
+
+uint32_t
+SliceScheduler::GetNBytes(uint32_t queue) const
+{
+    NS_ASSERT_MSG(queue < m_queues.size(), "Unknown queue " << queue);
+    return m_queues[queue].bytes;
+}
+
+uint64_t
+SliceScheduler::GetDrops(uint32_t queue) const
+{
+    NS_ASSERT_MSG(queue < m_queues.size(), "Unknown queue " << queue);
+    return m_queues[queue].drops;
+}
+
+} // namespace ns3
@@ -0,0 +1,119 @@
+#ifndef SLICE_SCHEDULER_H
+#define SLICE_SCHEDULER_H
+
+#include "ns3/address.h"
+#include "ns3/packet.h"
+#include "ns3/ptr.h"
+
+#include <deque>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::SliceScheduler declaration.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup bridge
+ * \brief Slice queues and weighted round-robin scheduler of one switch egress port
+ *
+ * There is one FIFO per slice, indexed like the internal queues of
+ * CustomQueueDisc (0 = URLLC, 1 = eMBB, 2 = mMTC), with the same byte limits
+ * and the same deficit round robin: each round, the non-empty queues send
+ * up to QUANTUM_BYTES times their weight over the smallest weight. Frames
+ * are stored as they are handed to the port, so no QueueDiscItem is
+ * allocated.
+ */
+class SliceScheduler
+{
+  public:
+    static constexpr uint32_t QUANTUM_BYTES = 1500; //!< quantum of the smallest weight
+
+    /// A frame waiting for its port
+    struct Item
+    {
+        Ptr<Packet> packet;     //!< the frame
+        uint32_t incomingIndex; //!< index of the port it came from
+        uint16_t protocol;      //!< frame protocol
+        Address src;            //!< source address
+        Address dst;            //!< destination address
+    };
+
+    SliceScheduler();
+
+    /**
+     * \brief Set the relative share of a queue
+     * \param queue the queue index
+     * \param weight the weight, at least 1
+     */
+    void SetWeight(uint32_t queue, uint32_t weight);
+
+    /**
+     * \brief Set the byte limit of a queue
+     * \param queue the queue index
+     * \param bytes the limit
+     */
+    void SetLimit(uint32_t queue, uint32_t bytes);
+
+    /**
+     * \brief Queue a frame, unless its queue is full
+     * \param queue the queue index
+     * \param item the frame
+     * \returns false if the frame was dropped
+     */
+    bool Enqueue(uint32_t queue, const Item& item);
+
+    /**
+     * \brief Take the next frame to send
+     * \param item set to the frame
+     * \returns false if all queues are empty
+     */
+    bool Dequeue(Item& item);
+
+    /// \returns the number of queues
+    uint32_t GetNQueues() const;
+    /// \returns the number of frames in all queues
+    uint32_t GetNPackets() const;
+
+    /**
+     * \param queue the queue index
+     * \returns the number of bytes in the queue
+     */
+    uint32_t GetNBytes(uint32_t queue) const;
+
+    /**
+     * \param queue the queue index
+     * \returns the number of frames dropped because the queue was full
+     */
+    uint64_t GetDrops(uint32_t queue) const;
+
+  private:
+    /// FIFO of one slice
+    struct Queue
+    {
+        std::deque<Item> items; //!< queued frames
+        uint32_t bytes;         //!< bytes queued
+        uint32_t limit;         //!< byte limit
+        uint32_t weight;        //!< relative share
+        uint64_t drops;         //!< frames dropped on overflow
+        uint64_t quantum;       //!< bytes added to the deficit per round
+        uint64_t deficit;       //!< bytes the queue may still send
+        bool active;            //!< true if the queue is in the active list
+    };
+
+    /// Derives the quantum of each queue from the weights
+    void UpdateQuantums();
+
+    std::vector<Queue> m_queues;   //!< one queue per slice
+    std::deque<uint32_t> m_active; //!< non-empty queues, in service order
+    uint32_t m_packets;            //!< frames in all queues
+};
+
+} // namespace ns3
+
+#endif /* SLICE_SCHEDULER_H */
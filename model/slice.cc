@@ -196,6 +196,7 @@ Slice::InstallApps()
         trafficGenerator->SetAttribute("DataRate", DoubleValue(rateMbps));
         trafficGenerator->SetAttribute("PacketSizeVar", PointerValue(m_packetSizeVar));
         trafficGenerator->SetAttribute("Dscp", UintegerValue(m_dscp));
+        trafficGenerator->SetAttribute("SliceId", UintegerValue(m_sliceId));
         trafficGenerator->SetAttribute("MaxPackets", UintegerValue(m_maxPackets));
         trafficGenerator->SetStartTime(Seconds(m_startTime));
         trafficGenerator->SetStopTime(Seconds(sourceStopTime));
@@ -1,14 +1,19 @@
 #include "slicescope-header.h"
 
+#include "flow-key.h"
+
 #include "ns3/address-utils.h"
+#include "ns3/assert.h"
 #include "ns3/packet.h"
 
+#include <iomanip>
+
 namespace ns3
 {
 
 SlicescopeHeader::SlicescopeHeader()
     : m_dscp(0),
-      m_bitmap(0)
+      m_maxHops(0)
 {
 }
 
@@ -25,15 +30,124 @@ SlicescopeHeader::GetDscp() const
 }
 
 void
-SlicescopeHeader::SetBitmap(uint8_t bitmap)
+SlicescopeHeader::SetPathFilterSize(uint8_t bytes)
 {
-    m_bitmap = bitmap;
+    m_pathFilter.assign(bytes, 0);
 }
 
 uint8_t
-SlicescopeHeader::GetBitmap() const
+SlicescopeHeader::GetPathFilterSize() const
+{
+    return m_pathFilter.size();
+}
+
+void
+SlicescopeHeader::SetPathFilter(const std::vector<uint8_t>& filter)
+{
+    NS_ASSERT_MSG(filter.size() <= 0xff, "Path filter of " << filter.size() << " bytes");
+    m_pathFilter = filter;
+}
+
+const std::vector<uint8_t>&
+SlicescopeHeader::GetPathFilter() const
+{
+    return m_pathFilter;
+}
+
+void
+SlicescopeHeader::GetPathFilterBits(uint16_t switchId, uint32_t* bits) const
+{
+    // Double hashing: FILTER_HASHES positions from one 64-bit hash
+    uint64_t hash = FlowKey::Mix(switchId);
+    uint32_t h1 = hash;
+    uint32_t h2 = (hash >> 32) | 1;
+    uint32_t size = m_pathFilter.size() * 8;
+    for (uint32_t i = 0; i < FILTER_HASHES; i++)
+    {
+        bits[i] = (h1 + i * h2) % size;
+    }
+}
+
+void
+SlicescopeHeader::AddPathSwitch(uint16_t switchId)
+{
+    if (m_pathFilter.empty())
+    {
+        return;
+    }
+    uint32_t bits[FILTER_HASHES];
+    GetPathFilterBits(switchId, bits);
+    for (uint32_t bit : bits)
+    {
+        m_pathFilter[bit / 8] |= 1 << (bit % 8);
+    }
+}
+
+bool
+SlicescopeHeader::MayHaveTraversed(uint16_t switchId) const
+{
+    if (m_pathFilter.empty())
+    {
+        return false;
+    }
+    uint32_t bits[FILTER_HASHES];
+    GetPathFilterBits(switchId, bits);
+    for (uint32_t bit : bits)
+    {
+        if (!(m_pathFilter[bit / 8] & (1 << (bit % 8))))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool
+SlicescopeHeader::MatchesPath(const std::vector<uint16_t>& path) const
+{
+    for (uint16_t switchId : path)
+    {
+        if (!MayHaveTraversed(switchId))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void
+SlicescopeHeader::SetMaxHops(uint8_t maxHops)
+{
+    m_maxHops = maxHops;
+}
+
+uint8_t
+SlicescopeHeader::GetMaxHops() const
+{
+    return m_maxHops;
+}
+
+uint8_t
+SlicescopeHeader::GetHopCount() const
+{
+    return m_hops.size();
+}
+
+bool
+SlicescopeHeader::AddHop(const IntRecord& record)
+{
+    if (m_hops.size() >= m_maxHops)
+    {
+        return false;
+    }
+    m_hops.push_back(record);
+    return true;
+}
+
+const std::vector<SlicescopeHeader::IntRecord>&
+SlicescopeHeader::GetHops() const
 {
-    return m_bitmap;
+    return m_hops;
 }
 
 TypeId
@@ -53,28 +167,80 @@ SlicescopeHeader::GetInstanceTypeId() const
 void
 SlicescopeHeader::Serialize(Buffer::Iterator start) const
 {
-    start.WriteU8(m_dscp);
-    start.WriteU8(m_bitmap);
+    // Records are only added below the hop limit, so no limit means no stack
+    bool intPresent = m_maxHops > 0;
+    start.WriteU8((m_dscp & 0x3f) | (intPresent ? INT_PRESENT : 0));
+    start.WriteU8(m_pathFilter.size());
+    if (intPresent)
+    {
+        start.WriteU8(m_hops.size());
+        start.WriteU8(m_maxHops);
+    }
+    for (uint8_t byte : m_pathFilter)
+    {
+        start.WriteU8(byte);
+    }
+    for (const auto& record : m_hops)
+    {
+        start.WriteHtonU16(record.switchId);
+        start.WriteU8(record.ingressPort);
+        start.WriteU8(record.egressPort);
+        start.WriteHtonU32(record.queueDepth);
+        start.WriteHtonU32(record.hopLatency);
+    }
 }
 
 uint32_t
 SlicescopeHeader::Deserialize(Buffer::Iterator start)
 {
-    m_dscp = start.ReadU8();
-    m_bitmap = start.ReadU8();
+    uint8_t first = start.ReadU8();
+    m_dscp = first & 0x3f;
+    m_pathFilter.resize(start.ReadU8());
+    m_hops.clear();
+    m_maxHops = 0;
+    if (first & INT_PRESENT)
+    {
+        m_hops.resize(start.ReadU8());
+        m_maxHops = start.ReadU8();
+    }
+    for (auto& byte : m_pathFilter)
+    {
+        byte = start.ReadU8();
+    }
+    for (auto& record : m_hops)
+    {
+        record.switchId = start.ReadNtohU16();
+        record.ingressPort = start.ReadU8();
+        record.egressPort = start.ReadU8();
+        record.queueDepth = start.ReadNtohU32();
+        record.hopLatency = start.ReadNtohU32();
+    }
     return GetSerializedSize();
 }
 
 uint32_t
 SlicescopeHeader::GetSerializedSize() const
 {
-    return 2;
+    return BASE_SIZE + (m_maxHops ? INT_SIZE : 0) + m_pathFilter.size() +
+           RECORD_SIZE * m_hops.size();
 }
 
 void
 SlicescopeHeader::Print(std::ostream& os) const
 {
-    os << "DSCP=" << static_cast<uint32_t>(m_dscp) << " Bitmap=" << static_cast<uint32_t>(m_bitmap);
+    os << "DSCP=" << static_cast<uint32_t>(m_dscp) << " PathFilter=";
+    for (uint8_t byte : m_pathFilter)
+    {
+        os << std::hex << std::setw(2) << std::setfill('0') << static_cast<uint32_t>(byte);
+    }
+    os << std::dec << std::setfill(' ') << " Hops=" << m_hops.size() << "/"
+       << static_cast<uint32_t>(m_maxHops);
+    for (const auto& record : m_hops)
+    {
+        os << " [switch " << record.switchId << " " << static_cast<uint32_t>(record.ingressPort)
+           << "->" << static_cast<uint32_t>(record.egressPort) << " qdepth " << record.queueDepth
+           << " latency " << record.hopLatency << "ns]";
+    }
 }
 
 } // namespace ns3
\ No newline at end of file
@@ -3,19 +3,119 @@
 
 #include "ns3/header.h"
 
+#include <vector>
+
 namespace ns3
 {
 
+/**
+ * \brief Slicescope header, inserted between the UDP header and the payload
+ *
+ * The header starts with the slice DSCP and the size of the path filter.
+ * The I bit, above the DSCP, tells whether the in-band network telemetry
+ * (INT) hop count and hop limit follow; a header without INT stack is
+ * only two bytes. The path filter follows: a Bloom filter of FilterBytes
+ * bytes into which every switch ORs its id, so that the receiver can test
+ * which switches the packet traversed. Last comes the INT stack, one
+ * fixed-size record per switch traversed; switches stop appending records
+ * once the hop limit is reached.
+ *
+ * \verbatim
+    0        8        16       24       32
+    +-+-+----+--------+ - - - -+ - - - -+
+    |I|0|DSCP|FiltSize|  Hops  |MaxHops |   Hops and MaxHops if I is set
+    +-+-+----+--------+ - - - -+ - - - -+
+    |   Path filter (FilterBytes bytes) |
+    +-----------------------------------+
+    |    Switch id    |Ingress | Egress |  \
+    +-----------------+--------+--------+   |
+    |            Queue depth            |   | one record per hop
+    +-----------------------------------+   |
+    |        Hop latency (ns)           |  /
+    +-----------------------------------+
+   \endverbatim
+ */
 class SlicescopeHeader : public Header
 {
   public:
+    /// Per-hop telemetry record
+    struct IntRecord
+    {
+        uint16_t switchId;   //!< identifier of the switch
+        uint8_t ingressPort; //!< index of the ingress port
+        uint8_t egressPort;  //!< index of the egress port
+        uint32_t queueDepth; //!< packets in the egress port queue
+        uint32_t hopLatency; //!< time since the previous hop stamped the packet, in ns
+    };
+
+    static constexpr uint32_t BASE_SIZE = 2;     //!< size without INT stack and path filter
+    static constexpr uint32_t INT_SIZE = 2;      //!< size of the hop count and hop limit
+    static constexpr uint32_t RECORD_SIZE = 12;  //!< size of one record
+    static constexpr uint32_t FILTER_HASHES = 3; //!< filter bits set per switch
+    static constexpr uint8_t INT_PRESENT = 0x80; //!< I bit, above the DSCP
+
     SlicescopeHeader();
 
     void SetDscp(uint8_t dscp);
     uint8_t GetDscp() const;
 
-    void SetBitmap(uint8_t bitmap);
-    uint8_t GetBitmap() const;
+    /**
+     * \brief Sets the size of the path filter and empties it
+     * \param bytes the filter size, 0 for no path filter
+     */
+    void SetPathFilterSize(uint8_t bytes);
+    /// \returns the size of the path filter, in bytes
+    uint8_t GetPathFilterSize() const;
+
+    /**
+     * \brief Sets the bytes of the path filter, e.g. one saved by a receiver
+     * \param filter the filter bytes, at most 255
+     */
+    void SetPathFilter(const std::vector<uint8_t>& filter);
+    /// \returns the bytes of the path filter
+    const std::vector<uint8_t>& GetPathFilter() const;
+
+    /**
+     * \brief Records a switch in the path filter
+     * \param switchId the identifier of the switch
+     */
+    void AddPathSwitch(uint16_t switchId);
+
+    /**
+     * \brief Tests whether the packet may have traversed a switch
+     * \param switchId the identifier of the switch
+     * \returns false if the switch was certainly not traversed; true if it
+     * was, or on a false positive of the filter
+     */
+    bool MayHaveTraversed(uint16_t switchId) const;
+
+    /**
+     * \brief Tests a candidate path, e.g. one of the ECMP paths of the topology
+     * \param path the switch ids of the path
+     * \returns true if every switch of the path may have been traversed
+     */
+    bool MatchesPath(const std::vector<uint16_t>& path) const;
+
+    /**
+     * \brief Sets the number of records the stack can hold
+     * \param maxHops the hop limit, 0 for no INT stack
+     */
+    void SetMaxHops(uint8_t maxHops);
+    /// \returns the number of records the stack can hold
+    uint8_t GetMaxHops() const;
+
+    /// \returns the number of records in the stack
+    uint8_t GetHopCount() const;
+
+    /**
+     * \brief Appends a record to the INT stack
+     * \param record the record of this hop
+     * \returns false if the hop limit was reached and the record was not added
+     */
+    bool AddHop(const IntRecord& record);
+
+    /// \returns the records, from the first hop to the last
+    const std::vector<IntRecord>& GetHops() const;
 
     static TypeId GetTypeId();
 
@@ -26,10 +126,19 @@ class SlicescopeHeader : public Header
     void Print(std::ostream& os) const override;
 
   private:
+    /**
+     * \brief Computes the filter bits of a switch
+     * \param switchId the identifier of the switch
+     * \param bits set to the FILTER_HASHES bit positions
+     */
+    void GetPathFilterBits(uint16_t switchId, uint32_t* bits) const;
+
     uint8_t m_dscp;
-    uint8_t m_bitmap;
+    std::vector<uint8_t> m_pathFilter;
+    uint8_t m_maxHops;
+    std::vector<IntRecord> m_hops;
 };
 
 } // namespace ns3
 
-#endif // SLICESCOPE_HEADER_H
\ No newline at end of file
+#endif // SLICESCOPE_HEADER_H
@@ -0,0 +1,392 @@
+#include "slicescope-pipeline.h"
+
+#include "ns3/log.h"
+
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::SlicescopePipeline implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("SlicescopePipeline");
+
+NS_OBJECT_ENSURE_REGISTERED(SlicescopePipeline);
+
+SlicescopePipeline::Action::Action(ActionType type, uint32_t value)
+    : type(type),
+      value(value)
+{
+}
+
+SlicescopePipeline::Key::Key()
+    : inPort(0)
+{
+}
+
+SlicescopePipeline::Result::Result()
+    : drop(false),
+      egressPort(NO_PORT),
+      dscp(-1),
+      mark(false),
+      pop(false),
+      push(false),
+      pushDscp(0),
+      pushFilter(0),
+      cacheable(true)
+{
+}
+
+bool
+SlicescopePipeline::Result::Rewrites() const
+{
+    return dscp >= 0 || mark || pop || push;
+}
+
+bool
+SlicescopePipeline::PackedKey::operator==(const PackedKey& other) const
+{
+    return addresses == other.addresses && others == other.others;
+}
+
+size_t
+SlicescopePipeline::PackedKeyHash::operator()(const PackedKey& key) const
+{
+    return FlowKey::Mix(FlowKey::Mix(key.addresses) ^ key.others);
+}
+
+TypeId
+SlicescopePipeline::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::SlicescopePipeline")
+                            .SetParent<Object>()
+                            .SetGroupName("Bridge")
+                            .AddConstructor<SlicescopePipeline>();
+    return tid;
+}
+
+SlicescopePipeline::SlicescopePipeline()
+    : m_compiled(false),
+      m_version(0)
+{
+    NS_LOG_FUNCTION(this);
+    Changed();
+}
+
+SlicescopePipeline::~SlicescopePipeline()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+SlicescopePipeline::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_tables.clear();
+    m_actions.clear();
+    Object::DoDispose();
+}
+
+uint32_t
+SlicescopePipeline::AddTable(const std::string& name,
+                             MatchKind kind,
+                             uint32_t fields,
+                             const std::vector<Action>& defaultActions)
+{
+    NS_LOG_FUNCTION(this << name << kind << fields);
+    NS_ASSERT_MSG(kind != LPM || fields == FlowKey::SRC_ADDRESS || fields == FlowKey::DST_ADDRESS,
+                  "LPM table " << name << " must match one address");
+    Table table;
+    table.name = name;
+    table.kind = kind;
+    table.fieldMask = PackFields(fields);
+    table.matchSource = fields == FlowKey::SRC_ADDRESS;
+    table.defaultActions = AddActions(defaultActions);
+    table.hits = 0;
+    table.misses = 0;
+    m_tables.push_back(table);
+    Changed();
+    return m_tables.size() - 1;
+}
+
+void
+SlicescopePipeline::AddExactEntry(uint32_t table,
+                                  const Key& key,
+                                  const std::vector<Action>& actions)
+{
+    NS_LOG_FUNCTION(this << table << key.flow << key.inPort);
+    Table& t = GetTable(table);
+    NS_ASSERT_MSG(t.kind == EXACT, "Table " << t.name << " is not an exact match table");
+    PackedKey packed = Pack(key);
+    packed.addresses &= t.fieldMask.addresses;
+    packed.others &= t.fieldMask.others;
+    t.exact[packed] = AddActions(actions);
+    Changed();
+}
+
+void
+SlicescopePipeline::AddLpmEntry(uint32_t table,
+                                Ipv4Address network,
+                                Ipv4Mask mask,
+                                const std::vector<Action>& actions)
+{
+    NS_LOG_FUNCTION(this << table << network << mask);
+    Table& t = GetTable(table);
+    NS_ASSERT_MSG(t.kind == LPM, "Table " << t.name << " is not an LPM table");
+    t.lpm.AddRoute(network, mask, AddActions(actions));
+    Changed();
+}
+
+void
+SlicescopePipeline::AddTernaryEntry(uint32_t table,
+                                    const Key& value,
+                                    const Key& mask,
+                                    uint32_t priority,
+                                    const std::vector<Action>& actions)
+{
+    NS_LOG_FUNCTION(this << table << value.flow << mask.flow << priority);
+    Table& t = GetTable(table);
+    NS_ASSERT_MSG(t.kind == TERNARY, "Table " << t.name << " is not a ternary table");
+    TernaryEntry entry;
+    entry.mask = Pack(mask);
+    entry.mask.addresses &= t.fieldMask.addresses;
+    entry.mask.others &= t.fieldMask.others;
+    entry.value = Pack(value);
+    entry.value.addresses &= entry.mask.addresses;
+    entry.value.others &= entry.mask.others;
+    entry.priority = priority;
+    entry.actions = AddActions(actions);
+    t.ternary.push_back(entry);
+    Changed();
+}
+
+SlicescopePipeline::Result
+SlicescopePipeline::Process(Key key, uint32_t size)
+{
+    if (!m_compiled)
+    {
+        Compile();
+    }
+
+    Result result;
+    for (auto& table : m_tables)
+    {
+        PackedKey packed = Pack(key);
+        uint32_t actions = table.defaultActions;
+        bool hit = false;
+        switch (table.kind)
+        {
+        case EXACT: {
+            packed.addresses &= table.fieldMask.addresses;
+            packed.others &= table.fieldMask.others;
+            auto it = table.exact.find(packed);
+            if (it != table.exact.end())
+            {
+                actions = it->second;
+                hit = true;
+            }
+            break;
+        }
+        case LPM: {
+            uint32_t entry =
+                table.lpm.Lookup(table.matchSource ? key.flow.srcAddress : key.flow.dstAddress);
+            if (entry != Ipv4LpmTable::NO_ROUTE)
+            {
+                actions = entry;
+                hit = true;
+            }
+            break;
+        }
+        case TERNARY:
+            for (const auto& entry : table.ternary)
+            {
+                if ((packed.addresses & entry.mask.addresses) == entry.value.addresses &&
+                    (packed.others & entry.mask.others) == entry.value.others)
+                {
+                    actions = entry.actions;
+                    hit = true;
+                    break;
+                }
+            }
+            break;
+        }
+        if (hit)
+        {
+            table.hits++;
+        }
+        else
+        {
+            table.misses++;
+        }
+        NS_LOG_LOGIC("Table " << table.name << (hit ? " hit" : " miss"));
+
+        for (const Action* action = &m_actions[actions]; action->type != NO_ACTION; action++)
+        {
+            switch (action->type)
+            {
+            case SET_DSCP:
+                result.dscp = action->value & 0x3f;
+                key.flow.dscp = result.dscp;
+                break;
+            case SET_EGRESS:
+                result.egressPort = action->value;
+                break;
+            case PUSH_HEADER:
+                result.push = true;
+                result.pushDscp = (action->value >> 8) & 0xff;
+                result.pushFilter = action->value & 0xff;
+                break;
+            case POP_HEADER:
+                // Popping a header pushed by an earlier table cancels the push
+                if (result.push)
+                {
+                    result.push = false;
+                }
+                else
+                {
+                    result.pop = true;
+                }
+                break;
+            case MARK:
+                result.mark = true;
+                break;
+            case COUNT:
+                result.cacheable = false;
+                m_counterPkts[action->value]++;
+                m_counterBytes[action->value] += size;
+                break;
+            case DROP:
+                result.drop = true;
+                return result;
+            case NO_ACTION:
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+uint32_t
+SlicescopePipeline::GetNTables() const
+{
+    return m_tables.size();
+}
+
+uint64_t
+SlicescopePipeline::GetVersion() const
+{
+    return m_version;
+}
+
+uint64_t
+SlicescopePipeline::GetTableHits(uint32_t table) const
+{
+    NS_ASSERT_MSG(table < m_tables.size(), "Unknown table " << table);
+    return m_tables[table].hits;
+}
+
+uint64_t
+SlicescopePipeline::GetTableMisses(uint32_t table) const
+{
+    NS_ASSERT_MSG(table < m_tables.size(), "Unknown table " << table);
+    return m_tables[table].misses;
+}
+
+uint64_t
+SlicescopePipeline::GetCounterPackets(uint32_t counter) const
+{
+    return counter < m_counterPkts.size() ? m_counterPkts[counter] : 0;
+}
+
+uint64_t
+SlicescopePipeline::GetCounterBytes(uint32_t counter) const
+{
+    return counter < m_counterBytes.size() ? m_counterBytes[counter] : 0;
+}
+
+SlicescopePipeline::PackedKey
+SlicescopePipeline::Pack(const Key& key)
+{
+    PackedKey packed;
+    packed.addresses = (uint64_t(key.flow.srcAddress) << 32) | key.flow.dstAddress;
+    packed.others = (uint64_t(key.flow.srcPort) << 48) | (uint64_t(key.flow.dstPort) << 32) |
+                    (uint64_t(key.flow.protocol) << 24) | (uint64_t(key.flow.dscp & 0x3f) << 16) |
+                    (key.inPort & 0xffff);
+    return packed;
+}
+
+SlicescopePipeline::PackedKey
+SlicescopePipeline::PackFields(uint32_t fields)
+{
+    Key ones;
+    ones.flow.srcAddress = fields & FlowKey::SRC_ADDRESS ? 0xffffffff : 0;
+    ones.flow.dstAddress = fields & FlowKey::DST_ADDRESS ? 0xffffffff : 0;
+    ones.flow.srcPort = fields & FlowKey::SRC_PORT ? 0xffff : 0;
+    ones.flow.dstPort = fields & FlowKey::DST_PORT ? 0xffff : 0;
+    ones.flow.protocol = fields & FlowKey::PROTOCOL ? 0xff : 0;
+    ones.flow.dscp = fields & FlowKey::DSCP ? 0x3f : 0;
+    ones.inPort = fields & IN_PORT ? 0xffff : 0;
+    return Pack(ones);
+}
+
+uint32_t
+SlicescopePipeline::AddActions(const std::vector<Action>& actions)
+{
+    uint32_t offset = m_actions.size();
+    for (const auto& action : actions)
+    {
+        if (action.type != NO_ACTION)
+        {
+            m_actions.push_back(action);
+        }
+    }
+    m_actions.emplace_back(NO_ACTION);
+    return offset;
+}
+
+void
+SlicescopePipeline::Compile()
+{
+    NS_LOG_FUNCTION(this);
+    for (auto& table : m_tables)
+    {
+        std::stable_sort(table.ternary.begin(),
+                         table.ternary.end(),
+                         [](const TernaryEntry& a, const TernaryEntry& b) {
+                             return a.priority > b.priority;
+                         });
+    }
+    uint32_t nCounters = m_counterPkts.size();
+    for (const auto& action : m_actions)
+    {
+        if (action.type == COUNT)
+        {
+            nCounters = std::max(nCounters, action.value + 1);
+        }
+    }
+    m_counterPkts.resize(nCounters, 0);
+    m_counterBytes.resize(nCounters, 0);
+    m_compiled = true;
+}
+
+SlicescopePipeline::Table&
+SlicescopePipeline::GetTable(uint32_t table)
+{
+    NS_ASSERT_MSG(table < m_tables.size(), "Unknown table " << table);
+    return m_tables[table];
+}
+
+void
+SlicescopePipeline::Changed()
+{
+    // Shared by all pipelines, so that two pipelines never report the same version
+    static uint64_t nextVersion = 0;
+    m_version = ++nextVersion;
+    m_compiled = false;
+}
+
+} // namespace ns3
@@ -0,0 +1,305 @@
+#ifndef SLICESCOPE_PIPELINE_H
+#define SLICESCOPE_PIPELINE_H
+
+#include "flow-key.h"
+#include "ipv4-lpm-table.h"
+
+#include "ns3/object.h"
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::SlicescopePipeline declaration.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup bridge
+ * \brief Match-action pipeline run by a SlicescopeSwitchNetDevice on IPv4 packets
+ *
+ * The pipeline is an ordered list of tables, each matching on a subset of
+ * the packet flow key and the ingress port:
+ *
+ * - EXACT tables look the selected fields up in a hash map;
+ * - LPM tables match the source or destination address with an Ipv4LpmTable;
+ * - TERNARY tables compare value/mask entries in decreasing priority order.
+ *
+ * Every table applies the action list of the matching entry, or its default
+ * action list on a miss. Actions set the DSCP (later tables match on the new
+ * value), set the egress port, push or pop the slicescope header, mark the
+ * packet with ECN CE, count it, or drop it (which ends the pipeline).
+ *
+ * Entries can be added at any time; the first packet processed after a
+ * change compiles the tables: action lists are stored back to back in one
+ * flat array and tables only keep offsets into it, so processing a packet is
+ * one probe per table followed by a scan of its actions.
+ */
+class SlicescopePipeline : public Object
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    /// Returned when no egress port was selected
+    static constexpr uint32_t NO_PORT = 0xffffffff;
+
+    /// Match field for the ingress port, on top of the FlowKey::Field values
+    static constexpr uint32_t IN_PORT = 1 << 6;
+
+    /// How a table matches its key
+    enum MatchKind
+    {
+        EXACT,  //!< exact match on the selected fields
+        LPM,    //!< longest-prefix match on one address
+        TERNARY //!< value/mask match, highest priority wins
+    };
+
+    /// Primitive actions
+    enum ActionType
+    {
+        NO_ACTION,   //!< do nothing
+        SET_DSCP,    //!< set the DSCP to the value
+        SET_EGRESS,  //!< send through the bridged port of the value index
+        PUSH_HEADER, //!< insert or update the header (DSCP in bits 8-15, filter size in 0-7)
+        POP_HEADER,  //!< remove the slicescope header
+        MARK,        //!< set ECN to CE
+        COUNT,       //!< increment the counter of the value index
+        DROP         //!< drop the packet and stop the pipeline
+    };
+
+    /// A primitive action and its argument
+    struct Action
+    {
+        ActionType type; //!< action type
+        uint32_t value;  //!< action argument
+
+        /**
+         * \brief Constructor
+         * \param type the action type
+         * \param value the action argument
+         */
+        Action(ActionType type = NO_ACTION, uint32_t value = 0);
+    };
+
+    /// Match key of a packet
+    struct Key
+    {
+        FlowKey flow;    //!< flow key of the packet
+        uint32_t inPort; //!< index of the ingress port
+
+        Key();
+    };
+
+    /// Outcome of the pipeline for one packet
+    struct Result
+    {
+        bool drop;           //!< true if the packet must be dropped
+        uint32_t egressPort; //!< bridged port to send the packet to, or NO_PORT
+        int16_t dscp;        //!< new DSCP, or -1 if unchanged
+        bool mark;           //!< true if ECN must be set to CE
+        bool pop;            //!< true if the slicescope header must be removed
+        bool push;           //!< true if a slicescope header must be inserted
+        uint8_t pushDscp;    //!< DSCP field of the inserted header
+        uint8_t pushFilter;  //!< path filter size of the inserted header, in bytes
+        bool cacheable;      //!< false if COUNT actions ran, which a cache would skip
+
+        Result();
+
+        /// \returns true if the packet bytes have to be rewritten
+        bool Rewrites() const;
+    };
+
+    SlicescopePipeline();
+    ~SlicescopePipeline() override;
+
+    /**
+     * \brief Append a table to the pipeline
+     * \param name the table name, used in logs
+     * \param kind how the table matches
+     * \param fields FlowKey::Field values and IN_PORT the table matches on;
+     * LPM tables take exactly one of SRC_ADDRESS and DST_ADDRESS
+     * \param defaultActions actions applied when no entry matches
+     * \returns the table identifier
+     */
+    uint32_t AddTable(const std::string& name,
+                      MatchKind kind,
+                      uint32_t fields,
+                      const std::vector<Action>& defaultActions = std::vector<Action>());
+
+    /**
+     * \brief Add an entry to an EXACT table
+     * \param table the table identifier
+     * \param key the key; fields the table does not match on are ignored
+     * \param actions the actions of the entry
+     */
+    void AddExactEntry(uint32_t table, const Key& key, const std::vector<Action>& actions);
+
+    /**
+     * \brief Add an entry to an LPM table
+     * \param table the table identifier
+     * \param network the network
+     * \param mask the network mask
+     * \param actions the actions of the entry
+     */
+    void AddLpmEntry(uint32_t table,
+                     Ipv4Address network,
+                     Ipv4Mask mask,
+                     const std::vector<Action>& actions);
+
+    /**
+     * \brief Add an entry to a TERNARY table
+     * \param table the table identifier
+     * \param value the values to match
+     * \param mask the bits of each field that must be equal to the value
+     * \param priority entries with a higher priority are matched first
+     * \param actions the actions of the entry
+     */
+    void AddTernaryEntry(uint32_t table,
+                         const Key& value,
+                         const Key& mask,
+                         uint32_t priority,
+                         const std::vector<Action>& actions);
+
+    /**
+     * \brief Run the pipeline
+     * \param key the key of the packet
+     * \param size the packet size, for the byte counters
+     * \returns what to do with the packet
+     */
+    Result Process(Key key, uint32_t size);
+
+    /// \returns the number of tables
+    uint32_t GetNTables() const;
+
+    /**
+     * \returns a value that changes whenever tables or entries are added, and
+     * differs between pipelines, so that cached results can be invalidated
+     */
+    uint64_t GetVersion() const;
+
+    /**
+     * \param table the table identifier
+     * \returns the number of packets that matched an entry of the table
+     */
+    uint64_t GetTableHits(uint32_t table) const;
+
+    /**
+     * \param table the table identifier
+     * \returns the number of packets that took the default actions of the table
+     */
+    uint64_t GetTableMisses(uint32_t table) const;
+
+    /**
+     * \param counter the counter index given to a COUNT action
+     * \returns the number of packets counted
+     */
+    uint64_t GetCounterPackets(uint32_t counter) const;
+
+    /**
+     * \param counter the counter index given to a COUNT action
+     * \returns the number of bytes counted
+     */
+    uint64_t GetCounterBytes(uint32_t counter) const;
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    /// Key fields packed in two words, so that masking and hashing are cheap
+    struct PackedKey
+    {
+        uint64_t addresses; //!< source address (high half) and destination address
+        uint64_t others;    //!< ports, protocol, DSCP and ingress port
+
+        /// \returns true if both words are equal
+        bool operator==(const PackedKey& other) const;
+    };
+
+    /// Hash of a PackedKey
+    struct PackedKeyHash
+    {
+        /**
+         * \param key the key
+         * \returns the hash of the key
+         */
+        size_t operator()(const PackedKey& key) const;
+    };
+
+    /// Entry of a TERNARY table
+    struct TernaryEntry
+    {
+        PackedKey value;   //!< masked value
+        PackedKey mask;    //!< mask
+        uint32_t priority; //!< priority
+        uint32_t actions;  //!< offset of the action list
+    };
+
+    /// A table and its entries
+    struct Table
+    {
+        std::string name;                                             //!< table name
+        MatchKind kind;                                               //!< match kind
+        PackedKey fieldMask;                                          //!< mask of the fields
+        bool matchSource;                                             //!< LPM matches the source
+        uint32_t defaultActions;                                      //!< default action list
+        std::unordered_map<PackedKey, uint32_t, PackedKeyHash> exact; //!< EXACT entries
+        Ipv4LpmTable lpm;                                             //!< LPM entries
+        std::vector<TernaryEntry> ternary;                            //!< TERNARY entries
+        uint64_t hits;                                                //!< packets hitting an entry
+        uint64_t misses;                                              //!< packets missing all
+    };
+
+    /**
+     * \brief Pack the fields of a key
+     * \param key the key
+     * \returns the packed key
+     */
+    static PackedKey Pack(const Key& key);
+
+    /**
+     * \brief Pack a FlowKey::Field/IN_PORT bitmask as an all-ones mask of the fields
+     * \param fields the field bitmask
+     * \returns the packed mask
+     */
+    static PackedKey PackFields(uint32_t fields);
+
+    /**
+     * \brief Append an action list to the flat action array
+     * \param actions the actions
+     * \returns the offset of the list
+     */
+    uint32_t AddActions(const std::vector<Action>& actions);
+
+    /// Sort the ternary entries and size the counters
+    void Compile();
+
+    /**
+     * \param table the table identifier
+     * \returns the table, asserting that it exists
+     */
+    Table& GetTable(uint32_t table);
+
+    /// Marks the tables as changed
+    void Changed();
+
+    std::vector<Table> m_tables;          //!< tables, in pipeline order
+    std::vector<Action> m_actions;        //!< action lists, each ending with NO_ACTION
+    std::vector<uint64_t> m_counterPkts;  //!< packets per COUNT index
+    std::vector<uint64_t> m_counterBytes; //!< bytes per COUNT index
+    bool m_compiled;                      //!< false if entries changed since Compile()
+    uint64_t m_version;                   //!< see GetVersion()
+};
+
+} // namespace ns3
+
+#endif /* SLICESCOPE_PIPELINE_H */
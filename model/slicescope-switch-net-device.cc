@@ -1,16 +1,27 @@
 #include "slicescope-switch-net-device.h"
 
+#include "custom-queue-disc.h"
+#include "metadata-tag.h"
+#include "postcard-exporter.h"
+#include "sflow-agent.h"
 #include "slicescope-header.h"
+#include "slicescope-tag.h"
 
 #include "ns3/boolean.h"
 #include "ns3/channel.h"
+#include "ns3/data-rate.h"
+#include "ns3/enum.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/ipv4-l3-protocol.h"
 #include "ns3/log.h"
 #include "ns3/node.h"
 #include "ns3/packet.h"
+#include "ns3/pointer.h"
+#include "ns3/queue.h"
 #include "ns3/simulator.h"
+#include "ns3/trace-source-accessor.h"
 #include "ns3/udp-header.h"
+#include "ns3/udp-l4-protocol.h"
 #include "ns3/uinteger.h"
 
 /**
@@ -48,245 +59,1794 @@ SlicescopeSwitchNetDevice::GetTypeId()
             .AddAttribute("ExpirationTime",
                           "Time it takes for learned MAC state entry to expire.",
                           TimeValue(Seconds(300)),
-                          MakeTimeAccessor(&SlicescopeSwitchNetDevice::m_expirationTime),
+                          MakeTimeAccessor(&SlicescopeSwitchNetDevice::SetExpirationTime,
+                                           &SlicescopeSwitchNetDevice::GetExpirationTime),
                           MakeTimeChecker())
+            .AddAttribute("LearningTableCapacity",
+                          "Number of learned MAC entries held before the table grows.",
+                          UintegerValue(1024),
+                          MakeUintegerAccessor(
+                              &SlicescopeSwitchNetDevice::SetLearningTableCapacity,
+                              &SlicescopeSwitchNetDevice::GetLearningTableCapacity),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("LearningTableWheelSlots",
+                          "Number of timer wheel slots used to age learned MAC entries.",
+                          UintegerValue(64),
+                          MakeUintegerAccessor(
+                              &SlicescopeSwitchNetDevice::SetLearningTableWheelSlots,
+                              &SlicescopeSwitchNetDevice::GetLearningTableWheelSlots),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("LearningTableOccupancy",
+                          "Number of valid entries in the MAC learning table.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(
+                              &SlicescopeSwitchNetDevice::GetLearningTableOccupancy),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("LearningTableHits",
+                          "Number of MAC lookups that hit a learned entry.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&SlicescopeSwitchNetDevice::GetLearningTableHits),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("LearningTableMisses",
+                          "Number of MAC lookups that did not find a learned entry.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&SlicescopeSwitchNetDevice::GetLearningTableMisses),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("LearningTableEvictions",
+                          "Number of learned MAC entries removed because they expired.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(
+                              &SlicescopeSwitchNetDevice::GetLearningTableEvictions),
+                          MakeUintegerChecker<uint64_t>())
             .AddAttribute("EnableLayer3",
                           "Enable processing at Layer 3",
                           BooleanValue(true),
                           MakeBooleanAccessor(&SlicescopeSwitchNetDevice::m_enableLayer3),
-                          MakeBooleanChecker());
+                          MakeBooleanChecker())
+            .AddAttribute("ForwardingMode",
+                          "How the output port of unicast IPv4 frames is selected: by MAC "
+                          "learning, or by longest-prefix match on the destination address "
+                          "(unrouted frames are dropped instead of flooded)",
+                          EnumValue(SlicescopeSwitchNetDevice::LEARNING),
+                          MakeEnumAccessor<ForwardingMode>(
+                              &SlicescopeSwitchNetDevice::m_forwardingMode),
+                          MakeEnumChecker<ForwardingMode>(SlicescopeSwitchNetDevice::LEARNING,
+                                                          "Learning",
+                                                          SlicescopeSwitchNetDevice::LPM,
+                                                          "Lpm"))
+            .AddAttribute("EcmpHashFields",
+                          "Bitmask of the FlowKey fields hashed to select an ECMP group "
+                          "member (1: source address, 2: destination address, 4: protocol, "
+                          "8: source port, 16: destination port, 32: DSCP)",
+                          UintegerValue(FlowKey::ALL_FIELDS),
+                          MakeUintegerAccessor(&SlicescopeSwitchNetDevice::m_ecmpHashFields),
+                          MakeUintegerChecker<uint32_t>(0, FlowKey::ALL_FIELDS))
+            .AddAttribute("EcmpHashSeed",
+                          "Seed of the ECMP hash; give switches different seeds to avoid "
+                          "polarization across tiers",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&SlicescopeSwitchNetDevice::m_ecmpHashSeed),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("FlowletTimeout",
+                          "Idle gap after which a flow may move to another ECMP group "
+                          "member; zero pins every flow to its hashed member",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&SlicescopeSwitchNetDevice::m_flowletTimeout),
+                          MakeTimeChecker())
+            .AddAttribute("FlowletTableSize",
+                          "Number of slots of the flowlet table (rounded up to a power of two).",
+                          UintegerValue(4096),
+                          MakeUintegerAccessor(&SlicescopeSwitchNetDevice::SetFlowletTableSize,
+                                               &SlicescopeSwitchNetDevice::GetFlowletTableSize),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("FloodReplicas",
+                          "Number of port transmissions made by floods.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&SlicescopeSwitchNetDevice::GetFloodReplicas),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("AvoidedCopies",
+                          "Number of transmissions that handed over the switch's own packet "
+                          "instead of a copy.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&SlicescopeSwitchNetDevice::GetAvoidedCopies),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("Pipeline",
+                          "Match-action pipeline run on IPv4 frames. When set, it replaces "
+                          "the built-in slicescope header insertion of EnableLayer3.",
+                          PointerValue(),
+                          MakePointerAccessor(&SlicescopeSwitchNetDevice::m_pipeline),
+                          MakePointerChecker<SlicescopePipeline>())
+            .AddAttribute("FlowCacheCapacity",
+                          "Number of flows (5-tuple, DSCP and ingress port) whose pipeline "
+                          "result is cached, so that later packets of the flow skip the "
+                          "tables; 0 disables the cache. Table hit and miss counters only "
+                          "count the packets that went through the pipeline.",
+                          UintegerValue(1024),
+                          MakeUintegerAccessor(&SlicescopeSwitchNetDevice::SetFlowCacheCapacity,
+                                               &SlicescopeSwitchNetDevice::GetFlowCacheCapacity),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("FlowCacheHits",
+                          "Number of IPv4 packets classified from the flow cache.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&SlicescopeSwitchNetDevice::GetFlowCacheHits),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("FlowCacheMisses",
+                          "Number of IPv4 packets that went through the pipeline.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&SlicescopeSwitchNetDevice::GetFlowCacheMisses),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("FlowCacheEvictions",
+                          "Number of flows evicted from the flow cache.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&SlicescopeSwitchNetDevice::GetFlowCacheEvictions),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("EnableInt",
+                          "Append an in-band telemetry record to the slicescope header of "
+                          "every packet that carries one. The header is then kept up to the "
+                          "receiving host, whose sink decodes the records.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&SlicescopeSwitchNetDevice::m_enableInt),
+                          MakeBooleanChecker())
+            .AddAttribute("IntMaxHops",
+                          "Number of telemetry records a header inserted by this switch can hold.",
+                          UintegerValue(8),
+                          MakeUintegerAccessor(&SlicescopeSwitchNetDevice::m_intMaxHops),
+                          MakeUintegerChecker<uint8_t>())
+            .AddAttribute("SwitchId",
+                          "Identifier written in telemetry records and path filters; 0 uses the "
+                          "node id.",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&SlicescopeSwitchNetDevice::m_switchId),
+                          MakeUintegerChecker<uint16_t>())
+            .AddAttribute("PathFilterBytes",
+                          "Size of the path filter of the headers inserted by this switch; "
+                          "when not 0, the switch also records its id (SwitchId) in the path "
+                          "filter of every header it forwards, and headers are kept up to the "
+                          "receiving host, whose sink decodes the paths.",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&SlicescopeSwitchNetDevice::m_pathFilterBytes),
+                          MakeUintegerChecker<uint8_t>())
+            .AddAttribute("IntRecordsSkipped",
+                          "Number of telemetry records not appended because the hop limit "
+                          "of the header was reached.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&SlicescopeSwitchNetDevice::m_intRecordsSkipped),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("PostcardExporter",
+                          "Exporter sending postcard reports about the IPv4 frames this "
+                          "switch sends, if any.",
+                          PointerValue(),
+                          MakePointerAccessor(&SlicescopeSwitchNetDevice::m_postcardExporter),
+                          MakePointerChecker<PostcardExporter>())
+            .AddAttribute("SflowAgent",
+                          "Agent sampling the frames received by this switch and polling "
+                          "its port counters, if any.",
+                          PointerValue(),
+                          MakePointerAccessor(&SlicescopeSwitchNetDevice::m_sflowAgent),
+                          MakePointerChecker<SflowAgent>())
+            .AddAttribute("HeavyHitterCount",
+                          "Number of largest flows tracked per slice with a count-min sketch "
+                          "of the bytes received; 0 disables heavy hitter detection.",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&SlicescopeSwitchNetDevice::m_heavyHitterCount),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("HeavyHitterSketchWidth",
+                          "Counters per row of the sketches (rounded up to a power of two).",
+                          UintegerValue(2048),
+                          MakeUintegerAccessor(&SlicescopeSwitchNetDevice::m_heavyHitterWidth),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("HeavyHitterSketchDepth",
+                          "Rows of the sketches.",
+                          UintegerValue(4),
+                          MakeUintegerAccessor(&SlicescopeSwitchNetDevice::m_heavyHitterDepth),
+                          MakeUintegerChecker<uint32_t>(1, HeavyHitterSketch::MAX_DEPTH))
+            .AddAttribute("HeavyHitterInterval",
+                          "Period of the HeavyHitters trace source, after which the sketches "
+                          "start over; 0 counts from the start of the simulation.",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&SlicescopeSwitchNetDevice::m_heavyHitterInterval),
+                          MakeTimeChecker())
+            .AddAttribute("StripAtEdge",
+                          "Remove the slicescope header of packets leaving through an edge "
+                          "port, so that hosts get the UDP payload they were sent. Headers "
+                          "carrying telemetry records (EnableInt) or path filters "
+                          "(PathFilterBytes) are kept.",
+                          BooleanValue(true),
+                          MakeBooleanAccessor(&SlicescopeSwitchNetDevice::m_stripAtEdge),
+                          MakeBooleanChecker())
+            .AddAttribute("EnableSliceScheduling",
+                          "Queue frames per slice (by DSCP) in front of each port that has "
+                          "a transmit queue, and release them with the URLLC/eMBB/mMTC "
+                          "deficit round robin of CustomQueueDisc.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&SlicescopeSwitchNetDevice::m_enableSliceScheduling),
+                          MakeBooleanChecker())
+            .AddAttribute("PolicerColorAware",
+                          "Meter the frames carrying a remark DSCP of a policer with that "
+                          "policer and the color of the DSCP, instead of as green frames.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&SlicescopeSwitchNetDevice::m_policerColorAware),
+                          MakeBooleanChecker())
+            .AddAttribute("PolicerYellowAction",
+                          "What happens to the frames a policer marks yellow.",
+                          EnumValue(SlicescopeSwitchNetDevice::POLICER_PASS),
+                          MakeEnumAccessor<PolicerAction>(
+                              &SlicescopeSwitchNetDevice::m_policerYellowAction),
+                          MakeEnumChecker<PolicerAction>(SlicescopeSwitchNetDevice::POLICER_PASS,
+                                                         "Pass",
+                                                         SlicescopeSwitchNetDevice::POLICER_REMARK,
+                                                         "Remark",
+                                                         SlicescopeSwitchNetDevice::POLICER_DROP,
+                                                         "Drop"))
+            .AddAttribute("PolicerRedAction",
+                          "What happens to the frames a policer marks red.",
+                          EnumValue(SlicescopeSwitchNetDevice::POLICER_DROP),
+                          MakeEnumAccessor<PolicerAction>(
+                              &SlicescopeSwitchNetDevice::m_policerRedAction),
+                          MakeEnumChecker<PolicerAction>(SlicescopeSwitchNetDevice::POLICER_PASS,
+                                                         "Pass",
+                                                         SlicescopeSwitchNetDevice::POLICER_REMARK,
+                                                         "Remark",
+                                                         SlicescopeSwitchNetDevice::POLICER_DROP,
+                                                         "Drop"))
+            .AddAttribute("PoliceTransitPorts",
+                          "Police the frames received from other slicescope switches too, "
+                          "and not only those entering the network through an edge port.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&SlicescopeSwitchNetDevice::m_policeTransitPorts),
+                          MakeBooleanChecker())
+            .AddAttribute("SwitchingMode",
+                          "When a frame may start leaving the switch: once fully received, "
+                          "once its first CutThroughBytes are received, or the latter only "
+                          "while the output port is idle. Cut-through also needs both ports "
+                          "to expose a DataRate, the incoming one being at least as fast. "
+                          "Since ports only hand over whole frames, cut-through saves time "
+                          "only out of the PipelineLatency: with a zero latency, frames "
+                          "leave as in store-and-forward, though counted in CutThroughFrames.",
+                          EnumValue(SlicescopeSwitchNetDevice::STORE_AND_FORWARD),
+                          MakeEnumAccessor<SwitchingMode>(
+                              &SlicescopeSwitchNetDevice::m_switchingMode),
+                          MakeEnumChecker<SwitchingMode>(
+                              SlicescopeSwitchNetDevice::STORE_AND_FORWARD,
+                              "StoreAndForward",
+                              SlicescopeSwitchNetDevice::CUT_THROUGH,
+                              "CutThrough",
+                              SlicescopeSwitchNetDevice::ADAPTIVE_CUT_THROUGH,
+                              "AdaptiveCutThrough"))
+            .AddAttribute("PipelineLatency",
+                          "Time between the forwarding decision point of a frame (its last "
+                          "bit, or its first CutThroughBytes) and its egress. The default is "
+                          "the port-to-port latency of a switching ASIC; zero forwards frames "
+                          "without scheduling an event.",
+                          TimeValue(MicroSeconds(1)),
+                          MakeTimeAccessor(&SlicescopeSwitchNetDevice::m_pipelineLatency),
+                          MakeTimeChecker(Seconds(0)))
+            .AddAttribute("CutThroughBytes",
+                          "Bytes of a frame received before a cut-through decision.",
+                          UintegerValue(64),
+                          MakeUintegerAccessor(&SlicescopeSwitchNetDevice::m_cutThroughBytes),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("CutThroughFrames",
+                          "Number of port transmissions forwarded in cut-through.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&SlicescopeSwitchNetDevice::m_cutThroughFrames),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("StoreAndForwardFrames",
+                          "Number of port transmissions forwarded in store-and-forward.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(
+                              &SlicescopeSwitchNetDevice::m_storeAndForwardFrames),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("CounterExportInterval",
+                          "Period of the PortCounters trace source; 0 disables it. No export "
+                          "is scheduled while the switch receives nothing.",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&SlicescopeSwitchNetDevice::m_counterExportInterval),
+                          MakeTimeChecker())
+            .AddTraceSource(
+                "PortCounters",
+                "Snapshot of the port counters, every CounterExportInterval.",
+                MakeTraceSourceAccessor(&SlicescopeSwitchNetDevice::m_portCountersTrace),
+                "ns3::SlicescopeSwitchNetDevice::PortCountersTracedCallback")
+            .AddTraceSource(
+                "HeavyHitters",
+                "Largest flows of each slice, every HeavyHitterInterval.",
+                MakeTraceSourceAccessor(&SlicescopeSwitchNetDevice::m_heavyHittersTrace),
+                "ns3::SlicescopeSwitchNetDevice::HeavyHittersTracedCallback");
     return tid;
 }
 
-SlicescopeSwitchNetDevice::SlicescopeSwitchNetDevice()
-    : m_node(nullptr),
-      m_ifIndex(0)
+SlicescopeSwitchNetDevice::SlicescopeSwitchNetDevice()
+    : m_flowCacheVersion(0),
+      m_node(nullptr),
+      m_ecmpHashFields(FlowKey::ALL_FIELDS),
+      m_ecmpHashSeed(0),
+      m_floodReplicas(0),
+      m_avoidedCopies(0),
+      m_switchingMode(STORE_AND_FORWARD),
+      m_pipelineLatency(MicroSeconds(1)),
+      m_cutThroughBytes(64),
+      m_cutThroughFrames(0),
+      m_storeAndForwardFrames(0),
+      m_sliceWeights({80, 15, 5}),
+      m_enableSliceScheduling(false),
+      m_stripAtEdge(true),
+      m_policerColorAware(false),
+      m_policerYellowAction(POLICER_PASS),
+      m_policerRedAction(POLICER_DROP),
+      m_policeTransitPorts(false),
+      m_enableInt(false),
+      m_intMaxHops(8),
+      m_switchId(0),
+      m_intRecordsSkipped(0),
+      m_pathFilterBytes(0),
+      m_heavyHitterCount(0),
+      m_heavyHitterWidth(2048),
+      m_heavyHitterDepth(4),
+      m_heavyHitterDumpPending(false),
+      m_portCounters(1, PortCounters()),
+      m_counterExportPending(false),
+      m_ifIndex(0)
+{
+    NS_LOG_FUNCTION_NOARGS();
+    m_channel = CreateObject<BridgeChannel>();
+    m_policerByDscp.fill(-1);
+    m_preColorByDscp.fill(TrTcmPolicer::GREEN);
+    UpdateFloodPorts();
+}
+
+SlicescopeSwitchNetDevice::~SlicescopeSwitchNetDevice()
+{
+    NS_LOG_FUNCTION_NOARGS();
+}
+
+void
+SlicescopeSwitchNetDevice::DoDispose()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    for (auto iter = m_ports.begin(); iter != m_ports.end(); iter++)
+    {
+        *iter = nullptr;
+    }
+    m_ports.clear();
+    m_learningTable.Clear();
+    m_routes.Clear();
+    m_ecmpGroups.clear();
+    m_ecmpGroupOfPort.clear();
+    m_floodPorts.clear();
+    m_pipeline = nullptr;
+    m_flowCache.Clear();
+    m_portTxQueues.clear();
+    m_portRoles.clear();
+    m_portBitRates.clear();
+    m_framesInPipeline.clear();
+    m_sliceEgress.clear();
+    m_policers.clear();
+    m_postcardExporter = nullptr;
+    m_sflowAgent = nullptr;
+    m_heavyHitters.clear();
+    m_portCounters.clear();
+    m_channel = nullptr;
+    m_node = nullptr;
+    NetDevice::DoDispose();
+}
+
+void
+SlicescopeSwitchNetDevice::ReceiveFromDevice(Ptr<NetDevice> incomingPort,
+                                             Ptr<const Packet> packet,
+                                             uint16_t protocol,
+                                             const Address& src,
+                                             const Address& dst,
+                                             PacketType packetType)
+{
+    NS_LOG_FUNCTION_NOARGS();
+    NS_LOG_DEBUG("UID is " << packet->GetUid());
+
+    Mac48Address src48 = Mac48Address::ConvertFrom(src);
+    Mac48Address dst48 = Mac48Address::ConvertFrom(dst);
+
+    if (!m_promiscRxCallback.IsNull())
+    {
+        m_promiscRxCallback(this, packet, protocol, src, dst, packetType);
+    }
+
+    uint32_t incomingIndex = GetPortIndex(incomingPort);
+    CountRx(incomingIndex, packet->GetSize());
+    if (m_sflowAgent && m_sflowAgent->Sample(incomingIndex))
+    {
+        SampleFrame(packet, protocol, incomingIndex);
+    }
+    if (packetType == PACKET_HOST && dst48 != m_address)
+    {
+        m_portCounters[incomingIndex].drops[DROP_NOT_FOR_SWITCH]++;
+        return;
+    }
+    // Counted once per frame received, before policing, replication or header insertion
+    if (m_heavyHitterCount && protocol == Ipv4L3Protocol::PROT_NUMBER)
+    {
+        UpdateHeavyHitters(packet);
+    }
+    if (!m_policers.empty() && protocol == Ipv4L3Protocol::PROT_NUMBER &&
+        !Police(incomingIndex, packet))
+    {
+        return;
+    }
+
+    // Frames that are only forwarded are passed on untouched; the packet is
+    // copied only when the slicescope header has to be inserted. That copy
+    // belongs to the switch and can be handed over to an output port as is.
+    Ptr<const Packet> frame = packet;
+    if (protocol == Ipv4L3Protocol::PROT_NUMBER &&
+        (m_enableLayer3 || m_forwardingMode == LPM || m_pipeline))
+    {
+        Ipv4Header ipv4Header;
+        Ipv4Address ipv4Dst;
+        uint32_t egressPort = SlicescopePipeline::NO_PORT;
+        if (m_pipeline)
+        {
+            // The flow key is read from the raw bytes; the IPv4 header is
+            // only deserialized when the packet has to be rewritten
+            SlicescopePipeline::Key key;
+            key.flow.Extract(packet);
+            key.inPort = incomingIndex;
+            SlicescopePipeline::Result result = Classify(key, packet->GetSize());
+            if (result.drop)
+            {
+                NS_LOG_LOGIC("Pipeline dropped UID " << packet->GetUid());
+                m_portCounters[incomingIndex].drops[DROP_PIPELINE]++;
+                return;
+            }
+            if (result.Rewrites())
+            {
+                packet->PeekHeader(ipv4Header);
+                frame = RewriteIpv4Packet(packet, ipv4Header, result);
+            }
+            egressPort = result.egressPort;
+            ipv4Dst = Ipv4Address(key.flow.dstAddress);
+        }
+        else
+        {
+            // Only the ingress edge switch inserts the slicescope header, so
+            // transit hops and non-UDP packets are forwarded on the raw bytes
+            // too, without deserializing the IPv4 header
+            FlowKey flow;
+            SlicescopeTag slicescopeTag;
+            if (!flow.Extract(packet))
+            {
+                packet->PeekHeader(ipv4Header);
+                flow.dstAddress = ipv4Header.GetDestination().Get();
+            }
+            else if (m_enableLayer3 && flow.protocol == UdpL4Protocol::PROT_NUMBER &&
+                     !packet->PeekPacketTag(slicescopeTag))
+            {
+                packet->PeekHeader(ipv4Header);
+                frame = InsertSlicescopeHeader(packet, ipv4Header);
+            }
+            ipv4Dst = Ipv4Address(flow.dstAddress);
+        }
+
+        bool forwarded = packetType == PACKET_OTHERHOST && dst48 != m_address;
+        if (forwarded && egressPort != SlicescopePipeline::NO_PORT)
+        {
+            Learn(src48, incomingPort);
+            ForwardToPort(incomingPort, egressPort, frame, frame != packet, protocol, src48, dst48);
+            return;
+        }
+        if (forwarded && m_forwardingMode == LPM)
+        {
+            Learn(src48, incomingPort);
+            ForwardRouted(incomingPort, frame, frame != packet, protocol, src48, dst48, ipv4Dst);
+            return;
+        }
+    }
+
+    switch (packetType)
+    {
+    case PACKET_HOST:
+        Learn(src48, incomingPort);
+        CountTx(m_ports.size(), frame->GetSize());
+        m_rxCallback(this, frame, protocol, src);
+        break;
+
+    case PACKET_BROADCAST:
+    case PACKET_MULTICAST:
+        CountTx(m_ports.size(), frame->GetSize());
+        m_rxCallback(this, frame, protocol, src);
+        ForwardBroadcast(incomingPort, frame, protocol, src48, dst48);
+        break;
+
+    case PACKET_OTHERHOST:
+        if (dst48 == m_address)
+        {
+            Learn(src48, incomingPort);
+            CountTx(m_ports.size(), frame->GetSize());
+            m_rxCallback(this, frame, protocol, src);
+        }
+        else
+        {
+            ForwardUnicast(incomingPort, frame, frame != packet, protocol, src48, dst48);
+        }
+        break;
+    }
+}
+
+Ptr<const Packet>
+SlicescopeSwitchNetDevice::InsertSlicescopeHeader(Ptr<const Packet> packet, Ipv4Header ipv4Header)
+{
+    NS_LOG_FUNCTION_NOARGS();
+
+    uint8_t ipProtocol = ipv4Header.GetProtocol();
+    NS_LOG_INFO("*** Node" << m_node->GetId() << " ***");
+    NS_LOG_INFO("IPv4 Source: " << ipv4Header.GetSource() << " Destination: "
+                                << ipv4Header.GetDestination()
+                                << " Protocol: " << (uint32_t)ipProtocol);
+
+    // Transit hop: the ingress edge switch already inserted the header
+    SlicescopeTag slicescopeTag;
+    if (packet->PeekPacketTag(slicescopeTag))
+    {
+        return packet;
+    }
+
+    SlicescopePipeline::Result result;
+    result.push = true;
+    result.pushDscp = 42;     // New DSCP value
+    result.pushFilter = m_pathFilterBytes;
+    return RewriteIpv4Packet(packet, ipv4Header, result);
+}
+
+Ptr<const Packet>
+SlicescopeSwitchNetDevice::RewriteIpv4Packet(Ptr<const Packet> packet,
+                                             Ipv4Header ipv4Header,
+                                             const SlicescopePipeline::Result& result)
+{
+    NS_LOG_FUNCTION_NOARGS();
+    // A header inserted upstream is updated in place rather than stacked
+    // with a new one, so the packet grows once whatever the number of hops
+    SlicescopeTag slicescopeTag;
+    bool udp = ipv4Header.GetProtocol() == UdpL4Protocol::PROT_NUMBER;
+    bool present = udp && packet->PeekPacketTag(slicescopeTag);
+    bool push = result.push && udp && !present;
+    bool update = result.push && present;
+    bool pop = result.pop && present;
+    if (!push && !update && !pop && result.dscp < 0 && !result.mark)
+    {
+        return packet;
+    }
+
+    // The IPv4 header has already been parsed by the caller, so only the
+    // bytes are dropped here instead of deserializing it a second time.
+    Ptr<Packet> frame = packet->Copy();
+    frame->RemoveAtStart(ipv4Header.GetSerializedSize());
+    if (result.dscp >= 0)
+    {
+        ipv4Header.SetDscp(static_cast<Ipv4Header::DscpType>(result.dscp));
+    }
+    if (result.mark)
+    {
+        ipv4Header.SetEcn(Ipv4Header::ECN_CE);
+    }
+
+    if (update)
+    {
+        // Same size before and after: the UDP and IPv4 lengths stay valid
+        UdpHeader udpHeader;
+        frame->RemoveHeader(udpHeader);
+        SlicescopeHeader slicescopeHeader;
+        frame->RemoveHeader(slicescopeHeader);
+        // The path filter keeps the switches recorded so far
+        slicescopeHeader.SetDscp(result.pushDscp);
+        frame->AddHeader(slicescopeHeader);
+        frame->AddHeader(udpHeader);
+    }
+    else if (push || pop)
+    {
+        UdpHeader udpHeader;
+        frame->RemoveHeader(udpHeader);
+        uint32_t udpPayloadSize = frame->GetSize();
+
+        if (pop)
+        {
+            SlicescopeHeader slicescopeHeader;
+            frame->RemoveHeader(slicescopeHeader);
+            frame->RemovePacketTag(slicescopeTag);
+        }
+        else
+        {
+            SlicescopeHeader slicescopeHeader;
+            slicescopeHeader.SetDscp(result.pushDscp);
+            slicescopeHeader.SetPathFilterSize(result.pushFilter);
+            if (m_enableInt)
+            {
+                slicescopeHeader.SetMaxHops(m_intMaxHops);
+            }
+            NS_LOG_INFO("Adding slicescope header. Previous size: "
+                        << frame->GetSize() << " New size: "
+                        << frame->GetSize() + slicescopeHeader.GetSerializedSize());
+            frame->AddHeader(slicescopeHeader);
+            frame->AddPacketTag(slicescopeTag);
+        }
+
+        // Update UDP length (header plus the new payload)
+        udpHeader.ForcePayloadSize(udpHeader.GetSerializedSize() + frame->GetSize());
+        frame->AddHeader(udpHeader);
+
+        // Update IPv4 length
+        ipv4Header.SetPayloadSize(ipv4Header.GetPayloadSize() - udpPayloadSize + frame->GetSize());
+    }
+    frame->AddHeader(ipv4Header);
+
+    return frame;
+}
+
+void
+SlicescopeSwitchNetDevice::ForwardUnicast(Ptr<NetDevice> incomingPort,
+                                          Ptr<const Packet> packet,
+                                          bool owned,
+                                          uint16_t protocol,
+                                          Mac48Address src,
+                                          Mac48Address dst)
+{
+    NS_LOG_FUNCTION_NOARGS();
+    NS_LOG_DEBUG("LearningBridgeForward (incomingPort="
+                 << incomingPort->GetInstanceTypeId().GetName() << ", packet=" << packet
+                 << ", protocol=" << protocol << ", src=" << src << ", dst=" << dst << ")");
+
+    Learn(src, incomingPort);
+    uint32_t incomingIndex = GetPortIndex(incomingPort);
+    uint32_t outIndex = GetLearnedPortIndex(dst);
+    if (outIndex != MacLearningTable::NO_PORT)
+    {
+        m_portCounters[incomingIndex].learnedHits++;
+    }
+    else
+    {
+        m_portCounters[incomingIndex].learnedMisses++;
+    }
+    if (outIndex != MacLearningTable::NO_PORT && !IsSamePort(outIndex, incomingIndex))
+    {
+        outIndex = SelectEcmpPort(outIndex, packet, protocol, src, dst);
+        Ptr<NetDevice> outPort = m_ports[outIndex];
+        NS_LOG_LOGIC("Learning bridge state says to use port `"
+                     << outPort->GetInstanceTypeId().GetName() << "'");
+        SendThroughPort(incomingIndex, outIndex, TakeOrCopy(packet, owned), protocol, src, dst);
+    }
+    else
+    {
+        NS_LOG_LOGIC("No learned state: send through all ports");
+        Flood(incomingIndex, packet, owned, protocol, src, dst);
+    }
+}
+
+void
+SlicescopeSwitchNetDevice::ForwardRouted(Ptr<NetDevice> incomingPort,
+                                         Ptr<const Packet> packet,
+                                         bool owned,
+                                         uint16_t protocol,
+                                         Mac48Address src,
+                                         Mac48Address dst,
+                                         Ipv4Address ipv4Dst)
+{
+    NS_LOG_FUNCTION_NOARGS();
+    uint32_t portIndex = m_routes.Lookup(ipv4Dst);
+    if (portIndex == Ipv4LpmTable::NO_ROUTE)
+    {
+        NS_LOG_LOGIC("No route to " << ipv4Dst << ": dropping (UID " << packet->GetUid() << ")");
+        m_portCounters[GetPortIndex(incomingPort)].drops[DROP_NO_ROUTE]++;
+        return;
+    }
+    ForwardToPort(incomingPort, portIndex, packet, owned, protocol, src, dst);
+}
+
+void
+SlicescopeSwitchNetDevice::ForwardToPort(Ptr<NetDevice> incomingPort,
+                                         uint32_t portIndex,
+                                         Ptr<const Packet> packet,
+                                         bool owned,
+                                         uint16_t protocol,
+                                         Mac48Address src,
+                                         Mac48Address dst)
+{
+    NS_LOG_FUNCTION_NOARGS();
+    uint32_t incomingIndex = GetPortIndex(incomingPort);
+    if (portIndex >= m_ports.size())
+    {
+        NS_LOG_LOGIC("Port " << portIndex << " does not exist: dropping (UID " << packet->GetUid()
+                             << ")");
+        m_portCounters[incomingIndex].drops[DROP_BAD_PORT]++;
+        return;
+    }
+    if (IsSamePort(portIndex, incomingIndex))
+    {
+        NS_LOG_LOGIC("Port " << portIndex << " leads back to the incoming port: dropping");
+        m_portCounters[incomingIndex].drops[DROP_SAME_PORT]++;
+        return;
+    }
+    portIndex = SelectEcmpPort(portIndex, packet, protocol, src, dst);
+    NS_LOG_LOGIC("Sending UID " << packet->GetUid() << " through port " << portIndex);
+    SendThroughPort(incomingIndex, portIndex, TakeOrCopy(packet, owned), protocol, src, dst);
+}
+
+void
+SlicescopeSwitchNetDevice::ForwardBroadcast(Ptr<NetDevice> incomingPort,
+                                            Ptr<const Packet> packet,
+                                            uint16_t protocol,
+                                            Mac48Address src,
+                                            Mac48Address dst)
+{
+    NS_LOG_FUNCTION_NOARGS();
+    NS_LOG_DEBUG("LearningBridgeForward (incomingPort="
+                 << incomingPort->GetInstanceTypeId().GetName() << ", packet=" << packet
+                 << ", protocol=" << protocol << ", src=" << src << ", dst=" << dst << ")");
+    Learn(src, incomingPort);
+
+    // The packet was also passed up to the receive callback, so it is never owned
+    Flood(GetPortIndex(incomingPort), packet, false, protocol, src, dst);
+}
+
+void
+SlicescopeSwitchNetDevice::Flood(uint32_t incomingIndex,
+                                 Ptr<const Packet> packet,
+                                 bool owned,
+                                 uint16_t protocol,
+                                 const Address& src,
+                                 const Address& dst)
+{
+    NS_LOG_FUNCTION_NOARGS();
+    uint32_t slot = incomingIndex == MacLearningTable::NO_PORT ? m_ports.size() : incomingIndex;
+    m_portCounters[slot].floods++;
+    const std::vector<uint32_t>& ports = m_floodPorts[slot];
+    if (ports.empty())
+    {
+        return;
+    }
+    NS_LOG_LOGIC("Flooding UID " << packet->GetUid() << " through " << ports.size() << " ports");
+
+    // Every port but the last gets a shallow copy; the last one may take the
+    // packet itself, which must therefore not be touched before the copies are made
+    uint32_t last = ports.size() - 1;
+    for (uint32_t i = 0; i < last; i++)
+    {
+        SendThroughPort(incomingIndex, ports[i], packet->Copy(), protocol, src, dst);
+    }
+    SendThroughPort(incomingIndex, ports[last], TakeOrCopy(packet, owned), protocol, src, dst);
+    m_floodReplicas += ports.size();
+}
+
+void
+SlicescopeSwitchNetDevice::SendThroughPort(uint32_t incomingIndex,
+                                           uint32_t portIndex,
+                                           Ptr<Packet> packet,
+                                           uint16_t protocol,
+                                           const Address& src,
+                                           const Address& dst)
+{
+    Time delay = GetForwardingDelay(incomingIndex, portIndex, packet->GetSize());
+    if (delay.IsStrictlyPositive())
+    {
+        m_framesInPipeline[portIndex]++;
+        Simulator::Schedule(delay,
+                            &SlicescopeSwitchNetDevice::LeavePipeline,
+                            this,
+                            incomingIndex,
+                            portIndex,
+                            packet,
+                            protocol,
+                            src,
+                            dst);
+        return;
+    }
+    QueueThroughPort(incomingIndex, portIndex, packet, protocol, src, dst);
+}
+
+void
+SlicescopeSwitchNetDevice::LeavePipeline(uint32_t incomingIndex,
+                                         uint32_t portIndex,
+                                         Ptr<Packet> packet,
+                                         uint16_t protocol,
+                                         const Address& src,
+                                         const Address& dst)
+{
+    m_framesInPipeline[portIndex]--;
+    QueueThroughPort(incomingIndex, portIndex, packet, protocol, src, dst);
+}
+
+Time
+SlicescopeSwitchNetDevice::GetForwardingDelay(uint32_t incomingIndex,
+                                              uint32_t portIndex,
+                                              uint32_t size)
+{
+    // Frames sent by the switch itself have no incoming port to overlap with
+    bool cutThrough = m_switchingMode != STORE_AND_FORWARD &&
+                      incomingIndex != MacLearningTable::NO_PORT &&
+                      m_portBitRates[incomingIndex] &&
+                      m_portBitRates[incomingIndex] >= m_portBitRates[portIndex];
+    if (cutThrough && m_switchingMode == ADAPTIVE_CUT_THROUGH)
+    {
+        // Frames still in the pipeline will reach the port first
+        cutThrough = GetEgressQueueDepth(portIndex) == 0 && m_framesInPipeline[portIndex] == 0;
+    }
+    if (!cutThrough)
+    {
+        m_storeAndForwardFrames++;
+        return m_pipelineLatency;
+    }
+
+    m_cutThroughFrames++;
+    uint32_t tail = size > m_cutThroughBytes ? size - m_cutThroughBytes : 0;
+    Time tailTime = DataRate(m_portBitRates[incomingIndex]).CalculateBytesTxTime(tail);
+    return m_pipelineLatency > tailTime ? m_pipelineLatency - tailTime : Time(0);
+}
+
+void
+SlicescopeSwitchNetDevice::QueueThroughPort(uint32_t incomingIndex,
+                                            uint32_t portIndex,
+                                            Ptr<Packet> packet,
+                                            uint16_t protocol,
+                                            const Address& src,
+                                            const Address& dst)
+{
+    if (!m_enableSliceScheduling || !m_portTxQueues[portIndex])
+    {
+        TransmitThroughPort(incomingIndex, portIndex, packet, protocol, src, dst);
+        return;
+    }
+
+    SliceEgress& egress = m_sliceEgress[portIndex];
+    if (!egress.traced)
+    {
+        m_portTxQueues[portIndex]->TraceConnectWithoutContext(
+            "Dequeue",
+            MakeBoundCallback(&SlicescopeSwitchNetDevice::NotifyPortDequeue, this, portIndex));
+        egress.traced = true;
+    }
+    uint8_t dscp = 0;
+    uint8_t bytes[2];
+    if (protocol == Ipv4L3Protocol::PROT_NUMBER && packet->CopyData(bytes, 2) == 2)
+    {
+        dscp = bytes[1] >> 2;
+    }
+    SliceScheduler::Item item = {packet, incomingIndex, protocol, src, dst};
+    if (!egress.scheduler.Enqueue(m_dscpQueueMap.GetQueueIndex(dscp), item))
+    {
+        uint32_t slot = incomingIndex == MacLearningTable::NO_PORT ? m_ports.size() : incomingIndex;
+        m_portCounters[slot].drops[DROP_SLICE_QUEUE]++;
+        return;
+    }
+    TransmitFromSliceQueues(portIndex);
+}
+
+void
+SlicescopeSwitchNetDevice::TransmitFromSliceQueues(uint32_t portIndex)
+{
+    SliceEgress& egress = m_sliceEgress[portIndex];
+    egress.pending = false;
+    SliceScheduler::Item item;
+    while (m_portTxQueues[portIndex]->GetNPackets() == 0 && egress.scheduler.Dequeue(item))
+    {
+        TransmitThroughPort(item.incomingIndex,
+                            portIndex,
+                            item.packet,
+                            item.protocol,
+                            item.src,
+                            item.dst);
+    }
+}
+
+void
+SlicescopeSwitchNetDevice::NotifyPortDequeue(SlicescopeSwitchNetDevice* device,
+                                             uint32_t portIndex,
+                                             Ptr<const Packet> packet)
+{
+    SliceEgress& egress = device->m_sliceEgress[portIndex];
+    if (!egress.pending && egress.scheduler.GetNPackets() > 0)
+    {
+        egress.pending = true;
+        Simulator::ScheduleNow(&SlicescopeSwitchNetDevice::TransmitFromSliceQueues,
+                               device,
+                               portIndex);
+    }
+}
+
+uint32_t
+SlicescopeSwitchNetDevice::GetEgressQueueDepth(uint32_t portIndex) const
+{
+    uint32_t depth = m_sliceEgress[portIndex].scheduler.GetNPackets();
+    if (m_portTxQueues[portIndex])
+    {
+        depth += m_portTxQueues[portIndex]->GetNPackets();
+    }
+    return depth;
+}
+
+void
+SlicescopeSwitchNetDevice::SetSliceWeights(std::map<Slice::SliceType, uint32_t> weights)
+{
+    NS_LOG_FUNCTION(this);
+    for (const auto& [sliceType, weight] : weights)
+    {
+        auto it = CustomQueueDisc::sliceTypeToQueueIndexMap.find(sliceType);
+        if (it == CustomQueueDisc::sliceTypeToQueueIndexMap.end())
+        {
+            continue;
+        }
+        m_sliceWeights[it->second] = weight;
+        for (auto& egress : m_sliceEgress)
+        {
+            egress.scheduler.SetWeight(it->second, weight);
+        }
+    }
+}
+
+void
+SlicescopeSwitchNetDevice::SetDscpQueueMap(const DscpQueueMap& map)
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT_MSG(map.GetNQueues() <= CustomQueueDisc::queueIndexToSliceTypeMap.size(),
+                  "DSCP mapped to queue " << map.GetNQueues() - 1 << ", not a slice queue");
+    m_dscpQueueMap = map;
+}
+
+const DscpQueueMap&
+SlicescopeSwitchNetDevice::GetDscpQueueMap() const
+{
+    return m_dscpQueueMap;
+}
+
+const SliceScheduler&
+SlicescopeSwitchNetDevice::GetSliceScheduler(uint32_t port) const
+{
+    NS_ASSERT_MSG(port < m_sliceEgress.size(), "Unknown port " << port);
+    return m_sliceEgress[port].scheduler;
+}
+
+void
+SlicescopeSwitchNetDevice::SetPolicer(uint8_t dscp,
+                                      DataRate cir,
+                                      uint32_t cbs,
+                                      DataRate pir,
+                                      uint32_t pbs,
+                                      int16_t yellowDscp,
+                                      int16_t redDscp)
+{
+    NS_LOG_FUNCTION(this << +dscp << cir << cbs << pir << pbs << yellowDscp << redDscp);
+    NS_ASSERT_MSG(dscp < 64 && yellowDscp < 64 && redDscp < 64, "DSCPs have six bits");
+    int16_t index = m_policerByDscp[dscp];
+    if (index < 0 || m_policers[index].dscp != dscp)
+    {
+        index = m_policers.size();
+        m_policers.emplace_back();
+        m_policers[index].dscp = dscp;
+    }
+    DscpPolicer& policer = m_policers[index];
+    policer.meter.Configure(cir, cbs, pir, pbs);
+    policer.remarkDscp[TrTcmPolicer::GREEN] = -1;
+    policer.remarkDscp[TrTcmPolicer::YELLOW] = yellowDscp;
+    policer.remarkDscp[TrTcmPolicer::RED] = redDscp;
+
+    m_policerByDscp[dscp] = index;
+    m_preColorByDscp[dscp] = TrTcmPolicer::GREEN;
+    // Remark DSCPs belong to the policer unless another one was set for them
+    for (uint8_t color = TrTcmPolicer::YELLOW; color < TrTcmPolicer::COLORS; color++)
+    {
+        int16_t remark = policer.remarkDscp[color];
+        if (remark >= 0 && remark != dscp &&
+            (m_policerByDscp[remark] < 0 || m_policers[m_policerByDscp[remark]].dscp != remark))
+        {
+            m_policerByDscp[remark] = index;
+            m_preColorByDscp[remark] = color;
+        }
+    }
+}
+
+void
+SlicescopeSwitchNetDevice::SetSlicePolicer(Slice::SliceType sliceType,
+                                           DataRate cir,
+                                           uint32_t cbs,
+                                           DataRate pir,
+                                           uint32_t pbs,
+                                           int16_t yellowDscp,
+                                           int16_t redDscp)
+{
+    SetPolicer(Slice::sliceTypeToDscpMap.at(sliceType), cir, cbs, pir, pbs, yellowDscp, redDscp);
+}
+
+TrTcmPolicer::Counters
+SlicescopeSwitchNetDevice::GetPolicerCounters(uint8_t dscp) const
+{
+    int16_t index = dscp < 64 ? m_policerByDscp[dscp] : -1;
+    if (index < 0 || m_policers[index].dscp != dscp)
+    {
+        return TrTcmPolicer::Counters{};
+    }
+    return m_policers[index].meter.GetCounters();
+}
+
+bool
+SlicescopeSwitchNetDevice::Police(uint32_t incomingIndex, Ptr<const Packet>& packet)
+{
+    if (!m_policeTransitPorts && GetPortRole(incomingIndex) != EDGE)
+    {
+        return true;
+    }
+    // The DSCP is read from the raw type of service byte of the IPv4 header
+    uint8_t bytes[2];
+    if (packet->CopyData(bytes, 2) < 2)
+    {
+        return true;
+    }
+    uint8_t dscp = bytes[1] >> 2;
+    int16_t index = m_policerByDscp[dscp];
+    if (index < 0)
+    {
+        return true;
+    }
+
+    DscpPolicer& policer = m_policers[index];
+    auto preColor = m_policerColorAware ? static_cast<TrTcmPolicer::Color>(m_preColorByDscp[dscp])
+                                        : TrTcmPolicer::GREEN;
+    TrTcmPolicer::Color color = policer.meter.Meter(Simulator::Now(), packet->GetSize(), preColor);
+    if (color == TrTcmPolicer::GREEN)
+    {
+        return true;
+    }
+    PolicerAction action =
+        color == TrTcmPolicer::YELLOW ? m_policerYellowAction : m_policerRedAction;
+    if (action == POLICER_DROP)
+    {
+        NS_LOG_LOGIC("Policer of DSCP " << +policer.dscp << " dropped UID " << packet->GetUid());
+        m_portCounters[incomingIndex].drops[DROP_POLICER]++;
+        return false;
+    }
+    int16_t remark = policer.remarkDscp[color];
+    if (action == POLICER_REMARK && remark >= 0 && remark != dscp)
+    {
+        Ipv4Header ipv4Header;
+        packet->PeekHeader(ipv4Header);
+        SlicescopePipeline::Result result;
+        result.dscp = remark;
+        packet = RewriteIpv4Packet(packet, ipv4Header, result);
+    }
+    return true;
+}
+
+void
+SlicescopeSwitchNetDevice::TransmitThroughPort(uint32_t incomingIndex,
+                                               uint32_t portIndex,
+                                               Ptr<Packet> packet,
+                                               uint16_t protocol,
+                                               const Address& src,
+                                               const Address& dst)
+{
+    if ((m_enableInt || m_pathFilterBytes) && protocol == Ipv4L3Protocol::PROT_NUMBER)
+    {
+        StampSlicescopeHeader(packet, incomingIndex, portIndex);
+    }
+    if (m_postcardExporter && protocol == Ipv4L3Protocol::PROT_NUMBER)
+    {
+        ReportPostcard(packet, portIndex);
+    }
+    if (protocol == Ipv4L3Protocol::PROT_NUMBER && m_stripAtEdge && !m_enableInt &&
+        !m_pathFilterBytes)
+    {
+        SlicescopeTag slicescopeTag;
+        if (packet->PeekPacketTag(slicescopeTag) && GetPortRole(portIndex) == EDGE)
+        {
+            StripSlicescopeHeader(packet);
+        }
+    }
+    CountTx(portIndex, packet->GetSize());
+    m_ports[portIndex]->SendFrom(packet, src, dst, protocol);
+}
+
+void
+SlicescopeSwitchNetDevice::StripSlicescopeHeader(Ptr<Packet> packet)
+{
+    NS_LOG_FUNCTION_NOARGS();
+    Ipv4Header ipv4Header;
+    packet->RemoveHeader(ipv4Header);
+    UdpHeader udpHeader;
+    packet->RemoveHeader(udpHeader);
+    SlicescopeHeader slicescopeHeader;
+    packet->RemoveHeader(slicescopeHeader);
+    SlicescopeTag slicescopeTag;
+    packet->RemovePacketTag(slicescopeTag);
+
+    udpHeader.ForcePayloadSize(udpHeader.GetSerializedSize() + packet->GetSize());
+    packet->AddHeader(udpHeader);
+    ipv4Header.SetPayloadSize(packet->GetSize());
+    packet->AddHeader(ipv4Header);
+}
+
+void
+SlicescopeSwitchNetDevice::SetPortRole(uint32_t port, PortRole role)
+{
+    NS_LOG_FUNCTION(this << port << role);
+    NS_ASSERT_MSG(port < m_ports.size(), "Unknown port " << port);
+    m_portRoles[port] = role;
+}
+
+SlicescopeSwitchNetDevice::PortRole
+SlicescopeSwitchNetDevice::GetPortRole(uint32_t port)
+{
+    NS_ASSERT_MSG(port < m_ports.size(), "Unknown port " << port);
+    if (m_portRoles[port] != AUTO)
+    {
+        return m_portRoles[port];
+    }
+
+    // Resolved on first use rather than in AddBridgePort, when the switch at
+    // the other end of the link may not be installed yet. A segment shared
+    // by switches and hosts is an edge: the hosts get the frames as sent.
+    bool switches = false;
+    bool hosts = false;
+    Ptr<Channel> channel = m_ports[port]->GetChannel();
+    for (std::size_t i = 0; channel && i < channel->GetNDevices(); i++)
+    {
+        Ptr<NetDevice> peer = channel->GetDevice(i);
+        if (peer == m_ports[port] || !peer->GetNode())
+        {
+            continue;
+        }
+        bool bridged = false;
+        Ptr<Node> node = peer->GetNode();
+        for (uint32_t n = 0; n < node->GetNDevices() && !bridged; n++)
+        {
+            Ptr<SlicescopeSwitchNetDevice> other =
+                DynamicCast<SlicescopeSwitchNetDevice>(node->GetDevice(n));
+            bridged = other && other->IsBridgePort(peer);
+        }
+        if (bridged)
+        {
+            switches = true;
+        }
+        else
+        {
+            hosts = true;
+        }
+    }
+    m_portRoles[port] = switches && !hosts ? TRANSIT : EDGE;
+    NS_LOG_LOGIC("Port " << port << " is " << (m_portRoles[port] == EDGE ? "an edge" : "a transit")
+                         << " port");
+    return m_portRoles[port];
+}
+
+bool
+SlicescopeSwitchNetDevice::IsBridgePort(Ptr<NetDevice> device) const
+{
+    uint32_t ifIndex = device->GetIfIndex();
+    return device->GetNode() == m_node && ifIndex < m_portIndexByIfIndex.size() &&
+           m_portIndexByIfIndex[ifIndex] != MacLearningTable::NO_PORT;
+}
+
+void
+SlicescopeSwitchNetDevice::CountRx(uint32_t portIndex, uint32_t size)
+{
+    m_portCounters[portIndex].rxPackets++;
+    m_portCounters[portIndex].rxBytes += size;
+    if (!m_counterExportPending && m_counterExportInterval.IsStrictlyPositive())
+    {
+        m_counterExportPending = true;
+        Simulator::Schedule(m_counterExportInterval,
+                            &SlicescopeSwitchNetDevice::ExportPortCounters,
+                            this);
+    }
+}
+
+void
+SlicescopeSwitchNetDevice::CountTx(uint32_t portIndex, uint32_t size)
+{
+    m_portCounters[portIndex].txPackets++;
+    m_portCounters[portIndex].txBytes += size;
+}
+
+void
+SlicescopeSwitchNetDevice::ExportPortCounters()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    m_counterExportPending = false;
+    m_portCountersTrace(m_portCounters);
+}
+
+std::vector<SlicescopeSwitchNetDevice::PortCounters>
+SlicescopeSwitchNetDevice::GetPortCounters() const
+{
+    return m_portCounters;
+}
+
+void
+SlicescopeSwitchNetDevice::ResetPortCounters()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    m_portCounters.assign(m_ports.size() + 1, PortCounters());
+}
+
+void
+SlicescopeSwitchNetDevice::UpdateHeavyHitters(Ptr<const Packet> packet)
+{
+    FlowKey flow;
+    if (!flow.Extract(packet))
+    {
+        return;
+    }
+    // Sized on first use, once the attributes are set
+    if (m_heavyHitters.empty())
+    {
+        m_heavyHitters.resize(CustomQueueDisc::queueIndexToSliceTypeMap.size());
+        for (auto& sketch : m_heavyHitters)
+        {
+            sketch.Configure(m_heavyHitterWidth, m_heavyHitterDepth, m_heavyHitterCount);
+        }
+    }
+    m_heavyHitters[m_dscpQueueMap.GetQueueIndex(flow.dscp)].Update(flow, packet->GetSize());
+    if (!m_heavyHitterDumpPending && m_heavyHitterInterval.IsStrictlyPositive())
+    {
+        m_heavyHitterDumpPending = true;
+        Simulator::Schedule(m_heavyHitterInterval,
+                            &SlicescopeSwitchNetDevice::DumpHeavyHitters,
+                            this);
+    }
+}
+
+void
+SlicescopeSwitchNetDevice::DumpHeavyHitters()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    m_heavyHitterDumpPending = false;
+    for (uint32_t i = 0; i < m_heavyHitters.size(); i++)
+    {
+        std::vector<HeavyHitterSketch::Entry> hitters = m_heavyHitters[i].GetTopK();
+        if (hitters.empty())
+        {
+            continue;
+        }
+        Slice::SliceType sliceType = CustomQueueDisc::queueIndexToSliceTypeMap.at(i);
+        NS_LOG_INFO("Node " << m_node->GetId() << " | " << Slice::sliceTypeToStrMap.at(sliceType)
+                            << " heavy hitters of " << m_heavyHitters[i].GetTotalBytes()
+                            << " bytes:");
+        for (const auto& hitter : hitters)
+        {
+            NS_LOG_INFO("  " << Ipv4Address(hitter.flow.srcAddress) << ":" << hitter.flow.srcPort
+                             << " -> " << Ipv4Address(hitter.flow.dstAddress) << ":"
+                             << hitter.flow.dstPort << " proto " << +hitter.flow.protocol
+                             << ": ~" << hitter.bytes << " bytes");
+        }
+        m_heavyHittersTrace(sliceType, hitters);
+        m_heavyHitters[i].Clear();
+    }
+}
+
+std::vector<HeavyHitterSketch::Entry>
+SlicescopeSwitchNetDevice::GetHeavyHitters(Slice::SliceType sliceType) const
+{
+    auto it = CustomQueueDisc::sliceTypeToQueueIndexMap.find(sliceType);
+    if (it == CustomQueueDisc::sliceTypeToQueueIndexMap.end() || m_heavyHitters.empty())
+    {
+        return std::vector<HeavyHitterSketch::Entry>();
+    }
+    return m_heavyHitters[it->second].GetTopK();
+}
+
+uint64_t
+SlicescopeSwitchNetDevice::EstimateFlowBytes(const FlowKey& flow) const
+{
+    if (m_heavyHitters.empty())
+    {
+        return 0;
+    }
+    return m_heavyHitters[m_dscpQueueMap.GetQueueIndex(flow.dscp)].Estimate(flow);
+}
+
+void
+SlicescopeSwitchNetDevice::ReportPostcard(Ptr<const Packet> packet, uint32_t portIndex)
+{
+    uint32_t queueDepth = GetEgressQueueDepth(portIndex);
+    uint8_t selected = m_postcardExporter->Select(packet->GetUid(), queueDepth);
+    if (!selected)
+    {
+        return;
+    }
+
+    FlowKey flow;
+    flow.Extract(packet);
+    PostcardRecord record;
+    record.flowHash = flow.Hash(FlowKey::FIVE_TUPLE, 0);
+    record.ingressTime = Simulator::Now().GetNanoSeconds();
+    record.egressTime = record.ingressTime;
+    record.queueDepth = queueDepth;
+    record.hop = m_switchId ? m_switchId : m_node->GetId();
+    record.dscp = flow.dscp;
+    record.flagged = selected == 2;
+    m_postcardExporter->Report(record);
+}
+
+void
+SlicescopeSwitchNetDevice::SampleFrame(Ptr<const Packet> packet,
+                                       uint16_t protocol,
+                                       uint32_t incomingIndex)
+{
+    FlowKey flow;
+    if (protocol == Ipv4L3Protocol::PROT_NUMBER)
+    {
+        flow.Extract(packet);
+    }
+    SflowFlowSample sample;
+    sample.srcAddress = flow.srcAddress;
+    sample.dstAddress = flow.dstAddress;
+    sample.srcPort = flow.srcPort;
+    sample.dstPort = flow.dstPort;
+    sample.etherType = protocol;
+    sample.protocol = flow.protocol;
+    sample.dscp = flow.dscp;
+    sample.inputPort = incomingIndex;
+    sample.edge = GetPortRole(incomingIndex) == EDGE;
+    sample.frameLength = packet->GetSize();
+    m_sflowAgent->ReportFlowSample(sample);
+
+    if (!m_sflowAgent->IsPollDue())
+    {
+        return;
+    }
+    std::vector<SflowCounterSample> counters(m_ports.size());
+    for (uint32_t i = 0; i < m_ports.size(); i++)
+    {
+        const PortCounters& port = m_portCounters[i];
+        counters[i].port = i;
+        counters[i].rxPackets = port.rxPackets;
+        counters[i].rxBytes = port.rxBytes;
+        counters[i].txPackets = port.txPackets;
+        counters[i].txBytes = port.txBytes;
+        counters[i].drops = 0;
+        for (uint32_t reason = 0; reason < DROP_REASONS; reason++)
+        {
+            counters[i].drops += port.drops[reason];
+        }
+    }
+    m_sflowAgent->ReportCounters(counters);
+}
+
+void
+SlicescopeSwitchNetDevice::StampSlicescopeHeader(Ptr<Packet> packet,
+                                                 uint32_t incomingIndex,
+                                                 uint32_t portIndex)
 {
     NS_LOG_FUNCTION_NOARGS();
-    m_channel = CreateObject<BridgeChannel>();
+    SlicescopeTag slicescopeTag;
+    if (!packet->PeekPacketTag(slicescopeTag))
+    {
+        return;
+    }
+
+    uint16_t switchId = m_switchId ? m_switchId : m_node->GetId();
+    Ipv4Header ipv4Header;
+    packet->RemoveHeader(ipv4Header);
+    UdpHeader udpHeader;
+    packet->RemoveHeader(udpHeader);
+    SlicescopeHeader slicescopeHeader;
+    packet->RemoveHeader(slicescopeHeader);
+
+    if (m_pathFilterBytes)
+    {
+        slicescopeHeader.AddPathSwitch(switchId);
+    }
+    if (m_enableInt)
+    {
+        Time now = Simulator::Now();
+        SlicescopeHeader::IntRecord record;
+        record.switchId = switchId;
+        record.ingressPort = incomingIndex;
+        record.egressPort = portIndex;
+        record.queueDepth = GetEgressQueueDepth(portIndex);
+
+        // The metadata tag holds the time the packet left the previous queue or switch
+        MetadataTag metadataTag;
+        bool stamped = packet->RemovePacketTag(metadataTag);
+        record.hopLatency =
+            stamped ? (now - metadataTag.GetEgressTimestamp()).GetNanoSeconds() : 0;
+        metadataTag.SetIngressTimestamp(now);
+        metadataTag.SetEgressTimestamp(now);
+        metadataTag.SetInputPort(incomingIndex);
+        metadataTag.SetOutputPort(portIndex);
+        packet->AddPacketTag(metadataTag);
+
+        if (!slicescopeHeader.AddHop(record))
+        {
+            m_intRecordsSkipped++;
+        }
+    }
+    NS_LOG_LOGIC("Slicescope header of UID " << packet->GetUid() << ": " << slicescopeHeader);
+
+    packet->AddHeader(slicescopeHeader);
+    udpHeader.ForcePayloadSize(udpHeader.GetSerializedSize() + packet->GetSize());
+    packet->AddHeader(udpHeader);
+    ipv4Header.SetPayloadSize(packet->GetSize());
+    packet->AddHeader(ipv4Header);
 }
 
-SlicescopeSwitchNetDevice::~SlicescopeSwitchNetDevice()
+Ptr<Packet>
+SlicescopeSwitchNetDevice::TakeOrCopy(Ptr<const Packet> packet, bool owned)
 {
-    NS_LOG_FUNCTION_NOARGS();
+    if (owned)
+    {
+        m_avoidedCopies++;
+        return ConstCast<Packet>(packet);
+    }
+    return packet->Copy();
 }
 
 void
-SlicescopeSwitchNetDevice::DoDispose()
+SlicescopeSwitchNetDevice::Learn(Mac48Address source, Ptr<NetDevice> port)
 {
     NS_LOG_FUNCTION_NOARGS();
-    for (auto iter = m_ports.begin(); iter != m_ports.end(); iter++)
+    if (m_enableLearning)
     {
-        *iter = nullptr;
+        m_learningTable.Learn(source, GetPortIndex(port));
     }
-    m_ports.clear();
-    m_channel = nullptr;
-    m_node = nullptr;
-    NetDevice::DoDispose();
 }
 
-void
-SlicescopeSwitchNetDevice::ReceiveFromDevice(Ptr<NetDevice> incomingPort,
-                                             Ptr<const Packet> packet,
-                                             uint16_t protocol,
-                                             const Address& src,
-                                             const Address& dst,
-                                             PacketType packetType)
+Ptr<NetDevice>
+SlicescopeSwitchNetDevice::GetLearnedState(Mac48Address source)
 {
     NS_LOG_FUNCTION_NOARGS();
-    NS_LOG_DEBUG("UID is " << packet->GetUid());
+    uint32_t portIndex = GetLearnedPortIndex(source);
+    if (portIndex != MacLearningTable::NO_PORT)
+    {
+        return m_ports[portIndex];
+    }
+    return nullptr;
+}
 
-    Mac48Address src48 = Mac48Address::ConvertFrom(src);
-    Mac48Address dst48 = Mac48Address::ConvertFrom(dst);
+uint32_t
+SlicescopeSwitchNetDevice::GetLearnedPortIndex(Mac48Address destination)
+{
+    if (!m_enableLearning)
+    {
+        return MacLearningTable::NO_PORT;
+    }
+    return m_learningTable.Lookup(destination);
+}
 
-    if (!m_promiscRxCallback.IsNull())
+void
+SlicescopeSwitchNetDevice::AddRoute(Ipv4Address network, Ipv4Mask mask, uint32_t port)
+{
+    NS_LOG_FUNCTION(this << network << mask << port);
+    NS_ASSERT_MSG(port < m_ports.size(), "Route to unknown port " << port);
+    m_routes.AddRoute(network, mask, port);
+}
+
+Ptr<NetDevice>
+SlicescopeSwitchNetDevice::GetRoute(Ipv4Address destination) const
+{
+    uint32_t portIndex = m_routes.Lookup(destination);
+    if (portIndex == Ipv4LpmTable::NO_ROUTE)
     {
-        m_promiscRxCallback(this, packet, protocol, src, dst, packetType);
+        return nullptr;
     }
+    return m_ports[portIndex];
+}
 
-    Ptr<Packet> copy = packet->Copy();
-    if (m_enableLayer3)
+uint32_t
+SlicescopeSwitchNetDevice::AddEcmpGroup(const std::vector<uint32_t>& ports)
+{
+    NS_LOG_FUNCTION(this << ports.size());
+    NS_ASSERT_MSG(!ports.empty(), "An ECMP group needs at least one port");
+    uint32_t group = m_ecmpGroups.size();
+    if (m_ecmpGroupOfPort.size() < m_ports.size())
     {
-        Ipv4Header ipv4Header;
-        if (copy->PeekHeader(ipv4Header))
-        {
-            copy->RemoveHeader(ipv4Header);
-            Ipv4Address ipv4Src = ipv4Header.GetSource();
-            Ipv4Address ipv4Dst = ipv4Header.GetDestination();
-            uint8_t protocol = ipv4Header.GetProtocol();
+        m_ecmpGroupOfPort.resize(m_ports.size(), NO_GROUP);
+    }
+    for (auto port : ports)
+    {
+        NS_ASSERT_MSG(port < m_ports.size(), "ECMP group member " << port << " is not a port");
+        NS_ASSERT_MSG(m_ecmpGroupOfPort[port] == NO_GROUP,
+                      "Port " << port << " already belongs to an ECMP group");
+        m_ecmpGroupOfPort[port] = group;
+    }
+    EcmpGroup ecmpGroup;
+    ecmpGroup.ports = ports;
+    ecmpGroup.bytes.assign(ports.size(), 0);
+    m_ecmpGroups.push_back(ecmpGroup);
+    UpdateFloodPorts();
+    return group;
+}
 
-            NS_LOG_INFO("*** Node" << m_node->GetId() << " ***");
-            NS_LOG_INFO("IPv4 Source: " << ipv4Src << " Destination: " << ipv4Dst
-                                        << " Protocol: " << (uint32_t)protocol);
+uint32_t
+SlicescopeSwitchNetDevice::GetNEcmpGroups() const
+{
+    return m_ecmpGroups.size();
+}
 
-            if (protocol == 17)
-            {
-                UdpHeader udpHeader;
-                copy->RemoveHeader(udpHeader);
-                // uint16_t srcPort = udpHeader.GetSourcePort();
-                // uint16_t dstPort = udpHeader.GetDestinationPort();
-                // NS_LOG_INFO("Original UDP Source Port: " << srcPort
-                //                                          << " Destination Port: " << dstPort);
-
-                // // Modify the source port
-                // uint16_t newSrcPort = srcPort; // New source port value
-                // udpHeader.SetSourcePort(newSrcPort);
-                // NS_LOG_INFO("New UDP Source Port: " << udpHeader.GetSourcePort());
-
-                SlicescopeHeader slicescopeHeader;
-                slicescopeHeader.SetDscp(42);     // New DSCP value
-                slicescopeHeader.SetBitmap(0xFF); // New bitmap value
-                uint32_t slicescopeHeaderSize = slicescopeHeader.GetSerializedSize();
-                NS_LOG_INFO("Adding slicescope header. Previous size: "
-                            << copy->GetSize()
-                            << " New size: " << copy->GetSize() + slicescopeHeaderSize);
-                copy->AddHeader(slicescopeHeader);
-
-                // Update UDP length
-                uint16_t udpLength = udpHeader.GetSerializedSize() + slicescopeHeaderSize;
-                udpHeader.ForcePayloadSize(udpLength);
-
-                copy->AddHeader(udpHeader);
-
-                // Update IPv4 length
-                uint16_t ipv4Length = ipv4Header.GetPayloadSize() + slicescopeHeaderSize;
-                ipv4Header.SetPayloadSize(ipv4Length);
-            }
+std::vector<uint64_t>
+SlicescopeSwitchNetDevice::GetEcmpMemberBytes(uint32_t group) const
+{
+    NS_ASSERT_MSG(group < m_ecmpGroups.size(), "Unknown ECMP group " << group);
+    return m_ecmpGroups[group].bytes;
+}
 
-            copy->AddHeader(ipv4Header);
-        }
+uint32_t
+SlicescopeSwitchNetDevice::SelectEcmpPort(uint32_t portIndex,
+                                          Ptr<const Packet> packet,
+                                          uint16_t protocol,
+                                          Mac48Address src,
+                                          Mac48Address dst)
+{
+    if (portIndex >= m_ecmpGroupOfPort.size() || m_ecmpGroupOfPort[portIndex] == NO_GROUP)
+    {
+        return portIndex;
     }
+    uint32_t group = m_ecmpGroupOfPort[portIndex];
+    EcmpGroup& ecmpGroup = m_ecmpGroups[group];
 
-    switch (packetType)
+    uint64_t hash;
+    FlowKey key;
+    if (protocol == Ipv4L3Protocol::PROT_NUMBER && key.Extract(packet))
     {
-    case PACKET_HOST:
-        if (dst48 == m_address)
+        hash = key.Hash(m_ecmpHashFields, m_ecmpHashSeed);
+    }
+    else
+    {
+        // Non-IP frames are spread by MAC address pair
+        uint8_t buffer[6];
+        src.CopyTo(buffer);
+        uint64_t srcBits = 0;
+        for (uint32_t i = 0; i < 6; i++)
         {
-            Learn(src48, incomingPort);
-            m_rxCallback(this, copy, protocol, src);
+            srcBits = (srcBits << 8) | buffer[i];
         }
-        break;
-
-    case PACKET_BROADCAST:
-    case PACKET_MULTICAST:
-        m_rxCallback(this, copy, protocol, src);
-        ForwardBroadcast(incomingPort, copy, protocol, src48, dst48);
-        break;
-
-    case PACKET_OTHERHOST:
-        if (dst48 == m_address)
+        dst.CopyTo(buffer);
+        uint64_t dstBits = 0;
+        for (uint32_t i = 0; i < 6; i++)
         {
-            Learn(src48, incomingPort);
-            m_rxCallback(this, copy, protocol, src);
+            dstBits = (dstBits << 8) | buffer[i];
         }
-        else
+        hash = FlowKey::Mix(FlowKey::Mix(m_ecmpHashSeed ^ srcBits) ^ dstBits);
+    }
+
+    uint32_t member;
+    if (m_flowletTimeout.IsStrictlyPositive())
+    {
+        Flowlet& flowlet = m_flowlets[hash & (m_flowlets.size() - 1)];
+        int64_t now = Simulator::Now().GetTimeStep();
+        if (flowlet.group != group || now - flowlet.lastSeen > m_flowletTimeout.GetTimeStep())
         {
-            ForwardUnicast(incomingPort, copy, protocol, src48, dst48);
+            // The previous burst has drained, so the flow can move to another
+            // member without its packets being reordered
+            flowlet.salt++;
+            flowlet.group = group;
+            flowlet.member = FlowKey::Mix(hash ^ flowlet.salt) % ecmpGroup.ports.size();
         }
-        break;
+        flowlet.lastSeen = now;
+        member = flowlet.member;
     }
+    else
+    {
+        member = hash % ecmpGroup.ports.size();
+    }
+    ecmpGroup.bytes[member] += packet->GetSize();
+    return ecmpGroup.ports[member];
 }
 
-void
-SlicescopeSwitchNetDevice::ForwardUnicast(Ptr<NetDevice> incomingPort,
-                                          Ptr<const Packet> packet,
-                                          uint16_t protocol,
-                                          Mac48Address src,
-                                          Mac48Address dst)
+bool
+SlicescopeSwitchNetDevice::IsSamePort(uint32_t first, uint32_t second) const
 {
-    NS_LOG_FUNCTION_NOARGS();
-    NS_LOG_DEBUG("LearningBridgeForward (incomingPort="
-                 << incomingPort->GetInstanceTypeId().GetName() << ", packet=" << packet
-                 << ", protocol=" << protocol << ", src=" << src << ", dst=" << dst << ")");
+    if (first == second)
+    {
+        return true;
+    }
+    if (first >= m_ecmpGroupOfPort.size() || second >= m_ecmpGroupOfPort.size())
+    {
+        return false;
+    }
+    return m_ecmpGroupOfPort[first] != NO_GROUP &&
+           m_ecmpGroupOfPort[first] == m_ecmpGroupOfPort[second];
+}
 
-    Learn(src, incomingPort);
-    Ptr<NetDevice> outPort = GetLearnedState(dst);
-    if (outPort && outPort != incomingPort)
+bool
+SlicescopeSwitchNetDevice::IsFloodPort(uint32_t incomingIndex, uint32_t portIndex) const
+{
+    if (IsSamePort(incomingIndex, portIndex))
     {
-        NS_LOG_LOGIC("Learning bridge state says to use port `"
-                     << outPort->GetInstanceTypeId().GetName() << "'");
-        outPort->SendFrom(packet->Copy(), src, dst, protocol);
+        return false;
     }
-    else
+    if (portIndex >= m_ecmpGroupOfPort.size() || m_ecmpGroupOfPort[portIndex] == NO_GROUP)
     {
-        NS_LOG_LOGIC("No learned state: send through all ports");
-        for (auto iter = m_ports.begin(); iter != m_ports.end(); iter++)
-        {
-            Ptr<NetDevice> port = *iter;
-            if (port != incomingPort)
-            {
-                NS_LOG_LOGIC("LearningBridgeForward ("
-                             << src << " => " << dst
-                             << "): " << incomingPort->GetInstanceTypeId().GetName() << " --> "
-                             << port->GetInstanceTypeId().GetName() << " (UID " << packet->GetUid()
-                             << ").");
-                port->SendFrom(packet->Copy(), src, dst, protocol);
-            }
-        }
+        return true;
     }
+    // One copy per group is enough: all members lead to the same place
+    return m_ecmpGroups[m_ecmpGroupOfPort[portIndex]].ports.front() == portIndex;
 }
 
 void
-SlicescopeSwitchNetDevice::ForwardBroadcast(Ptr<NetDevice> incomingPort,
-                                            Ptr<const Packet> packet,
-                                            uint16_t protocol,
-                                            Mac48Address src,
-                                            Mac48Address dst)
+SlicescopeSwitchNetDevice::UpdateFloodPorts()
 {
     NS_LOG_FUNCTION_NOARGS();
-    NS_LOG_DEBUG("LearningBridgeForward (incomingPort="
-                 << incomingPort->GetInstanceTypeId().GetName() << ", packet=" << packet
-                 << ", protocol=" << protocol << ", src=" << src << ", dst=" << dst << ")");
-    Learn(src, incomingPort);
-
-    for (auto iter = m_ports.begin(); iter != m_ports.end(); iter++)
+    // One list per port, plus a last one for packets sent by the switch itself
+    m_floodPorts.assign(m_ports.size() + 1, std::vector<uint32_t>());
+    for (uint32_t incomingIndex = 0; incomingIndex <= m_ports.size(); incomingIndex++)
     {
-        Ptr<NetDevice> port = *iter;
-        if (port != incomingPort)
+        uint32_t index =
+            incomingIndex == m_ports.size() ? MacLearningTable::NO_PORT : incomingIndex;
+        for (uint32_t i = 0; i < m_ports.size(); i++)
         {
-            NS_LOG_LOGIC("LearningBridgeForward (" << src << " => " << dst << "): "
-                                                   << incomingPort->GetInstanceTypeId().GetName()
-                                                   << " --> " << port->GetInstanceTypeId().GetName()
-                                                   << " (UID " << packet->GetUid() << ").");
-            port->SendFrom(packet->Copy(), src, dst, protocol);
+            if (IsFloodPort(index, i))
+            {
+                m_floodPorts[incomingIndex].push_back(i);
+            }
         }
     }
 }
 
+uint64_t
+SlicescopeSwitchNetDevice::GetFloodReplicas() const
+{
+    return m_floodReplicas;
+}
+
+uint64_t
+SlicescopeSwitchNetDevice::GetAvoidedCopies() const
+{
+    return m_avoidedCopies;
+}
+
 void
-SlicescopeSwitchNetDevice::Learn(Mac48Address source, Ptr<NetDevice> port)
+SlicescopeSwitchNetDevice::SetFlowletTableSize(uint32_t size)
 {
-    NS_LOG_FUNCTION_NOARGS();
-    if (m_enableLearning)
+    NS_LOG_FUNCTION(this << size);
+    uint32_t slots = 1;
+    while (slots < size)
     {
-        LearnedState& state = m_learnState[source];
-        state.associatedPort = port;
-        state.expirationTime = Simulator::Now() + m_expirationTime;
+        slots <<= 1;
     }
+    Flowlet empty = {0, NO_GROUP, 0, 0};
+    m_flowlets.assign(slots, empty);
 }
 
-Ptr<NetDevice>
-SlicescopeSwitchNetDevice::GetLearnedState(Mac48Address source)
+uint32_t
+SlicescopeSwitchNetDevice::GetFlowletTableSize() const
 {
-    NS_LOG_FUNCTION_NOARGS();
-    if (m_enableLearning)
+    return m_flowlets.size();
+}
+
+uint32_t
+SlicescopeSwitchNetDevice::GetPortIndex(Ptr<NetDevice> port) const
+{
+    uint32_t ifIndex = port->GetIfIndex();
+    NS_ASSERT_MSG(ifIndex < m_portIndexByIfIndex.size() &&
+                      m_portIndexByIfIndex[ifIndex] != MacLearningTable::NO_PORT,
+                  "Device is not a port of this switch");
+    return m_portIndexByIfIndex[ifIndex];
+}
+
+void
+SlicescopeSwitchNetDevice::SetExpirationTime(Time expirationTime)
+{
+    NS_LOG_FUNCTION(this << expirationTime);
+    m_expirationTime = expirationTime;
+    m_learningTable.SetExpirationTime(expirationTime);
+}
+
+Time
+SlicescopeSwitchNetDevice::GetExpirationTime() const
+{
+    return m_expirationTime;
+}
+
+void
+SlicescopeSwitchNetDevice::SetLearningTableCapacity(uint32_t capacity)
+{
+    NS_LOG_FUNCTION(this << capacity);
+    m_learningTable.SetCapacity(capacity);
+}
+
+void
+SlicescopeSwitchNetDevice::SetLearningTableWheelSlots(uint32_t numSlots)
+{
+    NS_LOG_FUNCTION(this << numSlots);
+    m_learningTable.SetWheelSlots(numSlots);
+}
+
+uint32_t
+SlicescopeSwitchNetDevice::GetLearningTableWheelSlots() const
+{
+    return m_learningTable.GetWheelSlots();
+}
+
+uint32_t
+SlicescopeSwitchNetDevice::GetLearningTableOccupancy() const
+{
+    return m_learningTable.GetOccupancy();
+}
+
+uint32_t
+SlicescopeSwitchNetDevice::GetLearningTableCapacity() const
+{
+    return m_learningTable.GetCapacity();
+}
+
+uint64_t
+SlicescopeSwitchNetDevice::GetLearningTableHits() const
+{
+    return m_learningTable.GetHits();
+}
+
+uint64_t
+SlicescopeSwitchNetDevice::GetLearningTableMisses() const
+{
+    return m_learningTable.GetMisses();
+}
+
+uint64_t
+SlicescopeSwitchNetDevice::GetLearningTableEvictions() const
+{
+    return m_learningTable.GetEvictions();
+}
+
+void
+SlicescopeSwitchNetDevice::SetFlowCacheCapacity(uint32_t capacity)
+{
+    NS_LOG_FUNCTION(this << capacity);
+    m_flowCache.SetCapacity(capacity);
+}
+
+uint32_t
+SlicescopeSwitchNetDevice::GetFlowCacheCapacity() const
+{
+    return m_flowCache.GetCapacity();
+}
+
+uint64_t
+SlicescopeSwitchNetDevice::GetFlowCacheHits() const
+{
+    return m_flowCache.GetHits();
+}
+
+uint64_t
+SlicescopeSwitchNetDevice::GetFlowCacheMisses() const
+{
+    return m_flowCache.GetMisses();
+}
+
+uint64_t
+SlicescopeSwitchNetDevice::GetFlowCacheEvictions() const
+{
+    return m_flowCache.GetEvictions();
+}
+
+SlicescopePipeline::Result
+SlicescopeSwitchNetDevice::Classify(const SlicescopePipeline::Key& key, uint32_t size)
+{
+    if (m_flowCache.GetCapacity() == 0)
     {
-        Time now = Simulator::Now();
-        auto iter = m_learnState.find(source);
-        if (iter != m_learnState.end())
-        {
-            LearnedState& state = iter->second;
-            if (state.expirationTime > now)
-            {
-                return state.associatedPort;
-            }
-            else
-            {
-                m_learnState.erase(iter);
-            }
-        }
+        return m_pipeline->Process(key, size);
     }
-    return nullptr;
+    if (m_pipeline->GetVersion() != m_flowCacheVersion)
+    {
+        m_flowCache.Flush();
+        m_flowCacheVersion = m_pipeline->GetVersion();
+    }
+    const SlicescopePipeline::Result* cached = m_flowCache.Lookup(key);
+    if (cached)
+    {
+        return *cached;
+    }
+    SlicescopePipeline::Result result = m_pipeline->Process(key, size);
+    if (result.cacheable)
+    {
+        m_flowCache.Insert(key, result);
+    }
+    return result;
 }
 
 uint32_t
@@ -327,8 +1887,48 @@ SlicescopeSwitchNetDevice::AddBridgePort(Ptr<NetDevice> bridgePort)
         0,
         bridgePort,
         true);
+    uint32_t ifIndex = bridgePort->GetIfIndex();
+    if (ifIndex >= m_portIndexByIfIndex.size())
+    {
+        m_portIndexByIfIndex.resize(ifIndex + 1, MacLearningTable::NO_PORT);
+    }
+    m_portIndexByIfIndex[ifIndex] = m_ports.size();
     m_ports.push_back(bridgePort);
+    m_portRoles.push_back(AUTO);
+    // Point-to-point ports carry their rate, CSMA ports leave it to their channel
+    DataRateValue bitRate;
+    if (bridgePort->GetAttributeFailSafe("DataRate", bitRate) ||
+        (bridgePort->GetChannel() &&
+         bridgePort->GetChannel()->GetAttributeFailSafe("DataRate", bitRate)))
+    {
+        m_portBitRates.push_back(bitRate.Get().GetBitRate());
+    }
+    else
+    {
+        m_portBitRates.push_back(0);
+    }
+    m_framesInPipeline.push_back(0);
+    SliceEgress egress;
+    for (uint32_t i = 0; i < m_sliceWeights.size(); i++)
+    {
+        egress.scheduler.SetWeight(i, m_sliceWeights[i]);
+    }
+    egress.traced = false;
+    egress.pending = false;
+    m_sliceEgress.push_back(egress);
+    // The new port goes before the local port, which stays last
+    m_portCounters.insert(m_portCounters.end() - 1, PortCounters());
+    PointerValue txQueue;
+    if (bridgePort->GetAttributeFailSafe("TxQueue", txQueue))
+    {
+        m_portTxQueues.push_back(txQueue.Get<QueueBase>());
+    }
+    else
+    {
+        m_portTxQueues.push_back(nullptr);
+    }
     m_channel->AddChannel(bridgePort->GetChannel());
+    UpdateFloodPorts();
 }
 
 void
@@ -451,27 +2051,30 @@ SlicescopeSwitchNetDevice::SendFrom(Ptr<Packet> packet,
 {
     NS_LOG_FUNCTION_NOARGS();
     Mac48Address dst = Mac48Address::ConvertFrom(dest);
+    CountRx(m_ports.size(), packet->GetSize());
 
     // try to use the learned state if data is unicast
     if (!dst.IsGroup())
     {
-        Ptr<NetDevice> outPort = GetLearnedState(dst);
-        if (outPort)
+        uint32_t portIndex = GetLearnedPortIndex(dst);
+        if (portIndex != MacLearningTable::NO_PORT)
         {
-            outPort->SendFrom(packet, src, dest, protocolNumber);
+            Mac48Address src48 = Mac48Address::ConvertFrom(src);
+            portIndex = SelectEcmpPort(portIndex, packet, protocolNumber, src48, dst);
+            SendThroughPort(MacLearningTable::NO_PORT,
+                            portIndex,
+                            packet,
+                            protocolNumber,
+                            src,
+                            dest);
             return true;
         }
     }
 
     // data was not unicast or no state has been learned for that mac
-    // address => flood through all ports.
-    Ptr<Packet> pktCopy;
-    for (auto iter = m_ports.begin(); iter != m_ports.end(); iter++)
-    {
-        pktCopy = packet->Copy();
-        Ptr<NetDevice> port = *iter;
-        port->SendFrom(pktCopy, src, dest, protocolNumber);
-    }
+    // address => flood through all ports. The caller gave the packet away, so
+    // the last port can take it.
+    Flood(MacLearningTable::NO_PORT, packet, true, protocolNumber, src, dest);
 
     return true;
 }
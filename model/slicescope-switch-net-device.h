@@ -1,13 +1,29 @@
 #ifndef SLICESCOPE_SWITCH_NET_DEVICE_H
 #define SLICESCOPE_SWITCH_NET_DEVICE_H
 
+#include "dscp-queue-map.h"
+#include "flow-cache.h"
+#include "flow-key.h"
+#include "heavy-hitter-sketch.h"
+#include "ipv4-lpm-table.h"
+#include "mac-learning-table.h"
+#include "slice-scheduler.h"
+#include "slice.h"
+#include "slicescope-pipeline.h"
+#include "trtcm-policer.h"
+
 #include "ns3/bridge-channel.h"
+#include "ns3/ipv4-header.h"
 #include "ns3/mac48-address.h"
 #include "ns3/net-device.h"
 #include "ns3/nstime.h"
+#include "ns3/queue.h"
+#include "ns3/traced-callback.h"
 
+#include <array>
 #include <map>
 #include <stdint.h>
+#include <vector>
 
 /**
  * \file
@@ -19,6 +35,8 @@ namespace ns3
 {
 
 class Node;
+class PostcardExporter;
+class SflowAgent;
 
 /**
  * \defgroup bridge Bridge Network Device
@@ -60,6 +78,87 @@ class SlicescopeSwitchNetDevice : public NetDevice
      * \return the object TypeId
      */
     static TypeId GetTypeId();
+
+    /// How unicast IPv4 frames select their output port
+    enum ForwardingMode
+    {
+        LEARNING, //!< MAC learning, unknown destinations are flooded
+        LPM       //!< longest-prefix match on the IPv4 destination
+    };
+
+    /// When a frame may start leaving the switch
+    enum SwitchingMode
+    {
+        STORE_AND_FORWARD,   //!< once the whole frame is received
+        CUT_THROUGH,         //!< once the first CutThroughBytes are received
+        ADAPTIVE_CUT_THROUGH //!< cut-through while the output port is idle
+    };
+
+    /// What happens to a frame that a policer marks yellow or red
+    enum PolicerAction
+    {
+        POLICER_PASS,   //!< forwarded unchanged
+        POLICER_REMARK, //!< forwarded with the remark DSCP of its color
+        POLICER_DROP    //!< dropped
+    };
+
+    /// Why a received frame was not forwarded
+    enum DropReason
+    {
+        DROP_NOT_FOR_SWITCH, //!< host frame addressed to a port, not to the switch
+        DROP_PIPELINE,       //!< DROP action of the pipeline
+        DROP_NO_ROUTE,       //!< no LPM route to the IPv4 destination
+        DROP_BAD_PORT,       //!< the selected port does not exist
+        DROP_SAME_PORT,      //!< the selected port leads back to the incoming port
+        DROP_SLICE_QUEUE,    //!< the slice queue of the selected port was full
+        DROP_POLICER,        //!< marked by an ingress policer whose action is to drop
+        DROP_REASONS         //!< number of drop reasons
+    };
+
+    /**
+     * \brief Counters of one port
+     *
+     * Frames that the switch sends itself are received, and frames passed up
+     * to its own stack are transmitted, by an extra local port that follows
+     * the bridged ports.
+     */
+    struct PortCounters
+    {
+        uint64_t rxPackets;           //!< frames received
+        uint64_t rxBytes;             //!< bytes received
+        uint64_t txPackets;           //!< frames transmitted
+        uint64_t txBytes;             //!< bytes transmitted, including INT records
+        uint64_t floods;              //!< received frames that were flooded
+        uint64_t learnedHits;         //!< received unicast frames with a learned destination
+        uint64_t learnedMisses;       //!< received unicast frames with an unknown destination
+        uint64_t drops[DROP_REASONS]; //!< received frames dropped, by reason
+    };
+
+    /// What a bridged port is connected to
+    enum PortRole
+    {
+        AUTO,   //!< detected from the port channel on first use
+        EDGE,   //!< hosts or other devices, maybe with switches: headers are stripped
+        TRANSIT //!< only other slicescope switches: headers are kept
+    };
+
+    /**
+     * TracedCallback signature for the periodic export of the port counters.
+     *
+     * \param [in] counters the counters of every bridged port, then of the local port
+     */
+    typedef void (*PortCountersTracedCallback)(const std::vector<PortCounters>& counters);
+
+    /**
+     * TracedCallback signature for the periodic dump of the heavy hitters.
+     *
+     * \param [in] sliceType the slice
+     * \param [in] hitters the largest flows of the slice in the interval, largest first
+     */
+    typedef void (*HeavyHittersTracedCallback)(
+        Slice::SliceType sliceType,
+        const std::vector<HeavyHitterSketch::Entry>& hitters);
+
     SlicescopeSwitchNetDevice();
     ~SlicescopeSwitchNetDevice() override;
 
@@ -96,6 +195,179 @@ class SlicescopeSwitchNetDevice : public NetDevice
      */
     Ptr<NetDevice> GetBridgePort(uint32_t n) const;
 
+    /**
+     * \brief Adds a route used in LPM forwarding mode
+     * \param network the destination network
+     * \param mask the network mask
+     * \param port index of the bridged port that leads to the network
+     *
+     * Routes can be added in any order; the longest matching prefix wins.
+     */
+    void AddRoute(Ipv4Address network, Ipv4Mask mask, uint32_t port);
+
+    /**
+     * \brief Gets the port selected by the LPM table for a destination
+     * \param destination the IPv4 destination address
+     * \returns the bridged port, or NULL if no route matches
+     */
+    Ptr<NetDevice> GetRoute(Ipv4Address destination) const;
+
+    /**
+     * \brief Groups bridged ports into an ECMP group
+     * \param ports indexes of the bridged ports that lead to the same place
+     * \returns the group identifier
+     *
+     * Whenever MAC learning or the LPM table selects a member of a group, the
+     * output port is chosen among all members by hashing the flow key of the
+     * packet (see the EcmpHashFields attribute), so a flow always takes the
+     * same member and its packets are not reordered. With a FlowletTimeout,
+     * a flow is re-hashed when it resumes after an idle gap longer than the
+     * timeout. Frames that are flooded use a single member of each group and
+     * are never sent back into the group they arrived from. A port can belong
+     * to one group only.
+     */
+    uint32_t AddEcmpGroup(const std::vector<uint32_t>& ports);
+
+    /// \returns the number of ECMP groups
+    uint32_t GetNEcmpGroups() const;
+
+    /**
+     * \brief Gets the bytes sent through each member of an ECMP group
+     * \param group the group identifier
+     * \returns the byte count of every member, in the order given to AddEcmpGroup
+     */
+    std::vector<uint64_t> GetEcmpMemberBytes(uint32_t group) const;
+
+    /// \returns the number of port transmissions made by floods
+    uint64_t GetFloodReplicas() const;
+
+    /// \returns the number of transmissions that reused the switch's own packet instead of a copy
+    uint64_t GetAvoidedCopies() const;
+
+    /**
+     * \brief Gets a snapshot of the port counters
+     * \returns the counters of every bridged port, by port index, followed by
+     * the counters of the local port
+     */
+    std::vector<PortCounters> GetPortCounters() const;
+
+    /// Resets all the port counters to zero
+    void ResetPortCounters();
+
+    /**
+     * \brief Gets the current heavy hitters of a slice (see HeavyHitterCount)
+     * \param sliceType the slice
+     * \returns the largest flows received by the switch, largest first
+     */
+    std::vector<HeavyHitterSketch::Entry> GetHeavyHitters(Slice::SliceType sliceType) const;
+
+    /**
+     * \brief Gets the estimated bytes the switch received for a flow
+     * \param flow the flow, whose DSCP selects the slice
+     * \returns the count-min estimate, 0 if heavy hitter detection is disabled
+     */
+    uint64_t EstimateFlowBytes(const FlowKey& flow) const;
+
+    /**
+     * \brief Sets the slice weights of the egress schedulers (see EnableSliceScheduling)
+     * \param weights relative bandwidth shares, by slice type
+     */
+    void SetSliceWeights(std::map<Slice::SliceType, uint32_t> weights);
+
+    /**
+     * \brief Sets the slice queue of each DSCP, at egress and in the heavy-hitter sketches
+     *
+     * Giving the map of a CustomQueueDisc, e.g. CustomQueueDisc::GetDscpQueueMap,
+     * makes its MapDscp overrides apply to the switch too.
+     *
+     * \param map the map, whose queues must be slice queues
+     */
+    void SetDscpQueueMap(const DscpQueueMap& map);
+
+    /// \returns the slice queue of each DSCP
+    const DscpQueueMap& GetDscpQueueMap() const;
+
+    /**
+     * \brief Gets the egress scheduler of a bridged port
+     * \param port the port index
+     * \returns the scheduler, whose queues are only used with EnableSliceScheduling
+     */
+    const SliceScheduler& GetSliceScheduler(uint32_t port) const;
+
+    /**
+     * \brief Polices the IPv4 frames of a DSCP at ingress with a two-rate three-color marker
+     *
+     * Only the frames received on edge ports are metered, unless
+     * PoliceTransitPorts is set. Yellow and red frames get the
+     * PolicerYellowAction and PolicerRedAction. In color-aware mode
+     * (PolicerColorAware), frames carrying a remark DSCP of the policer are
+     * metered by it with that color, so a downstream switch cannot promote
+     * them. Calling it again for the same DSCP changes the profile and keeps
+     * the counters.
+     *
+     * \param dscp the DSCP of the frames
+     * \param cir committed information rate
+     * \param cbs committed burst size, in bytes
+     * \param pir peak information rate, at least cir
+     * \param pbs peak burst size, in bytes
+     * \param yellowDscp DSCP of the frames remarked yellow, or -1 to keep theirs
+     * \param redDscp DSCP of the frames remarked red, or -1 to keep theirs
+     */
+    void SetPolicer(uint8_t dscp,
+                    DataRate cir,
+                    uint32_t cbs,
+                    DataRate pir,
+                    uint32_t pbs,
+                    int16_t yellowDscp = -1,
+                    int16_t redDscp = -1);
+
+    /**
+     * \brief Polices the frames of a slice, keyed by its DSCP (see SetPolicer)
+     * \param sliceType the slice
+     * \param cir committed information rate
+     * \param cbs committed burst size, in bytes
+     * \param pir peak information rate, at least cir
+     * \param pbs peak burst size, in bytes
+     * \param yellowDscp DSCP of the frames remarked yellow, or -1 to keep theirs
+     * \param redDscp DSCP of the frames remarked red, or -1 to keep theirs
+     */
+    void SetSlicePolicer(Slice::SliceType sliceType,
+                         DataRate cir,
+                         uint32_t cbs,
+                         DataRate pir,
+                         uint32_t pbs,
+                         int16_t yellowDscp = -1,
+                         int16_t redDscp = -1);
+
+    /**
+     * \brief Gets the frames and bytes metered by the policer of a DSCP, by color
+     * \param dscp the DSCP the policer was set for
+     * \returns the counters, all zero if the DSCP has no policer
+     */
+    TrTcmPolicer::Counters GetPolicerCounters(uint8_t dscp) const;
+
+    /**
+     * \brief Sets the role of a bridged port
+     * \param port the port index
+     * \param role the role; AUTO detects it again on next use
+     */
+    void SetPortRole(uint32_t port, PortRole role);
+
+    /**
+     * \brief Gets the role of a bridged port, detecting it if needed
+     * \param port the port index
+     * \returns TRANSIT if every other device on the port channel is bridged
+     * by a slicescope switch, EDGE if any is not, e.g. on a CSMA segment
+     * shared with hosts (or the role set with SetPortRole)
+     */
+    PortRole GetPortRole(uint32_t port);
+
+    /**
+     * \param device a NetDevice
+     * \returns true if the device is a bridged port of this switch
+     */
+    bool IsBridgePort(Ptr<NetDevice> device) const;
+
     // inherited from NetDevice base class.
     void SetIfIndex(const uint32_t index) override;
     uint32_t GetIfIndex() const override;
@@ -145,16 +417,88 @@ class SlicescopeSwitchNetDevice : public NetDevice
                            const Address& destination,
                            PacketType packetType);
 
+    /**
+     * \brief Inserts the slicescope header into an IPv4/UDP packet
+     * \param packet the received IPv4 packet
+     * \param ipv4Header the IPv4 header of the packet, already parsed by the caller
+     * \returns the packet with the slicescope header between the UDP header and
+     * the payload, or the original packet when it is not UDP or already
+     * carries a header inserted by an upstream switch
+     *
+     * The received packet is copied only when the header is actually inserted,
+     * so frames that are only forwarded share the original buffer.
+     */
+    Ptr<const Packet> InsertSlicescopeHeader(Ptr<const Packet> packet, Ipv4Header ipv4Header);
+
+    /**
+     * \brief Applies the header changes selected by the pipeline to an IPv4 packet
+     * \param packet the received IPv4 packet
+     * \param ipv4Header the IPv4 header of the packet, already parsed by the caller
+     * \param result the pipeline outcome
+     * \returns a rewritten copy of the packet, or the original packet when
+     * nothing has to change
+     *
+     * The slicescope header is pushed or popped right after the UDP header;
+     * other protocols only get their DSCP and ECN fields rewritten. Pushing
+     * onto a packet that already carries a header updates its fields in
+     * place instead, and popping a packet without one does nothing.
+     */
+    Ptr<const Packet> RewriteIpv4Packet(Ptr<const Packet> packet,
+                                        Ipv4Header ipv4Header,
+                                        const SlicescopePipeline::Result& result);
+
+    /**
+     * \brief Forwards a unicast IPv4 packet on the port selected by the LPM table
+     * \param incomingPort the packet incoming port
+     * \param packet the packet
+     * \param owned true if no one else holds a reference to the packet
+     * \param protocol the packet protocol (e.g., Ethertype)
+     * \param src the packet source
+     * \param dst the packet destination
+     * \param ipv4Dst the IPv4 destination address
+     *
+     * Packets without a matching route are dropped rather than flooded.
+     */
+    void ForwardRouted(Ptr<NetDevice> incomingPort,
+                       Ptr<const Packet> packet,
+                       bool owned,
+                       uint16_t protocol,
+                       Mac48Address src,
+                       Mac48Address dst,
+                       Ipv4Address ipv4Dst);
+
+    /**
+     * \brief Forwards a unicast packet through a given port
+     * \param incomingPort the packet incoming port
+     * \param portIndex index of the output port
+     * \param packet the packet
+     * \param owned true if no one else holds a reference to the packet
+     * \param protocol the packet protocol (e.g., Ethertype)
+     * \param src the packet source
+     * \param dst the packet destination
+     *
+     * Packets are dropped if the port leads back to the incoming port.
+     */
+    void ForwardToPort(Ptr<NetDevice> incomingPort,
+                       uint32_t portIndex,
+                       Ptr<const Packet> packet,
+                       bool owned,
+                       uint16_t protocol,
+                       Mac48Address src,
+                       Mac48Address dst);
+
     /**
      * \brief Forwards a unicast packet
      * \param incomingPort the packet incoming port
      * \param packet the packet
+     * \param owned true if no one else holds a reference to the packet
      * \param protocol the packet protocol (e.g., Ethertype)
      * \param src the packet source
      * \param dst the packet destination
      */
     void ForwardUnicast(Ptr<NetDevice> incomingPort,
                         Ptr<const Packet> packet,
+                        bool owned,
                         uint16_t protocol,
                         Mac48Address src,
                         Mac48Address dst);
@@ -173,6 +517,195 @@ class SlicescopeSwitchNetDevice : public NetDevice
                           Mac48Address src,
                           Mac48Address dst);
 
+    /**
+     * \brief Sends a packet through every port of the flood list of a port
+     * \param incomingIndex index of the incoming port, or MacLearningTable::NO_PORT
+     * for packets sent by the switch itself
+     * \param packet the packet
+     * \param owned true if no one else holds a reference to the packet
+     * \param protocol the packet protocol (e.g., Ethertype)
+     * \param src the packet source
+     * \param dst the packet destination
+     *
+     * All ports share the packet buffer: each port gets its own Packet object
+     * (which devices are free to add headers to), and the buffer bytes are
+     * only duplicated when one of them writes to them. An owned packet is
+     * handed over as is to the last port instead of being copied.
+     */
+    void Flood(uint32_t incomingIndex,
+               Ptr<const Packet> packet,
+               bool owned,
+               uint16_t protocol,
+               const Address& src,
+               const Address& dst);
+
+    /**
+     * \brief Gets a packet a port can send
+     * \param packet the packet
+     * \param owned true if no one else holds a reference to the packet
+     * \returns the packet itself if it is owned, a copy otherwise
+     */
+    Ptr<Packet> TakeOrCopy(Ptr<const Packet> packet, bool owned);
+
+    /**
+     * \brief Sends a packet through a bridged port, after the forwarding delay
+     * \param incomingIndex index of the incoming port, or MacLearningTable::NO_PORT
+     * \param portIndex index of the output port
+     * \param packet the packet, which the port may modify
+     * \param protocol the packet protocol (e.g., Ethertype)
+     * \param src the packet source
+     * \param dst the packet destination
+     */
+    void SendThroughPort(uint32_t incomingIndex,
+                         uint32_t portIndex,
+                         Ptr<Packet> packet,
+                         uint16_t protocol,
+                         const Address& src,
+                         const Address& dst);
+
+    /**
+     * \brief Places a packet in the slice queues of a bridged port, if any
+     * \param incomingIndex index of the incoming port, or MacLearningTable::NO_PORT
+     * \param portIndex index of the output port
+     * \param packet the packet, which the port may modify
+     * \param protocol the packet protocol (e.g., Ethertype)
+     * \param src the packet source
+     * \param dst the packet destination
+     */
+    void QueueThroughPort(uint32_t incomingIndex,
+                          uint32_t portIndex,
+                          Ptr<Packet> packet,
+                          uint16_t protocol,
+                          const Address& src,
+                          const Address& dst);
+
+    /**
+     * \brief Places a packet leaving the pipeline in the queues of a bridged port
+     * \param incomingIndex index of the incoming port, or MacLearningTable::NO_PORT
+     * \param portIndex index of the output port
+     * \param packet the packet, which the port may modify
+     * \param protocol the packet protocol (e.g., Ethertype)
+     * \param src the packet source
+     * \param dst the packet destination
+     */
+    void LeavePipeline(uint32_t incomingIndex,
+                       uint32_t portIndex,
+                       Ptr<Packet> packet,
+                       uint16_t protocol,
+                       const Address& src,
+                       const Address& dst);
+
+    /**
+     * \brief Computes how long a frame stays in the switch before its egress
+     * \param incomingIndex index of the incoming port, or MacLearningTable::NO_PORT
+     * \param portIndex index of the output port
+     * \param size the frame size
+     * \returns the delay from now, i.e. from the arrival of the last bit
+     *
+     * A store-and-forward frame leaves PipelineLatency after its last bit.
+     * A cut-through frame leaves PipelineLatency after its first
+     * CutThroughBytes, which is earlier by the time the rest of the frame
+     * took on the incoming port; since ports only hand over whole frames,
+     * the frame leaves now when that time is already past. Cut-through needs
+     * an incoming port at least as fast as the output port (a slower one
+     * would underrun it), and in adaptive mode an idle output port, with no
+     * frame queued for it or still in the pipeline. With no PipelineLatency,
+     * both modes give the same delay, zero.
+     */
+    Time GetForwardingDelay(uint32_t incomingIndex, uint32_t portIndex, uint32_t size);
+
+    /**
+     * \brief Hands a packet to a bridged port, after its egress processing
+     * \param incomingIndex index of the incoming port, or MacLearningTable::NO_PORT
+     * \param portIndex index of the output port
+     * \param packet the packet, which the port may modify
+     * \param protocol the packet protocol (e.g., Ethertype)
+     * \param src the packet source
+     * \param dst the packet destination
+     */
+    void TransmitThroughPort(uint32_t incomingIndex,
+                             uint32_t portIndex,
+                             Ptr<Packet> packet,
+                             uint16_t protocol,
+                             const Address& src,
+                             const Address& dst);
+
+    /**
+     * \brief Moves frames from the slice queues of a port to the port itself
+     * \param portIndex the port index
+     *
+     * Frames are released one at a time, when the transmit queue of the port
+     * is empty, so that the slice scheduler rather than the port FIFO decides
+     * the transmission order.
+     */
+    void TransmitFromSliceQueues(uint32_t portIndex);
+
+    /**
+     * \brief Called when a port dequeues a frame for transmission
+     * \param device the switch
+     * \param portIndex the port index
+     * \param packet the dequeued frame
+     *
+     * The next frame is released from a separate event, since the port is in
+     * the middle of starting a transmission.
+     */
+    static void NotifyPortDequeue(SlicescopeSwitchNetDevice* device,
+                                  uint32_t portIndex,
+                                  Ptr<const Packet> packet);
+
+    /**
+     * \param portIndex the port index
+     * \returns the number of frames waiting in the transmit and slice queues of a port
+     */
+    uint32_t GetEgressQueueDepth(uint32_t portIndex) const;
+
+    /**
+     * \brief Records this switch in the slicescope header: its id in the path
+     * filter (PathFilterBytes) and its telemetry record (EnableInt)
+     * \param packet an IPv4 packet; nothing is done unless it carries a SlicescopeTag
+     * \param incomingIndex index of the incoming port (0xff in the record for
+     * packets sent by the switch itself)
+     * \param portIndex index of the output port
+     *
+     * The hop latency is the time elapsed since the egress timestamp of the
+     * packet MetadataTag, written by the previous switch or CustomQueueDisc;
+     * the tag is then restamped for the next hop.
+     */
+    void StampSlicescopeHeader(Ptr<Packet> packet, uint32_t incomingIndex, uint32_t portIndex);
+
+    /**
+     * \brief Removes the slicescope header of an IPv4/UDP packet leaving through an edge port
+     * \param packet the packet, which must carry a SlicescopeTag
+     */
+    void StripSlicescopeHeader(Ptr<Packet> packet);
+
+    /**
+     * \brief Reports an IPv4 packet to the postcard exporter if it selects it
+     * \param packet the packet, starting with its IPv4 header
+     * \param portIndex index of the output port, whose queue depth is reported
+     *
+     * The switch forwards instantly, so the ingress and egress times are both
+     * the current time; the residence of the packet in the port queue is
+     * reported by the CustomQueueDisc, if it has an exporter too.
+     */
+    void ReportPostcard(Ptr<const Packet> packet, uint32_t portIndex);
+
+    /**
+     * \brief Sends a received frame, and the port counters if due, to the sFlow agent
+     * \param packet the frame as received
+     * \param protocol the frame protocol (e.g., Ethertype)
+     * \param incomingIndex index of the incoming port
+     */
+    void SampleFrame(Ptr<const Packet> packet, uint16_t protocol, uint32_t incomingIndex);
+
+    /**
+     * \brief Meters a received IPv4 frame with the policer of its DSCP, if any
+     * \param incomingIndex index of the incoming port
+     * \param packet the frame; replaced by a remarked copy if its color is remarked
+     * \returns false if the frame must be dropped
+     */
+    bool Police(uint32_t incomingIndex, Ptr<const Packet>& packet);
+
     /**
      * \brief Learns the port a MAC address is sending from
      * \param source source address
@@ -187,30 +720,259 @@ class SlicescopeSwitchNetDevice : public NetDevice
      */
     Ptr<NetDevice> GetLearnedState(Mac48Address source);
 
-  private:
-    NetDevice::ReceiveCallback m_rxCallback;               //!< receive callback
-    NetDevice::PromiscReceiveCallback m_promiscRxCallback; //!< promiscuous receive callback
+    /**
+     * \brief Gets the index of a bridged port
+     * \param port the bridged NetDevice
+     * \returns the position of the port in m_ports
+     */
+    uint32_t GetPortIndex(Ptr<NetDevice> port) const;
 
-    Mac48Address m_address; //!< MAC address of the NetDevice
-    Time m_expirationTime;  //!< time it takes for learned MAC state to expire
+    /**
+     * \brief Gets the index of the port associated to an address
+     * \param destination the destination address
+     * \returns the index of the learned port, or MacLearningTable::NO_PORT
+     */
+    uint32_t GetLearnedPortIndex(Mac48Address destination);
+
+    /**
+     * \brief Picks the output port among the members of an ECMP group
+     * \param portIndex the port selected by MAC learning or LPM
+     * \param packet the packet to send
+     * \param protocol the packet protocol (e.g., Ethertype)
+     * \param src the packet source
+     * \param dst the packet destination
+     * \returns the member selected for the flow of the packet, or portIndex
+     * if the port does not belong to a group
+     */
+    uint32_t SelectEcmpPort(uint32_t portIndex,
+                            Ptr<const Packet> packet,
+                            uint16_t protocol,
+                            Mac48Address src,
+                            Mac48Address dst);
 
     /**
-     * \ingroup bridge
-     * Structure holding the status of an address
+     * \brief Tells whether two ports lead to the same place
+     * \param first index of the first port
+     * \param second index of the second port
+     * \returns true if the ports are the same or members of the same ECMP group
      */
-    struct LearnedState
+    bool IsSamePort(uint32_t first, uint32_t second) const;
+
+    /**
+     * \brief Tells whether a flooded frame is sent through a port
+     * \param incomingIndex index of the incoming port, or MacLearningTable::NO_PORT
+     * \param portIndex index of the candidate port
+     * \returns true if the frame must be sent through the port
+     */
+    bool IsFloodPort(uint32_t incomingIndex, uint32_t portIndex) const;
+
+    /// Recomputes the flood list of every port after the ports or ECMP groups change
+    void UpdateFloodPorts();
+
+    /**
+     * \brief Counts a received frame, and arms the next counter export
+     * \param portIndex index of the receiving port, or the local port
+     * \param size the frame size
+     */
+    void CountRx(uint32_t portIndex, uint32_t size);
+
+    /**
+     * \brief Counts a transmitted frame
+     * \param portIndex index of the transmitting port, or the local port
+     * \param size the frame size
+     */
+    void CountTx(uint32_t portIndex, uint32_t size);
+
+    /// Fires the PortCounters trace source
+    void ExportPortCounters();
+
+    /**
+     * \brief Counts a received IPv4 frame in the sketch of its slice
+     * \param packet the frame, as received
+     */
+    void UpdateHeavyHitters(Ptr<const Packet> packet);
+
+    /// Fires the HeavyHitters trace source and starts a new interval
+    void DumpHeavyHitters();
+
+  private:
+    /// Returned for ports that do not belong to an ECMP group
+    static constexpr uint32_t NO_GROUP = 0xffffffff;
+
+    /// Ports that lead to the same place, and the bytes sent through each
+    struct EcmpGroup
+    {
+        std::vector<uint32_t> ports; //!< indexes of the member ports
+        std::vector<uint64_t> bytes; //!< bytes sent through each member
+    };
+
+    /// Slice queues of a bridged port
+    struct SliceEgress
+    {
+        SliceScheduler scheduler; //!< slice queues and scheduler
+        bool traced;              //!< true once the port transmit queue is traced
+        bool pending;             //!< true if TransmitFromSliceQueues is scheduled
+    };
+
+    /// Ingress policer of a DSCP
+    struct DscpPolicer
     {
-        Ptr<NetDevice> associatedPort; //!< port associated with the address
-        Time expirationTime;           //!< time it takes for learned MAC state to expire
+        uint8_t dscp;                             //!< DSCP the policer was set for
+        TrTcmPolicer meter;                       //!< two-rate three-color marker
+        int16_t remarkDscp[TrTcmPolicer::COLORS]; //!< DSCP of each color, -1 to keep it
     };
 
-    std::map<Mac48Address, LearnedState> m_learnState; //!< Container for known address statuses
-    Ptr<Node> m_node;                                  //!< node owning this NetDevice
-    Ptr<BridgeChannel> m_channel;                      //!< virtual bridged channel
-    std::vector<Ptr<NetDevice>> m_ports;               //!< bridged ports
-    uint32_t m_ifIndex;                                //!< Interface index
-    uint16_t m_mtu;                                    //!< MTU of the bridged NetDevice
+    /// Member chosen for the flows hashing to one flowlet table slot
+    struct Flowlet
+    {
+        int64_t lastSeen; //!< time step of the last packet
+        uint32_t group;   //!< group the member belongs to
+        uint32_t member;  //!< index of the member in the group
+        uint64_t salt;    //!< incremented every time the flowlet is re-hashed
+    };
+
+    /**
+     * \brief Sets the number of slots of the flowlet table
+     * \param size the number of slots, rounded up to a power of two
+     */
+    void SetFlowletTableSize(uint32_t size);
+
+    /// \returns the number of slots of the flowlet table
+    uint32_t GetFlowletTableSize() const;
+
+    /**
+     * \brief Sets the time it takes for learned MAC state to expire
+     * \param expirationTime the expiration time
+     */
+    void SetExpirationTime(Time expirationTime);
+
+    /**
+     * \brief Gets the time it takes for learned MAC state to expire
+     * \returns the expiration time
+     */
+    Time GetExpirationTime() const;
+
+    /**
+     * \brief Sets the initial capacity of the MAC learning table
+     * \param capacity the number of entries held before the table grows
+     */
+    void SetLearningTableCapacity(uint32_t capacity);
+
+    /**
+     * \brief Sets the number of timer wheel slots used to age learned entries
+     * \param numSlots the number of slots
+     */
+    void SetLearningTableWheelSlots(uint32_t numSlots);
+
+    /// \returns the number of timer wheel slots used to age learned entries
+    uint32_t GetLearningTableWheelSlots() const;
+
+    /// \returns the number of valid entries in the MAC learning table
+    uint32_t GetLearningTableOccupancy() const;
+    /// \returns the number of entries the MAC learning table holds before growing
+    uint32_t GetLearningTableCapacity() const;
+    /// \returns the number of MAC lookups that hit a learned entry
+    uint64_t GetLearningTableHits() const;
+    /// \returns the number of MAC lookups that missed
+    uint64_t GetLearningTableMisses() const;
+    /// \returns the number of learned entries removed by aging
+    uint64_t GetLearningTableEvictions() const;
+
+    /**
+     * \brief Sets the number of flows whose pipeline result is cached
+     * \param capacity the number of flows, 0 to disable the cache
+     */
+    void SetFlowCacheCapacity(uint32_t capacity);
+
+    /// \returns the number of flows whose pipeline result is cached
+    uint32_t GetFlowCacheCapacity() const;
+    /// \returns the number of IPv4 packets classified from the flow cache
+    uint64_t GetFlowCacheHits() const;
+    /// \returns the number of IPv4 packets that went through the pipeline
+    uint64_t GetFlowCacheMisses() const;
+    /// \returns the number of flows evicted from the flow cache
+    uint64_t GetFlowCacheEvictions() const;
+
+    /**
+     * \brief Runs the pipeline on a packet, or returns the cached result of its flow
+     * \param key the pipeline key of the packet
+     * \param size the packet size
+     * \returns the pipeline result
+     */
+    SlicescopePipeline::Result Classify(const SlicescopePipeline::Key& key, uint32_t size);
+
+    NetDevice::ReceiveCallback m_rxCallback;               //!< receive callback
+    NetDevice::PromiscReceiveCallback m_promiscRxCallback; //!< promiscuous receive callback
+
+    Mac48Address m_address; //!< MAC address of the NetDevice
+    Time m_expirationTime;  //!< time it takes for learned MAC state to expire
+
+    MacLearningTable m_learningTable;                //!< learned address to port index map
+    Ipv4LpmTable m_routes;                           //!< IPv4 prefix to port index map
+    ForwardingMode m_forwardingMode;                 //!< output port selection for IPv4 unicast
+    Ptr<SlicescopePipeline> m_pipeline;              //!< match-action pipeline, if any
+    FlowCache m_flowCache;                           //!< pipeline results of recent flows
+    uint64_t m_flowCacheVersion;                     //!< pipeline version the cache holds
+    Ptr<Node> m_node;                                //!< node owning this NetDevice
+    Ptr<BridgeChannel> m_channel;                    //!< virtual bridged channel
+    std::vector<Ptr<NetDevice>> m_ports;             //!< bridged ports
+    std::vector<uint32_t> m_portIndexByIfIndex;      //!< node interface index to port index
+    std::vector<EcmpGroup> m_ecmpGroups;             //!< ECMP groups
+    std::vector<uint32_t> m_ecmpGroupOfPort;         //!< port index to ECMP group, or NO_GROUP
+    std::vector<Flowlet> m_flowlets;                 //!< flowlet table, indexed by flow hash
+    uint32_t m_ecmpHashFields;                       //!< FlowKey fields hashed to select a member
+    uint64_t m_ecmpHashSeed;                         //!< seed of the ECMP hash
+    Time m_flowletTimeout;                           //!< idle gap after which a flow is re-hashed
+    std::vector<std::vector<uint32_t>> m_floodPorts; //!< ports flooded per incoming port index
+    uint64_t m_floodReplicas;                        //!< port transmissions made by floods
+    uint64_t m_avoidedCopies;                        //!< transmissions of an owned packet
+    std::vector<Ptr<QueueBase>> m_portTxQueues;      //!< transmit queue of each port, if any
+    std::vector<PortRole> m_portRoles;               //!< role of each port
+    std::vector<uint64_t> m_portBitRates;            //!< bit rate of each port, 0 if unknown
+    SwitchingMode m_switchingMode;                   //!< when frames may start leaving
+    Time m_pipelineLatency;                          //!< forwarding latency of the pipeline
+    uint32_t m_cutThroughBytes;                      //!< bytes received before cut-through
+    uint64_t m_cutThroughFrames;                     //!< frames forwarded in cut-through
+    uint64_t m_storeAndForwardFrames;                //!< frames forwarded in store-and-forward
+    std::vector<uint32_t> m_framesInPipeline;        //!< frames in the pipeline, per output port
+    std::vector<SliceEgress> m_sliceEgress;          //!< slice queues of each port
+    std::vector<uint32_t> m_sliceWeights;            //!< slice weights, by queue index
+    DscpQueueMap m_dscpQueueMap;                     //!< slice queue of each DSCP
+    bool m_enableSliceScheduling;                    //!< true if ports have slice queues
+    bool m_stripAtEdge;                              //!< true if edge ports strip headers
+    std::vector<DscpPolicer> m_policers;             //!< ingress policers
+    std::array<int16_t, 64> m_policerByDscp;         //!< policer of each DSCP, -1 for none
+    std::array<uint8_t, 64> m_preColorByDscp;        //!< TrTcmPolicer::Color of each DSCP
+    bool m_policerColorAware;                        //!< true if the DSCP gives a pre-color
+    PolicerAction m_policerYellowAction;             //!< action on yellow frames
+    PolicerAction m_policerRedAction;                //!< action on red frames
+    bool m_policeTransitPorts;                       //!< true if transit ports are policed too
+    bool m_enableInt;                                //!< true if telemetry records are appended
+    uint8_t m_intMaxHops;                            //!< hop limit of the headers inserted here
+    uint16_t m_switchId;                             //!< telemetry switch id, 0 for the node id
+    uint64_t m_intRecordsSkipped;                    //!< records dropped by the hop limit
+    uint8_t m_pathFilterBytes;                       //!< path filter size, 0 to disable
+    Ptr<PostcardExporter> m_postcardExporter;        //!< postcard exporter, if any
+    Ptr<SflowAgent> m_sflowAgent;                    //!< sFlow agent, if any
+    std::vector<HeavyHitterSketch> m_heavyHitters;   //!< sketch of each slice, by queue index
+    uint32_t m_heavyHitterCount;                     //!< flows kept per slice, 0 to disable
+    uint32_t m_heavyHitterWidth;                     //!< counters per sketch row
+    uint32_t m_heavyHitterDepth;                     //!< rows per sketch
+    Time m_heavyHitterInterval;                      //!< dump period, 0 to disable
+    bool m_heavyHitterDumpPending;                   //!< true if a dump is scheduled
+    std::vector<PortCounters> m_portCounters;        //!< counters per port, then the local port
+    Time m_counterExportInterval;                    //!< counter export period, 0 to disable
+    bool m_counterExportPending;                     //!< true if an export is scheduled
+    uint32_t m_ifIndex;                              //!< Interface index
+    uint16_t m_mtu;                                  //!< MTU of the bridged NetDevice
     bool m_enableLearning; //!< true if the bridge will learn the node status
+
+    /// Periodic export of the port counters
+    TracedCallback<const std::vector<PortCounters>&> m_portCountersTrace;
+
+    /// Periodic dump of the heavy hitters
+    TracedCallback<Slice::SliceType, const std::vector<HeavyHitterSketch::Entry>&>
+        m_heavyHittersTrace;
 };
 
 } // namespace ns3
@@ -0,0 +1,54 @@
+#ifndef SLICESCOPE_TAG_H
+#define SLICESCOPE_TAG_H
+
+#include "ns3/tag.h"
+
+namespace ns3
+{
+
+/**
+ * \brief Marks packets that carry a SlicescopeHeader after their UDP header
+ *
+ * Switches add the tag when they insert the header and remove it when they
+ * strip it, so the next hops and the sink know the header is there without
+ * having to guess from the payload bytes.
+ */
+class SlicescopeTag : public Tag
+{
+  public:
+    static TypeId GetTypeId()
+    {
+        static TypeId tid = TypeId("ns3::SlicescopeTag")
+                                .SetParent<Tag>()
+                                .SetGroupName("Network")
+                                .AddConstructor<SlicescopeTag>();
+        return tid;
+    }
+
+    TypeId GetInstanceTypeId() const override
+    {
+        return GetTypeId();
+    }
+
+    uint32_t GetSerializedSize() const override
+    {
+        return 0;
+    }
+
+    void Serialize(TagBuffer i) const override
+    {
+    }
+
+    void Deserialize(TagBuffer i) override
+    {
+    }
+
+    void Print(std::ostream& os) const override
+    {
+        os << "SlicescopeHeader present";
+    }
+};
+
+} // namespace ns3
+
+#endif /* SLICESCOPE_TAG_H */
@@ -0,0 +1,79 @@
+#include "trtcm-policer.h"
+
+#include "ns3/assert.h"
+
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::TrTcmPolicer implementation.
+ */
+
+namespace ns3
+{
+
+TrTcmPolicer::TrTcmPolicer()
+    : m_cir(0),
+      m_pir(0),
+      m_cbs(0),
+      m_pbs(0),
+      m_tc(0),
+      m_tp(0),
+      m_lastUpdate(Seconds(0)),
+      m_counters{}
+{
+}
+
+void
+TrTcmPolicer::Configure(DataRate cir, uint32_t cbs, DataRate pir, uint32_t pbs)
+{
+    NS_ASSERT_MSG(pir >= cir, "The peak rate must be at least the committed rate");
+    NS_ASSERT_MSG(cbs > 0 && pbs > 0, "Burst sizes must be positive");
+    m_cir = cir.GetBitRate() / 8.0;
+    m_pir = pir.GetBitRate() / 8.0;
+    m_cbs = cbs;
+    m_pbs = pbs;
+    m_tc = cbs;
+    m_tp = pbs;
+}
+
+TrTcmPolicer::Color
+TrTcmPolicer::Meter(Time now, uint32_t bytes, Color preColor)
+{
+    if (now > m_lastUpdate)
+    {
+        double elapsed = (now - m_lastUpdate).GetSeconds();
+        m_tc = std::min<double>(m_cbs, m_tc + m_cir * elapsed);
+        m_tp = std::min<double>(m_pbs, m_tp + m_pir * elapsed);
+        m_lastUpdate = now;
+    }
+
+    Color color;
+    if (preColor == RED || m_tp < bytes)
+    {
+        color = RED;
+    }
+    else if (preColor == YELLOW || m_tc < bytes)
+    {
+        color = YELLOW;
+        m_tp -= bytes;
+    }
+    else
+    {
+        color = GREEN;
+        m_tp -= bytes;
+        m_tc -= bytes;
+    }
+    m_counters.packets[color]++;
+    m_counters.bytes[color] += bytes;
+    return color;
+}
+
+const TrTcmPolicer::Counters&
+TrTcmPolicer::GetCounters() const
+{
+    return m_counters;
+}
+
+} // namespace ns3
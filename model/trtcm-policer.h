@@ -0,0 +1,86 @@
+#ifndef TRTCM_POLICER_H
+#define TRTCM_POLICER_H
+
+#include "ns3/data-rate.h"
+#include "ns3/nstime.h"
+
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::TrTcmPolicer declaration.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup bridge
+ * \brief Two-rate three-color marker (RFC 2698)
+ *
+ * Two token buckets, P of PBS bytes filled at PIR and C of CBS bytes filled
+ * at CIR, start full. A packet is red if it exceeds P, yellow if it exceeds
+ * C, and green otherwise; yellow packets take their bytes from P, green
+ * ones from both buckets. In color-aware mode, a packet pre-colored yellow
+ * or red cannot be marked with a better color.
+ *
+ * The buckets are refilled from the time elapsed since the previous packet
+ * when a packet is metered, so an idle policer costs nothing.
+ */
+class TrTcmPolicer
+{
+  public:
+    /// Color of a packet
+    enum Color : uint8_t
+    {
+        GREEN,  //!< within the committed rate
+        YELLOW, //!< above the committed rate, within the peak rate
+        RED,    //!< above the peak rate
+        COLORS  //!< number of colors
+    };
+
+    /// Packets and bytes metered, by color
+    struct Counters
+    {
+        uint64_t packets[COLORS]; //!< packets marked with each color
+        uint64_t bytes[COLORS];   //!< bytes marked with each color
+    };
+
+    TrTcmPolicer();
+
+    /**
+     * \brief Set the traffic profile; the buckets are filled and the counters kept
+     * \param cir committed information rate
+     * \param cbs committed burst size, in bytes
+     * \param pir peak information rate, at least cir
+     * \param pbs peak burst size, in bytes
+     */
+    void Configure(DataRate cir, uint32_t cbs, DataRate pir, uint32_t pbs);
+
+    /**
+     * \brief Meter a packet
+     * \param now the current time
+     * \param bytes the packet size
+     * \param preColor color of the packet in color-aware mode, GREEN for color-blind
+     * \returns the color of the packet
+     */
+    Color Meter(Time now, uint32_t bytes, Color preColor = GREEN);
+
+    /// \returns the packets and bytes metered so far
+    const Counters& GetCounters() const;
+
+  private:
+    double m_cir;        //!< committed rate, in bytes per second
+    double m_pir;        //!< peak rate, in bytes per second
+    uint32_t m_cbs;      //!< size of the C bucket
+    uint32_t m_pbs;      //!< size of the P bucket
+    double m_tc;         //!< tokens in the C bucket, in bytes
+    double m_tp;         //!< tokens in the P bucket, in bytes
+    Time m_lastUpdate;   //!< time the buckets were last refilled
+    Counters m_counters; //!< packets and bytes by color
+};
+
+} // namespace ns3
+
+#endif /* TRTCM_POLICER_H */
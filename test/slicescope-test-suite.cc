@@ -5,6 +5,38 @@
 // An essential include is test.h
 #include "ns3/test.h"
 
+#include "ns3/boolean.h"
+#include "ns3/csma-helper.h"
+#include "ns3/data-rate.h"
+#include "ns3/custom-queue-disc.h"
+#include "ns3/delay-histogram.h"
+#include "ns3/double.h"
+#include "ns3/dscp-queue-map.h"
+#include "ns3/enum.h"
+#include "ns3/flow-cache.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-lpm-table.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include "ns3/linear-topology-helper.h"
+#include "ns3/mac-learning-table.h"
+#include "ns3/shared-buffer-pool.h"
+#include "ns3/simulator.h"
+#include "ns3/slice-aqm.h"
+#include "ns3/slice-id-tag.h"
+#include "ns3/slice.h"
+#include "ns3/slicescope-header.h"
+#include "ns3/slicescope-switch-helper.h"
+#include "ns3/slicescope-switch-net-device.h"
+#include "ns3/slicescope-tag.h"
+#include "ns3/tcp-l4-protocol.h"
+#include "ns3/trtcm-policer.h"
+#include "ns3/udp-header.h"
+#include "ns3/udp-l4-protocol.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <cmath>
+
 // Do not put your test classes in namespace ns3.  You may find it useful
 // to use the using directive to access the ns3 namespace directly
 using namespace ns3;
@@ -57,6 +89,1096 @@ SlicescopeTestCase1::DoRun()
     NS_TEST_ASSERT_MSG_EQ_TOL(0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
 }
 
+/**
+ * Enqueue a packet of a slice in a CustomQueueDisc
+ * \param queueDisc the queue disc
+ * \param sliceType the slice, which gives the DSCP of the packet
+ * \param size the payload size
+ */
+static void
+EnqueueSlicePacket(Ptr<CustomQueueDisc> queueDisc, Slice::SliceType sliceType, uint32_t size)
+{
+    Ipv4Header header;
+    header.SetPayloadSize(size);
+    header.SetDscp(static_cast<Ipv4Header::DscpType>(Slice::sliceTypeToDscpMap.at(sliceType)));
+    queueDisc->Enqueue(Create<Ipv4QueueDiscItem>(Create<Packet>(size), Address(), 0, header));
+}
+
+/**
+ * \ingroup slicescope-tests
+ * Serves two CustomQueueDisc instances alternately with a scheduler, every
+ * slice kept backlogged, and checks that each instance shares its
+ * bottleneck in proportion to the slice weights, in bytes. The lag of
+ * each slice behind the fluid schedule, its weighted share of the bytes
+ * sent so far, is left to the checks of each scheduler.
+ */
+class CustomQueueDiscSchedulerTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor
+     * \param name the test name
+     * \param scheduler the scheduler of the queue discs
+     */
+    CustomQueueDiscSchedulerTestCase(std::string name, CustomQueueDisc::Scheduler scheduler);
+
+  protected:
+    /// Service of the slices of one queue disc
+    struct SliceService
+    {
+        std::map<Slice::SliceType, uint64_t> sentBytes; //!< bytes sent by each slice
+        std::map<Slice::SliceType, double> maxLag;      //!< largest lag behind the fluid schedule
+        uint64_t totalBytes = 0;                        //!< bytes sent by all the slices
+    };
+
+    /**
+     * Checks what only the scheduler under test guarantees
+     * \param service the service of one queue disc
+     */
+    virtual void CheckService(const SliceService& service) = 0;
+
+    /// Weight of each slice
+    const std::map<Slice::SliceType, uint32_t> m_weights = {{Slice::URLLC, 60},
+                                                            {Slice::eMBB, 30},
+                                                            {Slice::mMTC, 10}};
+
+  private:
+    void DoRun() override;
+
+    CustomQueueDisc::Scheduler m_scheduler; //!< scheduler under test
+};
+
+CustomQueueDiscSchedulerTestCase::CustomQueueDiscSchedulerTestCase(
+    std::string name,
+    CustomQueueDisc::Scheduler scheduler)
+    : TestCase(name),
+      m_scheduler(scheduler)
+{
+}
+
+void
+CustomQueueDiscSchedulerTestCase::DoRun()
+{
+    // Packet counts and bytes give different shares with these sizes
+    const std::map<Slice::SliceType, uint32_t> sizes = {{Slice::URLLC, 180},
+                                                        {Slice::eMBB, 1480},
+                                                        {Slice::mMTC, 580}};
+
+    // Two bottlenecks served alternately, each with every slice backlogged
+    std::vector<Ptr<CustomQueueDisc>> queueDiscs;
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        Ptr<CustomQueueDisc> queueDisc = CreateObject<CustomQueueDisc>();
+        queueDisc->SetAttribute("Scheduler", EnumValue(m_scheduler));
+        queueDisc->SetQueueWeights(m_weights);
+        queueDisc->Initialize();
+        for (const auto& [sliceType, size] : sizes)
+        {
+            for (uint32_t n = 0; n < 10; n++)
+            {
+                EnqueueSlicePacket(queueDisc, sliceType, size);
+            }
+        }
+        queueDiscs.push_back(queueDisc);
+    }
+
+    std::vector<SliceService> services(queueDiscs.size());
+    for (uint32_t n = 0; n < 30000; n++)
+    {
+        uint32_t i = n % queueDiscs.size();
+        auto item = DynamicCast<Ipv4QueueDiscItem>(queueDiscs[i]->Dequeue());
+        NS_TEST_ASSERT_MSG_NE(item, nullptr, "A backlogged queue disc sent nothing");
+        Slice::SliceType sliceType = Slice::dscpToSliceTypeMap.at(item->GetHeader().GetDscp());
+        SliceService& service = services[i];
+        service.sentBytes[sliceType] += item->GetSize();
+        service.totalBytes += item->GetSize();
+        for (const auto& [type, weight] : m_weights)
+        {
+            double lag = weight / 100.0 * service.totalBytes - service.sentBytes[type];
+            service.maxLag[type] = std::max(service.maxLag[type], lag);
+        }
+        EnqueueSlicePacket(queueDiscs[i], sliceType, sizes.at(sliceType));
+    }
+
+    for (uint32_t i = 0; i < queueDiscs.size(); i++)
+    {
+        for (const auto& [sliceType, weight] : m_weights)
+        {
+            double share = static_cast<double>(services[i].sentBytes[sliceType]) /
+                           services[i].totalBytes;
+            NS_TEST_ASSERT_MSG_EQ_TOL(share,
+                                      weight / 100.0,
+                                      0.01,
+                                      "Byte share of " << Slice::sliceTypeToStrMap.at(sliceType)
+                                                       << " on queue disc " << i);
+        }
+        CheckService(services[i]);
+    }
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup slicescope-tests
+ * Checks that deficit round robin shares a bottleneck by slice weight, and
+ * that it lets a slice fall more than a packet behind the fluid schedule
+ * while the heavy URLLC queue sends its whole quantum
+ */
+class CustomQueueDiscDrrTestCase : public CustomQueueDiscSchedulerTestCase
+{
+  public:
+    CustomQueueDiscDrrTestCase();
+
+  private:
+    void CheckService(const SliceService& service) override;
+};
+
+CustomQueueDiscDrrTestCase::CustomQueueDiscDrrTestCase()
+    : CustomQueueDiscSchedulerTestCase("CustomQueueDisc shares bandwidth by slice weight, in bytes",
+                                       CustomQueueDisc::DRR)
+{
+}
+
+void
+CustomQueueDiscDrrTestCase::CheckService(const SliceService& service)
+{
+    // A URLLC quantum of 9000 bytes leaves eMBB 2700 bytes behind
+    NS_TEST_ASSERT_MSG_GT(service.maxLag.at(Slice::eMBB),
+                          1500.0,
+                          "DRR kept eMBB within a packet of the fluid schedule");
+}
+
+/**
+ * \ingroup slicescope-tests
+ * Checks that the WF2Q+ scheduler of CustomQueueDisc never lets a slice
+ * fall more than one packet behind the fluid schedule, a bound deficit
+ * round robin does not meet with the same weights
+ */
+class CustomQueueDiscWf2qTestCase : public CustomQueueDiscSchedulerTestCase
+{
+  public:
+    CustomQueueDiscWf2qTestCase();
+
+  private:
+    void CheckService(const SliceService& service) override;
+};
+
+CustomQueueDiscWf2qTestCase::CustomQueueDiscWf2qTestCase()
+    : CustomQueueDiscSchedulerTestCase(
+          "CustomQueueDisc WF2Q+ keeps every slice within a packet of its share",
+          CustomQueueDisc::WF2Q)
+{
+}
+
+void
+CustomQueueDiscWf2qTestCase::CheckService(const SliceService& service)
+{
+    for (const auto& [sliceType, weight] : m_weights)
+    {
+        // One packet of the largest size, headers included
+        NS_TEST_ASSERT_MSG_LT(service.maxLag.at(sliceType),
+                              1500.0,
+                              "Lag of " << Slice::sliceTypeToStrMap.at(sliceType));
+    }
+}
+
+/**
+ * \ingroup slicescope-tests
+ * Checks the percentiles of DelayHistogram against the sorted delays, and
+ * that merged histograms count like a single one
+ */
+class DelayHistogramTestCase : public TestCase
+{
+  public:
+    DelayHistogramTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+DelayHistogramTestCase::DelayHistogramTestCase()
+    : TestCase("DelayHistogram percentiles are within its relative error")
+{
+}
+
+void
+DelayHistogramTestCase::DoRun()
+{
+    // Delays from 1 ns to about 100 ms, over many powers of two
+    std::vector<int64_t> delays;
+    DelayHistogram even;
+    DelayHistogram odd;
+    uint64_t state = 1;
+    for (uint32_t n = 0; n < 100000; n++)
+    {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        int64_t delay = 1 + (state >> 37) % (1 << (n % 27));
+        delays.push_back(delay);
+        (n % 2 ? odd : even).Record(NanoSeconds(delay));
+    }
+    DelayHistogram all = even;
+    all.Merge(odd);
+    std::sort(delays.begin(), delays.end());
+
+    NS_TEST_ASSERT_MSG_EQ(all.GetCount(), delays.size(), "Merged count");
+    NS_TEST_ASSERT_MSG_EQ(all.GetMin().GetNanoSeconds(), delays.front(), "Exact min");
+    NS_TEST_ASSERT_MSG_EQ(all.GetMax().GetNanoSeconds(), delays.back(), "Exact max");
+    for (double percentile : {50.0, 90.0, 99.0, 99.9})
+    {
+        auto rank = static_cast<uint64_t>(std::ceil(percentile / 100 * delays.size()));
+        double exact = delays[rank - 1];
+        NS_TEST_ASSERT_MSG_EQ_TOL(all.GetPercentile(percentile).GetNanoSeconds() / exact,
+                                  1.0,
+                                  all.GetRelativeError(),
+                                  "Percentile " << percentile);
+    }
+}
+
+/**
+ * \ingroup slicescope-tests
+ * Checks that the slicescope header carries the INT hop count and limit
+ * only when it has an INT stack, and survives a serialization
+ */
+class SlicescopeHeaderTestCase : public TestCase
+{
+  public:
+    SlicescopeHeaderTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+SlicescopeHeaderTestCase::SlicescopeHeaderTestCase()
+    : TestCase("Slicescope header grows only with its INT stack and path filter")
+{
+}
+
+void
+SlicescopeHeaderTestCase::DoRun()
+{
+    SlicescopeHeader plain;
+    plain.SetDscp(42);
+    Ptr<Packet> packet = Create<Packet>(100);
+    packet->AddHeader(plain);
+    NS_TEST_ASSERT_MSG_EQ(packet->GetSize(), 102, "DSCP and filter size only");
+    SlicescopeHeader copy;
+    packet->RemoveHeader(copy);
+    NS_TEST_ASSERT_MSG_EQ(copy.GetDscp(), 42, "DSCP");
+    NS_TEST_ASSERT_MSG_EQ(copy.GetMaxHops(), 0, "No INT stack");
+
+    SlicescopeHeader full;
+    full.SetDscp(42);
+    full.SetPathFilterSize(4);
+    full.AddPathSwitch(7);
+    full.SetMaxHops(3);
+    full.AddHop({5, 1, 2, 10, 1000});
+    packet->AddHeader(full);
+    NS_TEST_ASSERT_MSG_EQ(packet->GetSize(),
+                          100 + SlicescopeHeader::BASE_SIZE + SlicescopeHeader::INT_SIZE + 4 +
+                              SlicescopeHeader::RECORD_SIZE,
+                          "INT fields, filter and one record");
+    packet->RemoveHeader(copy);
+    NS_TEST_ASSERT_MSG_EQ(copy.GetDscp(), 42, "DSCP next to the I bit");
+    NS_TEST_ASSERT_MSG_EQ(copy.GetMaxHops(), 3, "Hop limit");
+    NS_TEST_ASSERT_MSG_EQ(copy.GetHopCount(), 1, "Hop count");
+    NS_TEST_ASSERT_MSG_EQ(copy.GetHops()[0].hopLatency, 1000, "Record");
+    NS_TEST_ASSERT_MSG_EQ(copy.MayHaveTraversed(7), true, "Path filter");
+    NS_TEST_ASSERT_MSG_EQ(packet->GetSize(), 100, "Header fully removed");
+}
+
+/**
+ * \ingroup slicescope-tests
+ * Checks that the timer wheel of MacLearningTable removes an entry within
+ * one tick of its expiration, even when learned in the middle of a tick
+ */
+class MacLearningTableAgingTestCase : public TestCase
+{
+  public:
+    MacLearningTableAgingTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+MacLearningTableAgingTestCase::MacLearningTableAgingTestCase()
+    : TestCase("MacLearningTable ages entries out within one wheel tick")
+{
+}
+
+void
+MacLearningTableAgingTestCase::DoRun()
+{
+    // Ticks of one second
+    MacLearningTable table;
+    table.SetExpirationTime(Seconds(10));
+    table.SetWheelSlots(10);
+    Mac48Address stale("00:00:00:00:00:01");
+    Mac48Address fresh("00:00:00:00:00:02");
+
+    Simulator::Stop(Seconds(0.5));
+    Simulator::Run();
+    table.Learn(stale, 1);
+    NS_TEST_ASSERT_MSG_EQ(table.Lookup(stale), 1, "Learned entry");
+
+    // Expiring at 10.5 s, the entry must survive the wheel visiting the tick
+    // that starts at 10 s, and be removed by the visit of the next one
+    Simulator::Stop(Seconds(9.7));
+    Simulator::Run();
+    NS_TEST_ASSERT_MSG_EQ(table.Lookup(stale), 1, "Entry not expired yet");
+    Simulator::Stop(Seconds(0.8));
+    Simulator::Run();
+    table.Learn(fresh, 2);
+    NS_TEST_ASSERT_MSG_EQ(table.GetOccupancy(), 1, "Only the fresh entry is left");
+    NS_TEST_ASSERT_MSG_EQ(table.GetEvictions(), 1, "The stale entry was aged out");
+    NS_TEST_ASSERT_MSG_EQ(table.Lookup(stale), MacLearningTable::NO_PORT, "Stale entry gone");
+    NS_TEST_ASSERT_MSG_EQ(table.Lookup(fresh), 2, "Fresh entry kept");
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup slicescope-tests
+ * Checks that TopologyHelper::IsolateSlices splits the weight of each slice
+ * type evenly among its slices, however uneven their numbers, leaves the
+ * type weights alone when called again, and that the slice queues then
+ * share the bandwidth accordingly
+ */
+class IsolateSlicesTestCase : public TestCase
+{
+  public:
+    IsolateSlicesTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+IsolateSlicesTestCase::IsolateSlicesTestCase()
+    : TestCase("IsolateSlices splits the type weights among uneven numbers of slices")
+{
+}
+
+void
+IsolateSlicesTestCase::DoRun()
+{
+    Ptr<LinearTopologyHelper> topology = CreateObject<LinearTopologyHelper>();
+    topology->SetAttribute("CustomQueueDiscs", BooleanValue(true));
+    topology->CreateTopology(1);
+
+    const std::map<Slice::SliceType, uint32_t> slicesPerType = {{Slice::URLLC, 3},
+                                                                {Slice::eMBB, 1},
+                                                                {Slice::mMTC, 2}};
+    std::vector<Ptr<Slice>> slices;
+    for (const auto& [sliceType, count] : slicesPerType)
+    {
+        for (uint32_t k = 0; k < count; k++)
+        {
+            Ptr<Slice> slice = CreateObject<Slice>();
+            slice->SetAttribute("SliceType", EnumValue(sliceType));
+            slice->Configure();
+            slices.push_back(slice);
+        }
+    }
+    topology->IsolateSlices(slices);
+    topology->IsolateSlices(slices);
+
+    Ptr<CustomQueueDisc> queueDisc = DynamicCast<CustomQueueDisc>(topology->GetQueueDiscs().Get(0));
+    NS_TEST_ASSERT_MSG_EQ(queueDisc->GetQueueWeight(0), 80, "URLLC weight kept");
+    NS_TEST_ASSERT_MSG_EQ(queueDisc->GetQueueWeight(1), 15, "eMBB weight kept");
+    NS_TEST_ASSERT_MSG_EQ(queueDisc->GetQueueWeight(2), 5, "mMTC weight kept");
+    uint32_t numQueues = CustomQueueDisc::queueIndexToSliceTypeMap.size();
+    for (uint32_t k = 0; k < slices.size(); k++)
+    {
+        Slice::SliceType sliceType = slices[k]->GetSliceType();
+        double typeWeight =
+            queueDisc->GetQueueWeight(CustomQueueDisc::sliceTypeToQueueIndexMap.at(sliceType));
+        NS_TEST_ASSERT_MSG_EQ_TOL(queueDisc->GetQueueWeight(numQueues + k),
+                                  typeWeight / slicesPerType.at(sliceType),
+                                  1e-9,
+                                  "Weight of slice " << k);
+    }
+
+    // Only the slice queues are backlogged, with packets of the same size
+    queueDisc->Initialize();
+    const uint32_t size = 1000;
+    auto enqueue = [queueDisc, size](Ptr<Slice> slice) {
+        Ipv4Header header;
+        header.SetPayloadSize(size);
+        header.SetDscp(static_cast<Ipv4Header::DscpType>(
+            Slice::sliceTypeToDscpMap.at(slice->GetSliceType())));
+        Ptr<Packet> packet = Create<Packet>(size);
+        SliceIdTag sliceIdTag;
+        sliceIdTag.SetSliceId(slice->GetSliceId());
+        packet->AddPacketTag(sliceIdTag);
+        queueDisc->Enqueue(Create<Ipv4QueueDiscItem>(packet, Address(), 0, header));
+    };
+    std::map<uint32_t, Ptr<Slice>> sliceById;
+    for (const auto& slice : slices)
+    {
+        sliceById[slice->GetSliceId()] = slice;
+        for (uint32_t n = 0; n < 10; n++)
+        {
+            enqueue(slice);
+        }
+    }
+    std::map<uint32_t, uint64_t> sentBytes;
+    uint64_t totalBytes = 0;
+    for (uint32_t n = 0; n < 30000; n++)
+    {
+        Ptr<QueueDiscItem> item = queueDisc->Dequeue();
+        NS_TEST_ASSERT_MSG_NE(item, nullptr, "A backlogged queue disc sent nothing");
+        SliceIdTag sliceIdTag;
+        item->GetPacket()->PeekPacketTag(sliceIdTag);
+        sentBytes[sliceIdTag.GetSliceId()] += item->GetSize();
+        totalBytes += item->GetSize();
+        enqueue(sliceById.at(sliceIdTag.GetSliceId()));
+    }
+
+    // Only the slice queues sent, so their weights add up to 100
+    for (const auto& slice : slices)
+    {
+        Slice::SliceType sliceType = slice->GetSliceType();
+        double typeWeight =
+            queueDisc->GetQueueWeight(CustomQueueDisc::sliceTypeToQueueIndexMap.at(sliceType));
+        double share = static_cast<double>(sentBytes[slice->GetSliceId()]) / totalBytes;
+        NS_TEST_ASSERT_MSG_EQ_TOL(share,
+                                  typeWeight / 100.0 / slicesPerType.at(sliceType),
+                                  0.01,
+                                  "Byte share of slice " << slice->GetSliceId());
+    }
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup slicescope-tests
+ * Checks that CoDel starts dropping once the sojourn time has stayed above
+ * Target for an Interval, and that one dequeue makes all the drops due by
+ * then, as in the dequeue loop of RFC 8289
+ */
+class CoDelAqmTestCase : public TestCase
+{
+  public:
+    CoDelAqmTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+CoDelAqmTestCase::CoDelAqmTestCase()
+    : TestCase("CoDel drops on sojourn time, all the drops due in one dequeue")
+{
+}
+
+void
+CoDelAqmTestCase::DoRun()
+{
+    Ptr<CustomQueueDisc> queueDisc = CreateObject<CustomQueueDisc>();
+    ObjectFactory codel("ns3::CoDelAqm");
+    codel.Set("Target", TimeValue(MilliSeconds(5)));
+    codel.Set("Interval", TimeValue(MilliSeconds(100)));
+    queueDisc->SetQueueAqm(0, codel);
+    queueDisc->Initialize();
+
+    // A standing queue of URLLC packets, all enqueued at 0
+    for (uint32_t n = 0; n < 60; n++)
+    {
+        EnqueueSlicePacket(queueDisc, Slice::URLLC, 100);
+    }
+
+    // Above target at 10 ms, for an interval at 110 ms
+    Simulator::Stop(MilliSeconds(10));
+    Simulator::Run();
+    NS_TEST_ASSERT_MSG_NE(queueDisc->Dequeue(), nullptr, "No packet sent at 10 ms");
+    NS_TEST_ASSERT_MSG_EQ(queueDisc->GetAqmDrops(0), 0, "Dropped before an interval");
+
+    // Entering the dropping state at 120 ms, next drop at 220 ms
+    Simulator::Stop(MilliSeconds(110));
+    Simulator::Run();
+    NS_TEST_ASSERT_MSG_NE(queueDisc->Dequeue(), nullptr, "No packet sent at 120 ms");
+    NS_TEST_ASSERT_MSG_EQ(queueDisc->GetAqmDrops(0), 1, "No drop after an interval above target");
+
+    // At 400 ms, the drops due at 220, 290.7, 348.4 and 398.4 ms are all made
+    Simulator::Stop(MilliSeconds(280));
+    Simulator::Run();
+    NS_TEST_ASSERT_MSG_NE(queueDisc->Dequeue(), nullptr, "No packet sent at 400 ms");
+    NS_TEST_ASSERT_MSG_EQ(queueDisc->GetAqmDrops(0), 5, "Drops due by 400 ms left undone");
+    NS_TEST_ASSERT_MSG_EQ(queueDisc->GetInternalQueue(0)->GetNPackets(),
+                          52,
+                          "3 packets sent and 5 dropped");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup slicescope-tests
+ * Checks that the drop probability of PIE rises under a standing queue
+ * above Target, and decays while the queue drains without arrivals
+ */
+class PieAqmTestCase : public TestCase
+{
+  public:
+    PieAqmTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+PieAqmTestCase::PieAqmTestCase()
+    : TestCase("PIE drop probability rises on a standing queue and decays as it drains")
+{
+}
+
+void
+PieAqmTestCase::DoRun()
+{
+    Ptr<PieAqm> pie = CreateObject<PieAqm>();
+    pie->SetAttribute("Target", TimeValue(MilliSeconds(15)));
+    pie->SetAttribute("TUpdate", TimeValue(MilliSeconds(15)));
+
+    // 500 ms of a 30 KB queue whose packets wait 50 ms
+    for (uint32_t n = 0; n < 100; n++)
+    {
+        pie->Enqueue(nullptr, 30000);
+        pie->Dequeue(nullptr, MilliSeconds(50), 30000);
+        Simulator::Stop(MilliSeconds(5));
+        Simulator::Run();
+    }
+    double peak = pie->GetDropProbability();
+    NS_TEST_ASSERT_MSG_GT(peak, 0.01, "The probability did not rise above target");
+
+    // The queue drains, with packets waiting 2 ms and no arrival
+    for (uint32_t n = 0; n < 20; n++)
+    {
+        pie->Dequeue(nullptr, MilliSeconds(2), 3000);
+        Simulator::Stop(MilliSeconds(5));
+        Simulator::Run();
+    }
+    NS_TEST_ASSERT_MSG_LT(pie->GetDropProbability(),
+                          peak / 2,
+                          "The probability did not decay while draining");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup slicescope-tests
+ * Checks the dynamic threshold admission of SharedBufferPool across two
+ * ports, that each port keeps the reservation it was added with, and that
+ * a CustomQueueDisc charged to a pool again, or to another pool, leaves
+ * the reserved bytes right
+ */
+class SharedBufferPoolTestCase : public TestCase
+{
+  public:
+    SharedBufferPoolTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+SharedBufferPoolTestCase::SharedBufferPoolTestCase()
+    : TestCase("SharedBufferPool admits by dynamic threshold and keeps the reservations")
+{
+}
+
+void
+SharedBufferPoolTestCase::DoRun()
+{
+    // 2 ports of 2 queues reserving 2000 bytes each: 12000 shared bytes
+    Ptr<SharedBufferPool> pool = CreateObject<SharedBufferPool>();
+    pool->SetAttribute("BufferSize", UintegerValue(20000));
+    pool->SetAttribute("ReservedBytes", UintegerValue(2000));
+    pool->SetAttribute("Alpha", DoubleValue(1.0));
+    uint32_t port0 = pool->AddPort(2);
+    uint32_t port1 = pool->AddPort(2);
+    NS_TEST_ASSERT_MSG_EQ(pool->GetThreshold(0), 12000, "Shared part of an empty buffer");
+
+    // With alpha 1, a lone queue may take half of the shared part: 2000
+    // reserved bytes, then 6000 shared ones, whose next 1000 exceed the
+    // 6000 left free
+    uint32_t admitted = 0;
+    while (pool->Admit(port0, 0, 1000))
+    {
+        admitted++;
+    }
+    NS_TEST_ASSERT_MSG_EQ(admitted, 8, "Packets admitted to the first queue");
+    NS_TEST_ASSERT_MSG_EQ(pool->GetSharedOccupancy(), 6000, "Shared bytes of the first queue");
+    NS_TEST_ASSERT_MSG_EQ(pool->GetDrops(port0, 0), 1, "Drops of the first queue");
+
+    // A queue of the other port gets its reserved bytes, then up to what
+    // is left free after its own shared bytes: 3000 out of 6000
+    admitted = 0;
+    while (pool->Admit(port1, 0, 1000))
+    {
+        admitted++;
+    }
+    NS_TEST_ASSERT_MSG_EQ(admitted, 5, "Packets admitted to the second queue");
+    NS_TEST_ASSERT_MSG_EQ(pool->GetSharedOccupancy(), 9000, "Shared bytes of both queues");
+    NS_TEST_ASSERT_MSG_EQ(pool->GetOccupancy(), 13000, "Bytes held by both queues");
+    NS_TEST_ASSERT_MSG_EQ(pool->GetThreshold(0), 3000, "Threshold once the buffer fills");
+
+    pool->Release(port0, 0, 1000);
+    NS_TEST_ASSERT_MSG_EQ(pool->GetSharedOccupancy(), 8000, "Shared bytes after a release");
+
+    // The ports added keep their 2000 reserved bytes per queue
+    pool->SetAttribute("ReservedBytes", UintegerValue(0));
+    NS_TEST_ASSERT_MSG_EQ(pool->Admit(port1, 1, 1000), true, "Reserved bytes refused");
+    NS_TEST_ASSERT_MSG_EQ(pool->GetSharedOccupancy(), 8000, "Reserved bytes charged as shared");
+    pool->Release(port1, 1, 1000);
+
+    // A queue disc of 3 queues reserves 6000 bytes of a pool, once
+    Ptr<SharedBufferPool> pool2 = CreateObject<SharedBufferPool>();
+    pool2->SetAttribute("BufferSize", UintegerValue(20000));
+    pool2->SetAttribute("ReservedBytes", UintegerValue(2000));
+    Ptr<CustomQueueDisc> queueDisc = CreateObject<CustomQueueDisc>();
+    queueDisc->SetSharedBuffer(pool2);
+    queueDisc->Initialize();
+    NS_TEST_ASSERT_MSG_EQ(pool2->GetThreshold(0), 14000, "Shared part with one queue disc");
+    queueDisc->SetSharedBuffer(pool2);
+    NS_TEST_ASSERT_MSG_EQ(pool2->GetThreshold(0), 14000, "Pool set twice reserved twice");
+
+    // Moved to another pool, it frees its reservation in the first one
+    Ptr<SharedBufferPool> pool3 = CreateObject<SharedBufferPool>();
+    pool3->SetAttribute("BufferSize", UintegerValue(20000));
+    pool3->SetAttribute("ReservedBytes", UintegerValue(2000));
+    queueDisc->SetSharedBuffer(pool3);
+    NS_TEST_ASSERT_MSG_EQ(pool2->GetThreshold(0), 20000, "Reservation left in the old pool");
+    NS_TEST_ASSERT_MSG_EQ(pool3->GetThreshold(0), 14000, "Reservation in the new pool");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup slicescope-tests
+ * Checks that a port is a transit port only when the other devices of its
+ * channel are all switch ports, so that a CSMA segment shared by a switch
+ * and a host is an edge
+ */
+class PortRoleTestCase : public TestCase
+{
+  public:
+    PortRoleTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+PortRoleTestCase::PortRoleTestCase()
+    : TestCase("A CSMA segment shared by switches and a host is an edge")
+{
+}
+
+void
+PortRoleTestCase::DoRun()
+{
+    NodeContainer switches;
+    switches.Create(2);
+    Ptr<Node> host = CreateObject<Node>();
+    CsmaHelper csma;
+
+    // Port 0 of both switches on a segment with the host, port 1 on a
+    // segment of their own
+    NetDeviceContainer mixed = csma.Install(NodeContainer(switches, NodeContainer(host)));
+    NetDeviceContainer link = csma.Install(switches);
+
+    SlicescopeSwitchHelper switchHelper;
+    std::vector<Ptr<SlicescopeSwitchNetDevice>> devices;
+    for (uint32_t i = 0; i < switches.GetN(); i++)
+    {
+        NetDeviceContainer ports(mixed.Get(i));
+        ports.Add(link.Get(i));
+        devices.push_back(DynamicCast<SlicescopeSwitchNetDevice>(
+            switchHelper.Install(switches.Get(i), ports).Get(0)));
+    }
+
+    for (uint32_t i = 0; i < devices.size(); i++)
+    {
+        NS_TEST_ASSERT_MSG_EQ(devices[i]->GetPortRole(0),
+                              SlicescopeSwitchNetDevice::EDGE,
+                              "Mixed segment of switch " << i);
+        NS_TEST_ASSERT_MSG_EQ(devices[i]->GetPortRole(1),
+                              SlicescopeSwitchNetDevice::TRANSIT,
+                              "Switch-only segment of switch " << i);
+    }
+
+    // The detected role can be overridden
+    devices[0]->SetPortRole(0, SlicescopeSwitchNetDevice::TRANSIT);
+    NS_TEST_ASSERT_MSG_EQ(devices[0]->GetPortRole(0),
+                          SlicescopeSwitchNetDevice::TRANSIT,
+                          "Role set by hand");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup slicescope-tests
+ * Checks that Ipv4LpmTable finds the longest matching route in any order
+ * of insertion, and that replacing a route does not count it again
+ */
+class Ipv4LpmTableTestCase : public TestCase
+{
+  public:
+    Ipv4LpmTableTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+Ipv4LpmTableTestCase::Ipv4LpmTableTestCase()
+    : TestCase("Ipv4LpmTable matches the longest prefix and counts each prefix once")
+{
+}
+
+void
+Ipv4LpmTableTestCase::DoRun()
+{
+    Ipv4LpmTable table;
+    table.AddRoute(Ipv4Address("10.1.2.3"), Ipv4Mask("/32"), 3);
+    table.AddRoute(Ipv4Address("10.1.0.0"), Ipv4Mask("/16"), 1);
+    table.AddRoute(Ipv4Address("10.1.2.0"), Ipv4Mask("/24"), 2);
+    NS_TEST_ASSERT_MSG_EQ(table.Lookup(Ipv4Address("10.1.2.3")), 3, "Host route");
+    NS_TEST_ASSERT_MSG_EQ(table.Lookup(Ipv4Address("10.1.2.4")), 2, "/24 route");
+    NS_TEST_ASSERT_MSG_EQ(table.Lookup(Ipv4Address("10.1.3.1")), 1, "/16 route");
+    NS_TEST_ASSERT_MSG_EQ(table.Lookup(Ipv4Address("10.2.0.1")),
+                          Ipv4LpmTable::NO_ROUTE,
+                          "No route");
+    NS_TEST_ASSERT_MSG_EQ(table.GetNRoutes(), 3, "Routes added");
+
+    // The same prefix, written with other host bits, replaces the route
+    table.AddRoute(Ipv4Address("10.1.255.255"), Ipv4Mask("/16"), 4);
+    NS_TEST_ASSERT_MSG_EQ(table.Lookup(Ipv4Address("10.1.3.1")), 4, "Replaced /16 route");
+    NS_TEST_ASSERT_MSG_EQ(table.Lookup(Ipv4Address("10.1.2.4")), 2, "/24 route under it");
+    NS_TEST_ASSERT_MSG_EQ(table.GetNRoutes(), 3, "Replaced route counted again");
+}
+
+/**
+ * \ingroup slicescope-tests
+ * Checks that DscpQueueMap sends each slice DSCP to the queue of its slice
+ * type and the others to eMBB, reads only the six DSCP bits, and that
+ * CustomQueueDisc queues packets by the map with its MapDscp overrides
+ */
+class DscpQueueMapTestCase : public TestCase
+{
+  public:
+    DscpQueueMapTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+DscpQueueMapTestCase::DscpQueueMapTestCase()
+    : TestCase("DscpQueueMap resolves slice, default and out-of-range DSCPs")
+{
+}
+
+void
+DscpQueueMapTestCase::DoRun()
+{
+    DscpQueueMap map;
+    for (const auto& [sliceType, dscp] : Slice::sliceTypeToDscpMap)
+    {
+        NS_TEST_ASSERT_MSG_EQ(map.GetQueueIndex(dscp),
+                              CustomQueueDisc::sliceTypeToQueueIndexMap.at(sliceType),
+                              "Queue of " << Slice::sliceTypeToStrMap.at(sliceType));
+    }
+    NS_TEST_ASSERT_MSG_EQ(map.GetQueueIndex(0), 1, "Best effort is not served as eMBB");
+    NS_TEST_ASSERT_MSG_EQ(map.GetQueueIndex(63), 1, "Unknown DSCP is not served as eMBB");
+    NS_TEST_ASSERT_MSG_EQ(map.GetNQueues(), 3, "Queues of the default map");
+
+    // Values above 63 are reduced to their six DSCP bits
+    NS_TEST_ASSERT_MSG_EQ(map.GetQueueIndex(64 + 46), 0, "DSCP 110 read as 46");
+    NS_TEST_ASSERT_MSG_EQ(map.GetQueueIndex(255), 1, "DSCP 255 read as 63");
+
+    map.Map(64 + 10, 4);
+    NS_TEST_ASSERT_MSG_EQ(map.GetQueueIndex(10), 4, "Override of DSCP 10");
+    NS_TEST_ASSERT_MSG_EQ(map.GetNQueues(), 5, "Queues with the override");
+
+    // The queue disc classifies by its map, overrides included
+    Ptr<CustomQueueDisc> queueDisc = CreateObject<CustomQueueDisc>();
+    queueDisc->SetAttribute("NumQueues", UintegerValue(4));
+    queueDisc->MapDscp(10, 3);
+    queueDisc->Initialize();
+    NS_TEST_ASSERT_MSG_EQ(queueDisc->GetDscpQueueMap().GetQueueIndex(10), 3, "Map of the disc");
+    for (uint8_t dscp : {10, 0, 8})
+    {
+        Ipv4Header header;
+        header.SetPayloadSize(100);
+        header.SetDscp(static_cast<Ipv4Header::DscpType>(dscp));
+        queueDisc->Enqueue(Create<Ipv4QueueDiscItem>(Create<Packet>(100), Address(), 0, header));
+    }
+    NS_TEST_ASSERT_MSG_EQ(queueDisc->GetInternalQueue(3)->GetNPackets(), 1, "DSCP 10 queue");
+    NS_TEST_ASSERT_MSG_EQ(queueDisc->GetInternalQueue(1)->GetNPackets(), 1, "DSCP 0 queue");
+    NS_TEST_ASSERT_MSG_EQ(queueDisc->GetInternalQueue(2)->GetNPackets(), 1, "DSCP 8 queue");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup slicescope-tests
+ * Checks that the layer-3 path of the switch forwards the packets it does
+ * not insert a slicescope header in byte for byte: non-UDP packets, and
+ * UDP packets that already carry the header
+ */
+class Layer3PassThroughTestCase : public TestCase
+{
+  public:
+    Layer3PassThroughTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Receive callback of the host behind the switch
+     * \param device the receiving device
+     * \param packet the packet
+     * \param protocol the protocol number
+     * \param from the sender address
+     * \returns true
+     */
+    bool Receive(Ptr<NetDevice> device,
+                 Ptr<const Packet> packet,
+                 uint16_t protocol,
+                 const Address& from);
+
+    std::vector<Ptr<const Packet>> m_received; //!< packets received by the host
+};
+
+Layer3PassThroughTestCase::Layer3PassThroughTestCase()
+    : TestCase("The layer-3 path leaves packets without an inserted header unchanged")
+{
+}
+
+bool
+Layer3PassThroughTestCase::Receive(Ptr<NetDevice> device,
+                                   Ptr<const Packet> packet,
+                                   uint16_t protocol,
+                                   const Address& from)
+{
+    m_received.push_back(packet);
+    return true;
+}
+
+void
+Layer3PassThroughTestCase::DoRun()
+{
+    // sender -- switch -- receiver, headers kept on the edge port so that
+    // an insertion would reach the receiver
+    NodeContainer hosts;
+    hosts.Create(2);
+    Ptr<Node> switchNode = CreateObject<Node>();
+    CsmaHelper csma;
+    NetDeviceContainer left =
+        csma.Install(NodeContainer(NodeContainer(hosts.Get(0)), NodeContainer(switchNode)));
+    NetDeviceContainer right =
+        csma.Install(NodeContainer(NodeContainer(switchNode), NodeContainer(hosts.Get(1))));
+    SlicescopeSwitchHelper switchHelper;
+    switchHelper.SetDeviceAttribute("StripAtEdge", BooleanValue(false));
+    NetDeviceContainer ports(left.Get(1));
+    ports.Add(right.Get(0));
+    switchHelper.Install(switchNode, ports);
+    right.Get(1)->SetReceiveCallback(MakeCallback(&Layer3PassThroughTestCase::Receive, this));
+
+    // UDP and TCP packets of the eMBB slice, with recognizable payload bytes
+    auto makePacket = [](uint8_t protocol, bool withSlicescopeHeader) {
+        std::vector<uint8_t> payload(100);
+        for (std::size_t i = 0; i < payload.size(); i++)
+        {
+            payload[i] = static_cast<uint8_t>(i);
+        }
+        Ptr<Packet> packet = Create<Packet>(payload.data(), payload.size());
+        if (protocol == UdpL4Protocol::PROT_NUMBER)
+        {
+            if (withSlicescopeHeader)
+            {
+                packet->AddHeader(SlicescopeHeader());
+                packet->AddPacketTag(SlicescopeTag());
+            }
+            UdpHeader udpHeader;
+            udpHeader.SetSourcePort(49153);
+            udpHeader.SetDestinationPort(9);
+            packet->AddHeader(udpHeader);
+        }
+        Ipv4Header ipv4Header;
+        ipv4Header.SetSource(Ipv4Address("10.0.0.1"));
+        ipv4Header.SetDestination(Ipv4Address("10.0.0.2"));
+        ipv4Header.SetProtocol(protocol);
+        ipv4Header.SetDscp(static_cast<Ipv4Header::DscpType>(
+            Slice::sliceTypeToDscpMap.at(Slice::eMBB)));
+        ipv4Header.SetPayloadSize(packet->GetSize());
+        packet->AddHeader(ipv4Header);
+        return packet;
+    };
+    std::vector<Ptr<Packet>> sent = {makePacket(TcpL4Protocol::PROT_NUMBER, false),
+                                     makePacket(UdpL4Protocol::PROT_NUMBER, true),
+                                     makePacket(UdpL4Protocol::PROT_NUMBER, false)};
+    for (const auto& packet : sent)
+    {
+        left.Get(0)->Send(packet->Copy(), right.Get(1)->GetAddress(), Ipv4L3Protocol::PROT_NUMBER);
+    }
+    Simulator::Stop(Seconds(1));
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(m_received.size(), sent.size(), "Packets lost by the switch");
+    auto bytes = [](Ptr<const Packet> packet) {
+        std::vector<uint8_t> buffer(packet->GetSize());
+        packet->CopyData(buffer.data(), buffer.size());
+        return buffer;
+    };
+    NS_TEST_ASSERT_MSG_EQ((bytes(m_received[0]) == bytes(sent[0])), true, "TCP packet changed");
+    NS_TEST_ASSERT_MSG_EQ((bytes(m_received[1]) == bytes(sent[1])),
+                          true,
+                          "UDP packet with a slicescope header changed");
+
+    // The edge switch does insert the header in other UDP packets
+    NS_TEST_ASSERT_MSG_EQ(m_received[2]->GetSize(),
+                          sent[2]->GetSize() + SlicescopeHeader().GetSerializedSize(),
+                          "No header inserted in a UDP packet");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup slicescope-tests
+ * Checks the colors of TrTcmPolicer at the edges of its buckets: a packet
+ * that takes exactly the tokens left is within the rate, one more byte is
+ * not, and each bucket refills at its own rate
+ */
+class TrTcmPolicerTestCase : public TestCase
+{
+  public:
+    TrTcmPolicerTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+TrTcmPolicerTestCase::TrTcmPolicerTestCase()
+    : TestCase("TrTcmPolicer colors packets at the CIR and PIR boundaries")
+{
+}
+
+void
+TrTcmPolicerTestCase::DoRun()
+{
+    // 1000 bytes per ms committed, 2000 bytes per ms peak
+    TrTcmPolicer policer;
+    policer.Configure(DataRate("8Mbps"), 3000, DataRate("16Mbps"), 6000);
+
+    // A burst of CBS bytes is green, the next byte is yellow, up to PBS
+    // bytes in all; the byte after that is red
+    Time now = Seconds(0);
+    NS_TEST_ASSERT_MSG_EQ(policer.Meter(now, 3000), TrTcmPolicer::GREEN, "CBS bytes");
+    NS_TEST_ASSERT_MSG_EQ(policer.Meter(now, 1), TrTcmPolicer::YELLOW, "Byte above CBS");
+    NS_TEST_ASSERT_MSG_EQ(policer.Meter(now, 2999), TrTcmPolicer::YELLOW, "Up to PBS bytes");
+    NS_TEST_ASSERT_MSG_EQ(policer.Meter(now, 1), TrTcmPolicer::RED, "Byte above PBS");
+
+    // 1 ms later, CIR gave 1000 tokens and PIR 2000
+    now += MilliSeconds(1);
+    NS_TEST_ASSERT_MSG_EQ(policer.Meter(now, 1001), TrTcmPolicer::YELLOW, "Above the CIR refill");
+    NS_TEST_ASSERT_MSG_EQ(policer.Meter(now, 1000), TrTcmPolicer::RED, "Above the 999 PIR left");
+    NS_TEST_ASSERT_MSG_EQ(policer.Meter(now, 999), TrTcmPolicer::GREEN, "Exactly the PIR left");
+    NS_TEST_ASSERT_MSG_EQ(policer.Meter(now, 1), TrTcmPolicer::RED, "Above the PIR refill");
+    now += MilliSeconds(1);
+    NS_TEST_ASSERT_MSG_EQ(policer.Meter(now, 1000), TrTcmPolicer::GREEN, "CIR refill");
+    NS_TEST_ASSERT_MSG_EQ(policer.Meter(now, 1000), TrTcmPolicer::YELLOW, "PIR refill");
+    NS_TEST_ASSERT_MSG_EQ(policer.Meter(now, 1), TrTcmPolicer::RED, "Above the PIR refill");
+
+    const TrTcmPolicer::Counters& counters = policer.GetCounters();
+    NS_TEST_ASSERT_MSG_EQ(counters.packets[TrTcmPolicer::GREEN], 3, "Green packets");
+    NS_TEST_ASSERT_MSG_EQ(counters.bytes[TrTcmPolicer::YELLOW], 5001, "Yellow bytes");
+    NS_TEST_ASSERT_MSG_EQ(counters.packets[TrTcmPolicer::RED], 4, "Red packets");
+
+    // A flow at exactly CIR stays green; one at exactly PIR is green for
+    // its committed burst and the CIR refill, yellow above, never red
+    TrTcmPolicer committed;
+    committed.Configure(DataRate("8Mbps"), 3000, DataRate("16Mbps"), 6000);
+    TrTcmPolicer peak;
+    peak.Configure(DataRate("8Mbps"), 3000, DataRate("16Mbps"), 6000);
+    for (uint32_t n = 1; n <= 100; n++)
+    {
+        now = Seconds(1) + MilliSeconds(n);
+        NS_TEST_ASSERT_MSG_EQ(committed.Meter(now, 1000), TrTcmPolicer::GREEN, "Packet " << n);
+        peak.Meter(now, 2000);
+    }
+    // The 3000 bytes of the burst and 99 ms of CIR refill
+    NS_TEST_ASSERT_MSG_EQ(peak.GetCounters().bytes[TrTcmPolicer::GREEN], 102000, "Green at PIR");
+    NS_TEST_ASSERT_MSG_EQ(peak.GetCounters().bytes[TrTcmPolicer::YELLOW], 98000, "Yellow at PIR");
+    NS_TEST_ASSERT_MSG_EQ(peak.GetCounters().packets[TrTcmPolicer::RED], 0, "Red at PIR");
+
+    // In color-aware mode, a packet never gets a better color than it had
+    TrTcmPolicer aware;
+    aware.Configure(DataRate("8Mbps"), 3000, DataRate("16Mbps"), 6000);
+    NS_TEST_ASSERT_MSG_EQ(aware.Meter(now, 100, TrTcmPolicer::YELLOW),
+                          TrTcmPolicer::YELLOW,
+                          "Pre-colored yellow");
+    NS_TEST_ASSERT_MSG_EQ(aware.Meter(now, 100, TrTcmPolicer::RED),
+                          TrTcmPolicer::RED,
+                          "Pre-colored red");
+}
+
+/**
+ * \ingroup slicescope-tests
+ * Check that the FlowCache CLOCK hand gives hit entries a second chance and counts hits and misses
+ */
+class FlowCacheTestCase : public TestCase
+{
+  public:
+    FlowCacheTestCase()
+        : TestCase("Check the CLOCK eviction order and the counters of FlowCache")
+    {
+    }
+
+  private:
+    void DoRun() override
+    {
+        SlicescopePipeline::Key keys[5];
+        for (uint32_t i = 0; i < 5; i++)
+        {
+            keys[i].flow.srcPort = 1000 + i;
+            keys[i].inPort = 1;
+        }
+        SlicescopePipeline::Result result;
+
+        FlowCache cache;
+        cache.SetCapacity(3);
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            NS_TEST_EXPECT_MSG_EQ((cache.Lookup(keys[i]) == nullptr), true, "Cold miss");
+            result.egressPort = i;
+            cache.Insert(keys[i], result);
+        }
+        NS_TEST_EXPECT_MSG_EQ(cache.GetOccupancy(), 3, "The cache is full");
+        NS_TEST_EXPECT_MSG_EQ(cache.Lookup(keys[1])->egressPort, 1, "Cached result");
+
+        // The hand starts on flow 0, which was never hit
+        result.egressPort = 3;
+        cache.Insert(keys[3], result);
+        // The hand is on flow 1, which was hit: it is spared and flow 2 goes
+        result.egressPort = 4;
+        cache.Insert(keys[4], result);
+
+        NS_TEST_EXPECT_MSG_EQ((cache.Lookup(keys[0]) == nullptr), true, "Flow 0 evicted first");
+        NS_TEST_EXPECT_MSG_EQ((cache.Lookup(keys[2]) == nullptr), true, "Flow 2 evicted next");
+        NS_TEST_EXPECT_MSG_EQ((cache.Lookup(keys[1]) != nullptr), true, "Flow 1 kept");
+        NS_TEST_EXPECT_MSG_EQ(cache.Lookup(keys[3])->egressPort, 3, "Flow 3 cached");
+        NS_TEST_EXPECT_MSG_EQ(cache.Lookup(keys[4])->egressPort, 4, "Flow 4 cached");
+        NS_TEST_EXPECT_MSG_EQ(cache.GetHits(), 4, "Hits");
+        NS_TEST_EXPECT_MSG_EQ(cache.GetMisses(), 5, "Misses");
+        NS_TEST_EXPECT_MSG_EQ(cache.GetEvictions(), 2, "Evictions");
+        NS_TEST_EXPECT_MSG_EQ(cache.GetOccupancy(), 3, "Still full");
+
+        cache.Flush();
+        NS_TEST_EXPECT_MSG_EQ(cache.GetOccupancy(), 0, "Flush removes the entries");
+        NS_TEST_EXPECT_MSG_EQ(cache.GetHits(), 4, "Flush keeps the counters");
+        cache.Clear();
+        NS_TEST_EXPECT_MSG_EQ(cache.GetMisses(), 0, "Clear resets the counters");
+
+        cache.SetCapacity(0);
+        cache.Insert(keys[0], result);
+        NS_TEST_EXPECT_MSG_EQ((cache.Lookup(keys[0]) == nullptr), true, "A disabled cache misses");
+        NS_TEST_EXPECT_MSG_EQ(cache.GetOccupancy(), 0, "A disabled cache holds nothing");
+    }
+};
+
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
 // and enables the TestCases to be run.  Typically, only the constructor for
 // this class must be defined
@@ -76,6 +1198,21 @@ SlicescopeTestSuite::SlicescopeTestSuite()
 {
     // Duration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
     AddTestCase(new SlicescopeTestCase1, TestCase::Duration::QUICK);
+    AddTestCase(new CustomQueueDiscDrrTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new CustomQueueDiscWf2qTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new DelayHistogramTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new SlicescopeHeaderTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new MacLearningTableAgingTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new IsolateSlicesTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new CoDelAqmTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new PieAqmTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new SharedBufferPoolTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new PortRoleTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new Ipv4LpmTableTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new DscpQueueMapTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new Layer3PassThroughTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new TrTcmPolicerTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new FlowCacheTestCase, TestCase::Duration::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite